@@ -0,0 +1,115 @@
+#include "ClientCompleter.h"
+#include <QAbstractItemView>
+#include <QLineEdit>
+
+namespace {
+
+const int LIMIT_PODPOWIEDZI = 20;
+const int OPOZNIENIE_WYSZUKIWANIA_MS = 150;
+
+} // namespace
+
+ClientCompleter::ClientCompleter(QComboBox* combo, ClientDirectory* katalog, QObject* parent)
+    : QObject(parent),
+      combo(combo),
+      katalog(katalog),
+      podpowiedzi(new QStandardItemModel(this)),
+      completer(new QCompleter(podpowiedzi, this)) {
+    combo->setEditable(true);
+    combo->setInsertPolicy(QComboBox::NoInsert);
+    combo->lineEdit()->setPlaceholderText("Wpisz nazwisko, e-mail lub telefon...");
+
+    // Podpowiedzi są już wynikiem wyszukiwania - completer niczego nie dofiltrowuje
+    completer->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+    completer->setMaxVisibleItems(10);
+    combo->lineEdit()->setCompleter(completer);
+
+    // Wyszukiwanie rusza dopiero po przerwie w pisaniu, nie po każdym znaku
+    opoznienie.setSingleShot(true);
+    opoznienie.setInterval(OPOZNIENIE_WYSZUKIWANIA_MS);
+
+    connect(combo->lineEdit(), &QLineEdit::textEdited, this, &ClientCompleter::tekstEdytowany);
+    connect(&opoznienie, &QTimer::timeout, this, &ClientCompleter::szukaj);
+    connect(completer, QOverload<const QModelIndex&>::of(&QCompleter::activated),
+            this, &ClientCompleter::podpowiedzWybrana);
+
+    connect(katalog, &ClientDirectory::wczytano, this, &ClientCompleter::szukaj);
+    connect(katalog, &ClientDirectory::zmienionoKlienta, this, &ClientCompleter::klientZmieniony);
+    connect(katalog, &ClientDirectory::usunietoKlienta, this, &ClientCompleter::klientUsuniety);
+}
+
+void ClientCompleter::ustawKlienta(const Klient& klient) {
+    opoznienie.stop();
+    combo->clear();
+    if (klient.id <= 0) {
+        return;
+    }
+
+    combo->addItem(ClientDirectory::opis(klient), klient.id);
+    combo->setCurrentIndex(0);
+}
+
+void ClientCompleter::wyczysc() {
+    opoznienie.stop();
+    podpowiedzi->clear();
+    combo->clear();
+    combo->clearEditText();
+}
+
+void ClientCompleter::tekstEdytowany(const QString& tekst) {
+    // Wpisanie czegoś innego niż wybrany klient kasuje wybór - currentData() nie może
+    // wskazywać klienta, którego pole już nie pokazuje
+    if (combo->currentIndex() >= 0 && tekst != combo->itemText(combo->currentIndex())) {
+        const int kursor = combo->lineEdit()->cursorPosition();
+        combo->clear();
+        combo->setEditText(tekst);
+        combo->lineEdit()->setCursorPosition(kursor);
+    }
+
+    katalog->wczytaj();     // pierwsze użycie - katalog wczytuje się, zanim minie opóźnienie
+    opoznienie.start();
+}
+
+void ClientCompleter::szukaj() {
+    const QString tekst = combo->lineEdit()->text().trimmed();
+    if (tekst.isEmpty() || combo->currentIndex() >= 0 || !combo->lineEdit()->hasFocus()) {
+        return;
+    }
+    if (!katalog->czyWczytany()) {
+        return;     // wyszukiwanie ponowi sygnał ClientDirectory::wczytano
+    }
+
+    podpowiedzi->clear();
+    for (const Klient& k : katalog->znajdz(tekst, LIMIT_PODPOWIEDZI)) {
+        QStandardItem* pozycja = new QStandardItem(ClientDirectory::opis(k));
+        pozycja->setData(k.id, Qt::UserRole);
+        podpowiedzi->appendRow(pozycja);
+    }
+
+    if (podpowiedzi->rowCount() > 0) {
+        completer->complete();
+    } else {
+        completer->popup()->hide();
+    }
+}
+
+void ClientCompleter::podpowiedzWybrana(const QModelIndex& indeks) {
+    Klient klient = katalog->klient(indeks.data(Qt::UserRole).toInt());
+    ustawKlienta(klient);
+}
+
+void ClientCompleter::klientZmieniony(int id) {
+    if (wybranyId() == id) {
+        combo->setItemText(combo->currentIndex(), ClientDirectory::opis(katalog->klient(id)));
+    }
+}
+
+void ClientCompleter::klientUsuniety(int id) {
+    if (wybranyId() == id) {
+        wyczysc();
+    }
+}
+
+int ClientCompleter::wybranyId() const {
+    return combo->currentIndex() >= 0 ? combo->currentData().toInt() : -1;
+}
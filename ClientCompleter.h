@@ -0,0 +1,39 @@
+#ifndef CLIENTCOMPLETER_H
+#define CLIENTCOMPLETER_H
+
+#include <QObject>
+#include <QComboBox>
+#include <QCompleter>
+#include <QStandardItemModel>
+#include <QTimer>
+#include "ClientDirectory.h"
+
+// Wybór klienta w edytowalnym QComboBox przez wyszukiwanie w ClientDirectory. Wpisany tekst
+// (po krótkiej przerwie w pisaniu) zamienia się w listę najlepszych dopasowań w QCompleter.
+// Sam ComboBox trzyma tylko wybranego klienta: currentData() to jego id, a currentIndex() < 0
+// oznacza brak wyboru - jak wcześniej przy pełnej liście klientów.
+class ClientCompleter : public QObject {
+    Q_OBJECT
+
+public:
+    ClientCompleter(QComboBox* combo, ClientDirectory* katalog, QObject* parent = nullptr);
+
+    void ustawKlienta(const Klient& klient);
+    void wyczysc();
+
+private:
+    void tekstEdytowany(const QString& tekst);
+    void szukaj();
+    void podpowiedzWybrana(const QModelIndex& indeks);
+    void klientZmieniony(int id);
+    void klientUsuniety(int id);
+    int wybranyId() const;
+
+    QComboBox* combo;
+    ClientDirectory* katalog;
+    QStandardItemModel* podpowiedzi;
+    QCompleter* completer;
+    QTimer opoznienie;
+};
+
+#endif // CLIENTCOMPLETER_H
@@ -0,0 +1,203 @@
+#include "ClientDirectory.h"
+#include "QueryExecutor.h"
+#include <QSet>
+#include <algorithm>
+#include <tuple>
+
+ClientDirectory::ClientDirectory(QueryExecutor* zapytania, QObject* parent)
+    : QObject(parent), zapytania(zapytania) {
+    DatabaseNotifier* powiadomienia = DatabaseNotifier::instance();
+    connect(powiadomienia, &DatabaseNotifier::zmieniono, this, &ClientDirectory::daneZmienione);
+    connect(powiadomienia, &DatabaseNotifier::przeladowano, this, &ClientDirectory::danePrzeladowane);
+}
+
+void ClientDirectory::wczytaj() {
+    if (wczytany || wToku) {
+        return;
+    }
+    przeladuj();
+}
+
+bool ClientDirectory::czyWczytany() const {
+    return wczytany;
+}
+
+void ClientDirectory::przeladuj() {
+    wToku = true;
+
+    // Indeks budowany w wątku zapytań - do GUI trafia gotowy. Nowsze wczytanie (ten sam
+    // kanał) unieważnia starsze, więc zmiana w trakcie wczytywania nie zostanie zgubiona.
+    zapytania->uruchom("katalog-klientow", []() {
+        Dane nowe;
+        const QList<Klient> klienci = DatabaseManager::getAllKlienci();
+        nowe.klienci.reserve(klienci.size());
+        for (const Klient& k : klienci) {
+            dodaj(nowe, k);
+        }
+        return nowe;
+    }, this, [this](const Dane& nowe) {
+        dane = nowe;
+        wczytany = true;
+        wToku = false;
+        emit wczytano();
+    });
+}
+
+QList<Klient> ClientDirectory::znajdz(const QString& tekst, int limit) const {
+    QList<Klient> wynik;
+    const QString prefiks = kluczWyszukiwania(tekst);
+    if (prefiks.isEmpty() || limit <= 0) {
+        return wynik;
+    }
+
+    // Klucze z prefiksem leżą w mapie obok siebie - od lowerBound do pierwszego niepasującego.
+    // Najpierw wszyscy pasujący, dopiero po sortowaniu pierwsze "limit" - inaczej wynik
+    // zależałby od kolejności kluczy w indeksie, a nie od nazwiska.
+    QSet<int> znalezieni;
+    for (auto it = dane.indeks.lowerBound(prefiks); it != dane.indeks.cend() && it.key().startsWith(prefiks); ++it) {
+        if (znalezieni.contains(it.value())) {
+            continue;
+        }
+        znalezieni.insert(it.value());
+        wynik.append(dane.klienci.value(it.value()));
+    }
+
+    auto kolejnosc = [](const Klient& a, const Klient& b) {
+        return std::tie(a.nazwisko, a.imie, a.id) < std::tie(b.nazwisko, b.imie, b.id);
+    };
+    if (wynik.size() > limit) {
+        std::partial_sort(wynik.begin(), wynik.begin() + limit, wynik.end(), kolejnosc);
+        wynik.resize(limit);
+    } else {
+        std::sort(wynik.begin(), wynik.end(), kolejnosc);
+    }
+    return wynik;
+}
+
+Klient ClientDirectory::klient(int id) const {
+    return dane.klienci.value(id, Klient{});
+}
+
+QString ClientDirectory::opis(const Klient& klient) {
+    QString tekst = QString("%1 %2").arg(klient.imie).arg(klient.nazwisko);
+    if (!klient.email.isEmpty()) {
+        tekst += QString(" (%1)").arg(klient.email);
+    }
+    return tekst;
+}
+
+// === Indeks prefiksów ===
+
+QStringList ClientDirectory::kluczeKlienta(const Klient& klient) {
+    // Imię i nazwisko osobno oraz razem w obu kolejnościach - "jan kow" i "kowalski j"
+    // znajdą tego samego klienta
+    QStringList klucze = {
+        normalizuj(klient.imie),
+        normalizuj(klient.nazwisko),
+        normalizuj(klient.imie + " " + klient.nazwisko),
+        normalizuj(klient.nazwisko + " " + klient.imie),
+        normalizuj(klient.email),
+        cyfry(klient.telefon)
+    };
+    klucze.removeAll(QString());
+    klucze.removeDuplicates();
+    return klucze;
+}
+
+QString ClientDirectory::kluczWyszukiwania(const QString& tekst) {
+    // Sam numer telefonu (cyfry, spacje, +, -, nawiasy) szukamy po cyfrach
+    const QString przyciety = tekst.trimmed();
+    bool telefon = !przyciety.isEmpty();
+    for (QChar znak : przyciety) {
+        if (!znak.isDigit() && !QStringLiteral(" +-()").contains(znak)) {
+            telefon = false;
+            break;
+        }
+    }
+    return telefon ? cyfry(przyciety) : normalizuj(przyciety);
+}
+
+QString ClientDirectory::normalizuj(const QString& tekst) {
+    // Małe litery bez znaków diakrytycznych: NFD rozdziela literę i znak, znak odrzucamy.
+    // "ł" nie ma rozkładu, więc zamieniamy ją ręcznie.
+    const QString rozlozony = tekst.simplified().toCaseFolded().normalized(QString::NormalizationForm_D);
+    QString wynik;
+    wynik.reserve(rozlozony.size());
+    for (QChar znak : rozlozony) {
+        if (znak.category() == QChar::Mark_NonSpacing) {
+            continue;
+        }
+        wynik.append(znak == QChar(0x0142) ? QChar('l') : znak);
+    }
+    return wynik;
+}
+
+QString ClientDirectory::cyfry(const QString& tekst) {
+    QString wynik;
+    for (QChar znak : tekst) {
+        if (znak.isDigit()) {
+            wynik.append(znak);
+        }
+    }
+    return wynik;
+}
+
+void ClientDirectory::dodaj(Dane& dane, const Klient& klient) {
+    dane.klienci.insert(klient.id, klient);
+    for (const QString& klucz : kluczeKlienta(klient)) {
+        dane.indeks.insert(klucz, klient.id);
+    }
+}
+
+void ClientDirectory::usun(Dane& dane, int id) {
+    auto it = dane.klienci.find(id);
+    if (it == dane.klienci.end()) {
+        return;
+    }
+
+    for (const QString& klucz : kluczeKlienta(*it)) {
+        dane.indeks.remove(klucz, id);
+    }
+    dane.klienci.erase(it);
+}
+
+// === Zmiany w bazie ===
+
+void ClientDirectory::daneZmienione(TabelaDanych tabela, int id, OperacjaZmiany operacja) {
+    if (tabela != TabelaDanych::Klienci) {
+        return;
+    }
+    if (wToku) {
+        // Wczytywany stan mógł powstać przed tym zapisem - wczytaj jeszcze raz
+        przeladuj();
+        return;
+    }
+    if (!wczytany) {
+        return;
+    }
+
+    if (operacja == OperacjaZmiany::Usuniecie) {
+        usun(dane, id);
+        emit usunietoKlienta(id);
+        return;
+    }
+
+    zapytania->uruchom(QString("katalog-klient-%1").arg(id), [id]() {
+        return DatabaseManager::getKlientById(id);
+    }, this, [this, id](const Klient& klient) {
+        usun(dane, id);
+        if (klient.id > 0) {
+            dodaj(dane, klient);
+            emit zmienionoKlienta(id);
+        } else {
+            emit usunietoKlienta(id);
+        }
+    });
+}
+
+void ClientDirectory::danePrzeladowane(TabelaDanych tabela) {
+    // Niewczytany katalog i tak wczyta aktualny stan przy pierwszym wyszukiwaniu
+    if (tabela == TabelaDanych::Klienci && (wczytany || wToku)) {
+        przeladuj();
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef CLIENTDIRECTORY_H
+#define CLIENTDIRECTORY_H
+
+#include <QObject>
+#include <QHash>
+#include <QMultiMap>
+#include <QList>
+#include <QStringList>
+#include "DatabaseManager.h"
+#include "DatabaseNotifier.h"
+
+class QueryExecutor;
+
+// Katalog klientów wspólny dla wszystkich pól wyboru klienta. Wczytywany raz, w tle, dopiero
+// przy pierwszym wyszukiwaniu - potem wyszukiwanie to przejście po indeksie prefiksów
+// w pamięci (imię, nazwisko, e-mail, telefon), bez zapytań do bazy. Zmiany klientów
+// dochodzą przez DatabaseNotifier: pojedynczy wiersz albo ponowne wczytanie po imporcie.
+class ClientDirectory : public QObject {
+    Q_OBJECT
+
+public:
+    explicit ClientDirectory(QueryExecutor* zapytania, QObject* parent = nullptr);
+
+    void wczytaj();                     // bez efektu, gdy katalog jest wczytany albo się wczytuje
+    bool czyWczytany() const;
+
+    // Co najwyżej `limit` klientów, u których któreś pole zaczyna się od podanego tekstu.
+    // Wielkość liter i polskie znaki nie mają znaczenia, telefon porównywany po samych cyfrach.
+    QList<Klient> znajdz(const QString& tekst, int limit = 20) const;
+    Klient klient(int id) const;        // id == 0 gdy nie ma go w katalogu
+
+    static QString opis(const Klient& klient);  // tekst pozycji na liście wyboru
+
+signals:
+    void wczytano();
+    void zmienionoKlienta(int id);
+    void usunietoKlienta(int id);
+
+private:
+    struct Dane {
+        QHash<int, Klient> klienci;
+        QMultiMap<QString, int> indeks;     // znormalizowane pole -> id klienta
+    };
+
+    static QStringList kluczeKlienta(const Klient& klient);
+    static QString kluczWyszukiwania(const QString& tekst);
+    static QString normalizuj(const QString& tekst);
+    static QString cyfry(const QString& tekst);
+    static void dodaj(Dane& dane, const Klient& klient);
+    static void usun(Dane& dane, int id);
+
+    void przeladuj();
+    void daneZmienione(TabelaDanych tabela, int id, OperacjaZmiany operacja);
+    void danePrzeladowane(TabelaDanych tabela);
+
+    QueryExecutor* zapytania;
+    Dane dane;
+    bool wczytany = false;
+    bool wToku = false;
+};
+
+#endif // CLIENTDIRECTORY_H
@@ -0,0 +1,212 @@
+#include "CsvReader.h"
+#include <QDebug>
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace {
+
+// Bajty kończące pole bez cudzysłowów - jedno sprawdzenie tablicy zamiast trzech porównań
+constexpr std::array<bool, 256> koniecPola = [] {
+    std::array<bool, 256> tablica{};
+    tablica[static_cast<unsigned char>(',')] = true;
+    tablica[static_cast<unsigned char>('\r')] = true;
+    tablica[static_cast<unsigned char>('\n')] = true;
+    return tablica;
+}();
+
+inline bool czyKoniecPola(char znak) {
+    return koniecPola[static_cast<unsigned char>(znak)];
+}
+
+} // namespace
+
+CsvReader::~CsvReader() {
+    close();
+}
+
+bool CsvReader::open(const QString& filePath) {
+    close();
+
+    file.setFileName(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        blad = file.errorString();
+        return false;
+    }
+
+    rozmiar = file.size();
+    if (rozmiar > 0) {
+        mapa = file.map(0, rozmiar);
+    }
+
+    if (mapa) {
+        dane = reinterpret_cast<const char*>(mapa);
+    } else {
+        // Np. pusty plik albo system plików bez mmap - czytamy całość do pamięci
+        kopia = file.readAll();
+        dane = kopia.constData();
+        rozmiar = kopia.size();
+    }
+    wiersz.dane = dane;
+
+    // Znacznik BOM z eksportu Excela
+    if (rozmiar >= 3 && std::memcmp(dane, "\xEF\xBB\xBF", 3) == 0) {
+        pozycja = 3;
+    }
+    return true;
+}
+
+void CsvReader::close() {
+    if (mapa) {
+        file.unmap(mapa);
+        mapa = nullptr;
+    }
+    if (file.isOpen()) {
+        file.close();
+    }
+    kopia.clear();
+    dane = nullptr;
+    rozmiar = 0;
+    pozycja = 0;
+    wiersz = CsvRow();
+    liniaWiersza = 0;
+    biezacaLinia = 1;
+}
+
+QString CsvReader::errorString() const {
+    return blad;
+}
+
+bool CsvReader::readRow() {
+    // Kopie poprzedniego wiersza (np. w innym wątku) zachowują swoje pola
+    QVector<CsvRow::Pole>& pola = wiersz.pola;
+    pola.clear();
+
+    // Pomiń puste linie między wierszami
+    while (pozycja < rozmiar && (dane[pozycja] == '\r' || dane[pozycja] == '\n')) {
+        if (dane[pozycja] == '\n') {
+            ++biezacaLinia;
+        }
+        ++pozycja;
+    }
+    if (pozycja >= rozmiar) {
+        return false;
+    }
+
+    liniaWiersza = biezacaLinia;
+
+    while (true) {
+        if (pozycja < rozmiar && dane[pozycja] == '"') {
+            // Pole w cudzysłowach - szukamy zamykającego cudzysłowu przez memchr
+            const qsizetype poczatek = ++pozycja;
+            qsizetype koniec = rozmiar;
+            bool podwojone = false;
+
+            while (pozycja < rozmiar) {
+                const char* cudzyslow = static_cast<const char*>(
+                    std::memchr(dane + pozycja, '"', static_cast<size_t>(rozmiar - pozycja)));
+                const char* granica = cudzyslow ? cudzyslow : dane + rozmiar;
+                biezacaLinia += static_cast<int>(std::count(dane + pozycja, granica, '\n'));
+
+                if (!cudzyslow) {
+                    // Niezamknięty cudzysłów - reszta pliku należy do pola
+                    qWarning() << "CSV: niezamknięty cudzysłów w wierszu od linii" << liniaWiersza;
+                    pozycja = rozmiar;
+                    break;
+                }
+
+                const qsizetype indeks = cudzyslow - dane;
+                if (indeks + 1 < rozmiar && dane[indeks + 1] == '"') {
+                    podwojone = true;
+                    pozycja = indeks + 2;
+                    continue;
+                }
+
+                koniec = indeks;
+                pozycja = indeks + 1;
+                break;
+            }
+
+            pola.append({poczatek, koniec - poczatek, podwojone});
+
+            // Znaki między zamykającym cudzysłowem a separatorem są ignorowane
+            while (pozycja < rozmiar && !czyKoniecPola(dane[pozycja])) {
+                ++pozycja;
+            }
+        } else {
+            const qsizetype poczatek = pozycja;
+            while (pozycja < rozmiar && !czyKoniecPola(dane[pozycja])) {
+                ++pozycja;
+            }
+            pola.append({poczatek, pozycja - poczatek, false});
+        }
+
+        if (pozycja >= rozmiar) {
+            return true;
+        }
+
+        const char znak = dane[pozycja++];
+        if (znak == ',') {
+            continue;
+        }
+
+        // Koniec wiersza: \n, \r\n albo samo \r
+        if (znak == '\r' && pozycja < rozmiar && dane[pozycja] == '\n') {
+            ++pozycja;
+        }
+        ++biezacaLinia;
+        return true;
+    }
+}
+
+int CsvRow::fieldCount() const {
+    return static_cast<int>(pola.size());
+}
+
+QByteArrayView CsvRow::fieldView(int index) const {
+    if (index < 0 || index >= pola.size()) {
+        return QByteArrayView();
+    }
+    const Pole& pole = pola.at(index);
+    return QByteArrayView(dane + pole.poczatek, pole.dlugosc);
+}
+
+QString CsvRow::field(int index) const {
+    if (index < 0 || index >= pola.size()) {
+        return QString();
+    }
+
+    QString wartosc = QString::fromUtf8(fieldView(index));
+    if (pola.at(index).podwojoneCudzyslowy) {
+        wartosc.replace("\"\"", "\"");
+    }
+    return wartosc;
+}
+
+const CsvRow& CsvReader::row() const {
+    return wiersz;
+}
+
+int CsvReader::fieldCount() const {
+    return wiersz.fieldCount();
+}
+
+QByteArrayView CsvReader::fieldView(int index) const {
+    return wiersz.fieldView(index);
+}
+
+QString CsvReader::field(int index) const {
+    return wiersz.field(index);
+}
+
+int CsvReader::lineNumber() const {
+    return liniaWiersza;
+}
+
+qint64 CsvReader::position() const {
+    return pozycja;
+}
+
+qint64 CsvReader::size() const {
+    return rozmiar;
+}
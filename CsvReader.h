@@ -0,0 +1,72 @@
+#ifndef CSVREADER_H
+#define CSVREADER_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+// Pola jednego wiersza CSV jako widoki na bufor czytnika. Pozostają ważne po kolejnych
+// readRow() - aż do CsvReader::close() - więc wiersz można przekazać innemu wątkowi.
+class CsvRow {
+public:
+    int fieldCount() const;
+    QByteArrayView fieldView(int index) const;  // surowe bajty UTF-8, bez otaczających cudzysłowów
+    QString field(int index) const;             // zdekodowane pole ("" zamienione na ")
+
+private:
+    friend class CsvReader;
+
+    struct Pole {
+        qsizetype poczatek;
+        qsizetype dlugosc;
+        bool podwojoneCudzyslowy;   // pole zawiera "" do zamiany przy dekodowaniu
+    };
+
+    const char* dane = nullptr;
+    QVector<Pole> pola;
+};
+
+// Czytnik CSV zgodny z RFC 4180 (pola w cudzysłowach, "" w środku pola, znaki nowej
+// linii wewnątrz pól). Plik jest mapowany do pamięci, a pola wiersza to widoki na
+// zmapowany bufor - kopia powstaje dopiero przy zamianie pola na QString.
+class CsvReader {
+public:
+    CsvReader() = default;
+    ~CsvReader();
+
+    CsvReader(const CsvReader&) = delete;
+    CsvReader& operator=(const CsvReader&) = delete;
+
+    bool open(const QString& filePath);
+    void close();
+    QString errorString() const;
+
+    // Wczytuje następny wiersz (puste linie są pomijane); false na końcu pliku
+    bool readRow();
+
+    const CsvRow& row() const;                  // bieżący wiersz
+    int fieldCount() const;
+    QByteArrayView fieldView(int index) const;
+    QString field(int index) const;
+
+    int lineNumber() const;                     // linia pliku, w której zaczyna się bieżący wiersz
+    qint64 position() const;                    // ile bajtów pliku już przeczytano
+    qint64 size() const;
+
+private:
+    QFile file;
+    uchar* mapa = nullptr;
+    QByteArray kopia;               // gdy mapowanie pliku jest niedostępne
+    const char* dane = nullptr;
+    qsizetype rozmiar = 0;
+    qsizetype pozycja = 0;
+
+    CsvRow wiersz;
+    int liniaWiersza = 0;
+    int biezacaLinia = 1;
+    QString blad;
+};
+
+#endif // CSVREADER_H
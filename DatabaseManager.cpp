@@ -1,42 +1,1494 @@
 #include "DatabaseManager.h"
+#include "CsvReader.h"
+#include "DatabaseNotifier.h"
 #include <QtSql/QSqlError>
 #include <QtSql/QSqlQuery>
 #include <QDebug>
 #include <QDateTime>
-#include <QTextStream>
 #include <QFile>
 #include <QDir>
 #include <QFileInfo>
 #include <QRegularExpression>
+#include <QThread>
+#include <QThreadStorage>
+#include <QMutex>
+#include <QCache>
+#include <QAtomicInt>
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+// Połączenie należące do jednego wątku razem z jego przygotowanymi zapytaniami.
+// Qt pozwala używać QSqlDatabase tylko w wątku, który je utworzył.
+struct PolaczenieWatku {
+    QString nazwa;
+    int generacja = 0;
+    int generacjaProfilu = -1;      // który profil (wg generacjaProfilu) jest zastosowany
+    int profilLokalny = -1;         // profil tylko tego połączenia (ZmianaProfiluBazy), -1 = globalny
+    QSqlDatabase db;
+    QHash<QString, QSqlQuery> cacheZapytan;
+
+    ~PolaczenieWatku() {
+        // Zapytania i kopia QSqlDatabase muszą zniknąć przed removeDatabase()
+        cacheZapytan.clear();
+        if (db.isOpen()) {
+            db.close();
+        }
+        db = QSqlDatabase();
+        QSqlDatabase::removeDatabase(nazwa);
+    }
+};
+
+QThreadStorage<PolaczenieWatku*> polaczenia;   // usuwane automatycznie przy końcu wątku
+QAtomicInt licznikPolaczen;
+QAtomicInt generacjaPolaczen;                   // zmiana unieważnia połączenia wszystkich wątków
+
+QMutex konfiguracjaMutex;
+QString sciezkaBazy;
+PolitykaBlokad politykaBlokad;
+
+QAtomicInt aktualnyProfil(static_cast<int>(ProfilBazy::Biurowy));
+QAtomicInt generacjaProfilu;                    // zmiana = połączenia muszą ponowić PRAGMA
+
+QAtomicInteger<quint64> trafieniaCacheZapytan;
+QAtomicInteger<quint64> chybieniaCacheZapytan;
+
+// Encje czytane po id, wspólne dla wszystkich wątków. QCache ogranicza liczbę obiektów
+// i wyrzuca najdawniej używane. Unieważnienie podbija generację - wiersz przeczytany
+// z bazy przed zmianą, a wstawiany już po niej, nie trafi do cache.
+template<typename T>
+class CacheEncji {
+public:
+    explicit CacheEncji(int pojemnosc) : obiekty(pojemnosc) {}
+
+    // false = chybienie; generacjaOdczytu trzeba potem przekazać do zapisz()
+    bool pobierz(int id, T& wynik, quint64& generacjaOdczytu) {
+        QMutexLocker locker(&mutex);
+        if (const T* obiekt = obiekty.object(id)) {
+            wynik = *obiekt;
+            ++trafienia;
+            return true;
+        }
+        ++chybienia;
+        generacjaOdczytu = generacja;
+        return false;
+    }
+
+    void zapisz(int id, const T& obiekt, quint64 generacjaOdczytu) {
+        QMutexLocker locker(&mutex);
+        if (generacjaOdczytu == generacja) {
+            obiekty.insert(id, new T(obiekt));
+        }
+    }
+
+    void usun(int id) {
+        QMutexLocker locker(&mutex);
+        obiekty.remove(id);
+        ++generacja;
+    }
+
+    void wyczysc() {
+        QMutexLocker locker(&mutex);
+        obiekty.clear();
+        ++generacja;
+    }
+
+    void zerujStatystyki() {
+        QMutexLocker locker(&mutex);
+        trafienia = 0;
+        chybienia = 0;
+    }
+
+    void ustawPojemnosc(int pojemnosc) {
+        QMutexLocker locker(&mutex);
+        obiekty.setMaxCost(pojemnosc);
+    }
+
+    StatystykiCache statystyki() const {
+        QMutexLocker locker(&mutex);
+        return {trafienia, chybienia, static_cast<int>(obiekty.size())};
+    }
+
+private:
+    mutable QMutex mutex;
+    QCache<int, T> obiekty;
+    quint64 trafienia = 0;
+    quint64 chybienia = 0;
+    quint64 generacja = 0;
+};
+
+const int DOMYSLNA_POJEMNOSC_CACHE_ENCJI = 1000;
+
+CacheEncji<Klient> cacheKlientow(DOMYSLNA_POJEMNOSC_CACHE_ENCJI);
+CacheEncji<Zajecia> cacheZajec(DOMYSLNA_POJEMNOSC_CACHE_ENCJI);
+CacheEncji<Karnet> cacheKarnetow(DOMYSLNA_POJEMNOSC_CACHE_ENCJI);    // z danymi klienta (join)
+
+// Wersje tabel dla cache wyników list. Każdy zapis (add/update/delete, import) podbija
+// wersję swojej tabeli; zmiany robione triggerami (liczniki rezerwacji) idą na konto
+// tabeli, do której pisano - listy czytające liczniki zależą więc też od rezerwacji.
+QAtomicInteger<quint64> wersjeTabel[4];
+
+using WersjeTabel = QList<QPair<TabelaDanych, quint64>>;
+
+void podbijWersje(TabelaDanych tabela) {
+    wersjeTabel[static_cast<int>(tabela)].fetchAndAddOrdered(1);
+}
+
+WersjeTabel odczytajWersje(std::initializer_list<TabelaDanych> tabele) {
+    WersjeTabel wersje;
+    for (TabelaDanych tabela : tabele) {
+        wersje.append({tabela, wersjeTabel[static_cast<int>(tabela)].loadAcquire()});
+    }
+    return wersje;
+}
+
+bool czyAktualne(const WersjeTabel& wersje) {
+    for (const auto& wersja : wersje) {
+        if (wersjeTabel[static_cast<int>(wersja.first)].loadAcquire() != wersja.second) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Wyniki całych list, klucz = treść SQL i związane parametry. Wpis pamięta wersje
+// tabel sprzed wykonania zapytania, więc zapis w trakcie czytania też go unieważnia.
+// Koszt wpisu w QCache to liczba wierszy; trafienie zwraca kopię QList (implicit sharing).
+template<typename T>
+class CacheWynikow {
+public:
+    explicit CacheWynikow(int pojemnosc) : wyniki(pojemnosc) {}
+
+    bool pobierz(const QString& klucz, QList<T>& wynik) {
+        QMutexLocker locker(&mutex);
+        if (const Wpis* wpis = wyniki.object(klucz)) {
+            if (czyAktualne(wpis->wersje)) {
+                wynik = wpis->wiersze;
+                ++trafienia;
+                return true;
+            }
+            wyniki.remove(klucz);
+        }
+        ++chybienia;
+        return false;
+    }
+
+    void zapisz(const QString& klucz, const QList<T>& wiersze, const WersjeTabel& wersje) {
+        QMutexLocker locker(&mutex);
+        if (czyAktualne(wersje)) {
+            wyniki.insert(klucz, new Wpis{wiersze, wersje}, qMax(1, static_cast<int>(wiersze.size())));
+        }
+    }
+
+    void wyczysc() {
+        QMutexLocker locker(&mutex);
+        wyniki.clear();
+    }
+
+    void zerujStatystyki() {
+        QMutexLocker locker(&mutex);
+        trafienia = 0;
+        chybienia = 0;
+    }
+
+    void ustawPojemnosc(int pojemnosc) {
+        QMutexLocker locker(&mutex);
+        wyniki.setMaxCost(pojemnosc);
+    }
+
+    StatystykiCache statystyki() const {
+        QMutexLocker locker(&mutex);
+        return {trafienia, chybienia, static_cast<int>(wyniki.size())};
+    }
+
+private:
+    struct Wpis {
+        QList<T> wiersze;
+        WersjeTabel wersje;
+    };
+
+    mutable QMutex mutex;
+    QCache<QString, Wpis> wyniki;
+    quint64 trafienia = 0;
+    quint64 chybienia = 0;
+};
+
+const int DOMYSLNA_POJEMNOSC_CACHE_WYNIKOW = 50000;    // wierszy na każdy typ encji
+
+template<typename T>
+CacheWynikow<T>& cacheWynikow() {
+    static CacheWynikow<T> cache(DOMYSLNA_POJEMNOSC_CACHE_WYNIKOW);
+    return cache;
+}
+
+template<typename F>
+void dlaCacheWynikow(F&& operacja) {
+    operacja(cacheWynikow<Klient>());
+    operacja(cacheWynikow<Zajecia>());
+    operacja(cacheWynikow<Rezerwacja>());
+    operacja(cacheWynikow<Karnet>());
+}
+
+struct UstawieniaProfilu {
+    const char* nazwa;
+    const char* synchronous;
+    int cacheKiB;               // PRAGMA cache_size w KiB (podawane jako wartość ujemna)
+    qint64 mmapBajty;
+    bool tylkoOdczyt;
+};
+
+UstawieniaProfilu ustawieniaProfilu(ProfilBazy profil) {
+    switch (profil) {
+    case ProfilBazy::ImportMasowy:
+        // Bez fsync przy każdym zatwierdzeniu - awaria może cofnąć ostatnie transakcje,
+        // ale WAL chroni plik bazy przed uszkodzeniem
+        return {"bulk-load", "OFF", 64 * 1024, 256LL * 1024 * 1024, false};
+    case ProfilBazy::Raportowy:
+        return {"read-only reporting", "NORMAL", 32 * 1024, 256LL * 1024 * 1024, true};
+    case ProfilBazy::Biurowy:
+        break;
+    }
+    return {"desk", "NORMAL", 16 * 1024, 64LL * 1024 * 1024, false};
+}
+
+ProfilBazy profilPolaczenia(const PolaczenieWatku* polaczenie) {
+    return static_cast<ProfilBazy>(polaczenie->profilLokalny >= 0 ? polaczenie->profilLokalny
+                                                                  : aktualnyProfil.loadAcquire());
+}
+
+bool zastosujProfil(QSqlDatabase& db, ProfilBazy profil) {
+    const UstawieniaProfilu u = ustawieniaProfilu(profil);
+
+    // page_size działa tylko dla nowego pliku bazy (przed utworzeniem pierwszej tabeli);
+    // journal_mode=WAL jest trwałe, ale ustawiamy je zawsze - dla WAL to operacja pusta
+    const QStringList polecenia = {
+        "PRAGMA page_size = 4096",
+        "PRAGMA journal_mode = WAL",
+        QString("PRAGMA synchronous = %1").arg(u.synchronous),
+        QString("PRAGMA cache_size = -%1").arg(u.cacheKiB),
+        QString("PRAGMA mmap_size = %1").arg(u.mmapBajty),
+        "PRAGMA temp_store = MEMORY",
+        QString("PRAGMA query_only = %1").arg(u.tylkoOdczyt ? "ON" : "OFF")
+    };
+
+    bool ok = true;
+    QSqlQuery query(db);
+    for (const QString& polecenie : polecenia) {
+        if (!query.exec(polecenie)) {
+            qWarning() << "Nie udało się ustawić" << polecenie << ":" << query.lastError().text();
+            ok = false;
+        }
+        query.finish();
+    }
+    return ok;
+}
+
+PolaczenieWatku* polaczenieWatku() {
+    const int generacja = generacjaPolaczen.loadAcquire();
+    PolaczenieWatku* polaczenie = polaczenia.localData();
+    if (polaczenie && polaczenie->generacja == generacja) {
+        // Profil zmieniony w innym wątku - dociągamy PRAGMA przy najbliższym użyciu
+        const int profilGeneracja = generacjaProfilu.loadAcquire();
+        if (polaczenie->generacjaProfilu != profilGeneracja) {
+            zastosujProfil(polaczenie->db, profilPolaczenia(polaczenie));
+            polaczenie->generacjaProfilu = profilGeneracja;
+        }
+        return polaczenie;
+    }
+
+    // Brak połączenia albo należy do poprzedniego connect() - setLocalData usuwa stare
+    polaczenia.setLocalData(nullptr);
 
-QSqlDatabase DatabaseManager::db = QSqlDatabase();
+    QString sciezka;
+    PolitykaBlokad polityka;
+    {
+        QMutexLocker locker(&konfiguracjaMutex);
+        sciezka = sciezkaBazy;
+        polityka = politykaBlokad;
+    }
+    if (sciezka.isEmpty()) {
+        return nullptr;
+    }
+
+    auto* nowe = new PolaczenieWatku;
+    nowe->nazwa = QString("gym_connection_%1").arg(licznikPolaczen.fetchAndAddRelaxed(1));
+    nowe->generacja = generacja;
+    nowe->db = QSqlDatabase::addDatabase("QSQLITE", nowe->nazwa);
+    nowe->db.setDatabaseName(sciezka);
+    nowe->db.setConnectOptions(QString("QSQLITE_BUSY_TIMEOUT=%1").arg(polityka.busyTimeoutMs));
+
+    if (!nowe->db.open()) {
+        qWarning() << "Nie udało się otworzyć bazy danych:" << nowe->db.lastError().text();
+        delete nowe;
+        return nullptr;
+    }
+
+    nowe->generacjaProfilu = generacjaProfilu.loadAcquire();
+    zastosujProfil(nowe->db, static_cast<ProfilBazy>(aktualnyProfil.loadAcquire()));
+
+    polaczenia.setLocalData(nowe);
+    return nowe;
+}
+
+bool czyBazaZajeta(const QSqlError& blad) {
+    // SQLITE_BUSY (5) i SQLITE_LOCKED (6), również w wersjach rozszerzonych kodów
+    const int kod = blad.nativeErrorCode().toInt() & 0xff;
+    return kod == 5 || kod == 6;
+}
+
+} // namespace
 
 // === Podstawowe metody połączenia ===
 
-bool DatabaseManager::connect(const QString& path) {
-    if (QSqlDatabase::contains("gym_connection")) {
-        db = QSqlDatabase::database("gym_connection");
-    } else {
-        db = QSqlDatabase::addDatabase("QSQLITE", "gym_connection");
-        db.setDatabaseName(path);
+bool DatabaseManager::connect(const QString& path, ProfilBazy profil) {
+    {
+        QMutexLocker locker(&konfiguracjaMutex);
+        sciezkaBazy = path;
     }
+    // Migracje muszą móc pisać - profil tylko do odczytu włączamy dopiero po nich
+    aktualnyProfil.storeRelease(static_cast<int>(profil == ProfilBazy::Raportowy ? ProfilBazy::Biurowy : profil));
+    generacjaProfilu.fetchAndAddOrdered(1);
+    generacjaPolaczen.fetchAndAddOrdered(1);
 
-    if (!db.open()) {
-        qWarning() << "Nie udało się otworzyć bazy danych:" << db.lastError().text();
+    QSqlDatabase db = database();
+    if (!db.isOpen()) {
         return false;
     }
+
+    if (!migrateSchema()) {
+        qWarning() << "Nie udało się zaktualizować schematu bazy danych";
+        disconnect();
+        return false;
+    }
+
+    if (profil != storageProfile()) {
+        setStorageProfile(profil);
+    }
+    qDebug() << "Profil bazy danych:" << storageProfileName(profil);
     return true;
 }
 
 void DatabaseManager::disconnect() {
-    if (db.isOpen()) {
-        db.close();
+    {
+        QMutexLocker locker(&konfiguracjaMutex);
+        sciezkaBazy.clear();
+    }
+    generacjaPolaczen.fetchAndAddOrdered(1);
+
+    // Następne połączenie może wskazywać inną bazę
+    cacheKlientow.wyczysc();
+    cacheZajec.wyczysc();
+    cacheKarnetow.wyczysc();
+    dlaCacheWynikow([](auto& cache) { cache.wyczysc(); });
+
+    // Połączenie bieżącego wątku zamykamy od razu, pozostałe wątki zwolnią swoje przy
+    // następnym użyciu albo przy zakończeniu wątku
+    polaczenia.setLocalData(nullptr);
+}
+
+QSqlDatabase DatabaseManager::instance() {
+    return database();
+}
+
+QSqlDatabase DatabaseManager::database() {
+    PolaczenieWatku* polaczenie = polaczenieWatku();
+    return polaczenie ? polaczenie->db : QSqlDatabase();
+}
+
+void DatabaseManager::setBusyPolicy(const PolitykaBlokad& polityka) {
+    {
+        QMutexLocker locker(&konfiguracjaMutex);
+        politykaBlokad = polityka;
+    }
+    // Nowy busy timeout trafia do połączeń przy ich ponownym otwarciu
+    generacjaPolaczen.fetchAndAddOrdered(1);
+}
+
+PolitykaBlokad DatabaseManager::busyPolicy() {
+    QMutexLocker locker(&konfiguracjaMutex);
+    return politykaBlokad;
+}
+
+// === Profile ustawień bazy ===
+
+bool DatabaseManager::setStorageProfile(ProfilBazy profil) {
+    aktualnyProfil.storeRelease(static_cast<int>(profil));
+    const int profilGeneracja = generacjaProfilu.fetchAndAddOrdered(1) + 1;
+
+    // Bieżący wątek przełączamy od razu, żeby zgłosić ewentualny błąd wywołującemu;
+    // pozostałe połączenia zastosują profil przy najbliższym zapytaniu
+    PolaczenieWatku* polaczenie = polaczenia.localData();
+    if (!polaczenie || polaczenie->generacja != generacjaPolaczen.loadAcquire()) {
+        return database().isOpen();
+    }
+    polaczenie->generacjaProfilu = profilGeneracja;
+    return zastosujProfil(polaczenie->db, profilPolaczenia(polaczenie));
+}
+
+ProfilBazy DatabaseManager::storageProfile() {
+    return static_cast<ProfilBazy>(aktualnyProfil.loadAcquire());
+}
+
+QString DatabaseManager::storageProfileName(ProfilBazy profil) {
+    return QString::fromLatin1(ustawieniaProfilu(profil).nazwa);
+}
+
+ZmianaProfiluBazy::ZmianaProfiluBazy(ProfilBazy profil) {
+    // Tylko połączenie bieżącego wątku - pozostałe (np. zapisy z UI) zachowują swój profil
+    PolaczenieWatku* polaczenie = polaczenieWatku();
+    if (!polaczenie) {
+        return;
+    }
+    generacja = polaczenie->generacja;
+    poprzedni = polaczenie->profilLokalny;
+    polaczenie->profilLokalny = static_cast<int>(profil);
+    zastosujProfil(polaczenie->db, profil);
+}
+
+ZmianaProfiluBazy::~ZmianaProfiluBazy() {
+    // Po ponownym connect() połączenie jest nowe i ma już profil globalny
+    PolaczenieWatku* polaczenie = polaczenia.localData();
+    if (!polaczenie || polaczenie->generacja != generacja) {
+        return;
+    }
+    polaczenie->profilLokalny = poprzedni;
+    zastosujProfil(polaczenie->db, profilPolaczenia(polaczenie));
+}
+
+bool DatabaseManager::execWithRetry(QSqlQuery& query) {
+    const PolitykaBlokad polityka = busyPolicy();
+    int opoznienie = polityka.poczatkoweOpoznienieMs;
+
+    for (int proba = 0; ; ++proba) {
+        if (query.exec()) {
+            return true;
+        }
+        if (proba >= polityka.maksPonowien || !czyBazaZajeta(query.lastError())) {
+            return false;
+        }
+
+        qDebug() << "Baza zajęta, ponowienie" << (proba + 1) << "za" << opoznienie << "ms";
+        QThread::msleep(opoznienie);
+        opoznienie *= 2;
+    }
+}
+
+// === Cache przygotowanych zapytań ===
+
+QSqlQuery DatabaseManager::preparedQuery(const QString& sql) {
+    PolaczenieWatku* polaczenie = polaczenieWatku();
+    if (!polaczenie) {
+        return QSqlQuery();
+    }
+
+    auto it = polaczenie->cacheZapytan.constFind(sql);
+    if (it != polaczenie->cacheZapytan.constEnd()) {
+        trafieniaCacheZapytan.fetchAndAddRelaxed(1);
+        // Kopia QSqlQuery współdzieli skompilowane zapytanie - wystarczy zresetować kursor
+        QSqlQuery query = it.value();
+        query.finish();
+        return query;
+    }
+
+    chybieniaCacheZapytan.fetchAndAddRelaxed(1);
+    QSqlQuery query(polaczenie->db);
+    query.setForwardOnly(true);
+    if (!query.prepare(sql)) {
+        qWarning() << "Błąd przygotowania zapytania:" << query.lastError().text();
+        return query;
+    }
+
+    polaczenie->cacheZapytan.insert(sql, query);
+    return query;
+}
+
+StatystykiCache DatabaseManager::statementCacheStats() {
+    PolaczenieWatku* polaczenie = polaczenieWatku();
+    return {trafieniaCacheZapytan.loadRelaxed(),
+            chybieniaCacheZapytan.loadRelaxed(),
+            polaczenie ? static_cast<int>(polaczenie->cacheZapytan.size()) : 0};
+}
+
+void DatabaseManager::clearStatementCache() {
+    if (PolaczenieWatku* polaczenie = polaczenia.localData()) {
+        polaczenie->cacheZapytan.clear();
+    }
+    trafieniaCacheZapytan.storeRelaxed(0);
+    chybieniaCacheZapytan.storeRelaxed(0);
+}
+
+// === Cache encji czytanych po id ===
+
+StatystykiCacheEncji DatabaseManager::entityCacheStats() {
+    return {cacheKlientow.statystyki(), cacheZajec.statystyki(), cacheKarnetow.statystyki()};
+}
+
+void DatabaseManager::clearEntityCache() {
+    cacheKlientow.wyczysc();
+    cacheZajec.wyczysc();
+    cacheKarnetow.wyczysc();
+    cacheKlientow.zerujStatystyki();
+    cacheZajec.zerujStatystyki();
+    cacheKarnetow.zerujStatystyki();
+}
+
+void DatabaseManager::setEntityCacheCapacity(int obiekty) {
+    obiekty = qMax(0, obiekty);
+    cacheKlientow.ustawPojemnosc(obiekty);
+    cacheZajec.ustawPojemnosc(obiekty);
+    cacheKarnetow.ustawPojemnosc(obiekty);
+}
+
+// === Cache wyników list ===
+
+StatystykiCache DatabaseManager::resultCacheStats() {
+    StatystykiCache suma = {0, 0, 0};
+    dlaCacheWynikow([&suma](const auto& cache) {
+        const StatystykiCache czesc = cache.statystyki();
+        suma.trafienia += czesc.trafienia;
+        suma.chybienia += czesc.chybienia;
+        suma.rozmiar += czesc.rozmiar;
+    });
+    return suma;
+}
+
+void DatabaseManager::clearResultCache() {
+    dlaCacheWynikow([](auto& cache) {
+        cache.wyczysc();
+        cache.zerujStatystyki();
+    });
+}
+
+void DatabaseManager::setResultCacheCapacity(int wiersze) {
+    wiersze = qMax(0, wiersze);
+    dlaCacheWynikow([wiersze](auto& cache) { cache.ustawPojemnosc(wiersze); });
+}
+
+bool DatabaseManager::beginWriteTransaction() {
+    QSqlQuery query = preparedQuery("BEGIN IMMEDIATE");
+    if (!execWithRetry(query)) {
+        qWarning() << "Nie można rozpocząć transakcji zapisu:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool DatabaseManager::commitTransaction() {
+    QSqlQuery query = preparedQuery("COMMIT");
+    if (!execWithRetry(query)) {
+        qWarning() << "Błąd zatwierdzania transakcji:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+void DatabaseManager::rollbackTransaction() {
+    QSqlQuery query = preparedQuery("ROLLBACK");
+    if (!query.exec()) {
+        qWarning() << "Błąd wycofywania transakcji:" << query.lastError().text();
+    }
+}
+
+// === Daty i czasy w bazie ===
+
+namespace {
+
+// Daty i czasy zapisujemy jako liczby całkowite - porównanie i sortowanie to porównanie
+// liczb, a zakres dat to zakres w indeksie. Tekst ("yyyy-MM-dd" itd.) pojawia się dopiero
+// w UI i w plikach CSV. Brak wartości = NULL.
+const qint64 DZIEN_EPOKI = 2440588;     // QDate(1970, 1, 1).toJulianDay()
+
+QVariant dzienDoBazy(const QDate& data) {
+    return data.isValid() ? QVariant(data.toJulianDay() - DZIEN_EPOKI) : QVariant();
+}
+
+QDate dzienZBazy(const QVariant& wartosc) {
+    return wartosc.isNull() ? QDate() : QDate::fromJulianDay(wartosc.toLongLong() + DZIEN_EPOKI);
+}
+
+QVariant minutaDoBazy(const QTime& czas) {
+    return czas.isValid() ? QVariant(czas.hour() * 60 + czas.minute()) : QVariant();
+}
+
+QTime minutaZBazy(const QVariant& wartosc) {
+    return wartosc.isNull() ? QTime() : QTime(0, 0).addSecs(wartosc.toInt() * 60);
+}
+
+QVariant chwilaDoBazy(const QDateTime& chwila) {
+    return chwila.isValid() ? QVariant(chwila.toSecsSinceEpoch()) : QVariant();
+}
+
+QDateTime chwilaZBazy(const QVariant& wartosc) {
+    return wartosc.isNull() ? QDateTime() : QDateTime::fromSecsSinceEpoch(wartosc.toLongLong());
+}
+
+// Te same zamiany po stronie SQL - tekst z dawnych kolumn (migracja) i tekst do CSV (eksport).
+// Nieprawidłowy tekst daje NULL, tak jak QDate::fromString daje nieprawidłową datę.
+QString sqlDzienZTekstu(const char* kolumna) {
+    return QString("CAST(julianday(%1) - 2440587.5 AS INTEGER)").arg(kolumna);
+}
+
+QString sqlMinutaZTekstu(const char* kolumna) {
+    return QString("CAST(strftime('%H', %1) AS INTEGER) * 60 + CAST(strftime('%M', %1) AS INTEGER)").arg(kolumna);
+}
+
+QString sqlChwilaZTekstu(const char* kolumna) {
+    // Dawny tekst to czas lokalny (QDateTime::currentDateTime) - 'utc' przelicza go na UTC
+    return QString("CAST(strftime('%s', %1, 'utc') AS INTEGER)").arg(kolumna);
+}
+
+QString sqlDzienJakoTekst(const char* kolumna) {
+    return QString("date(%1 * 86400, 'unixepoch')").arg(kolumna);
+}
+
+QString sqlMinutaJakoTekst(const char* kolumna) {
+    return QString("strftime('%H:%M', %1 * 60, 'unixepoch')").arg(kolumna);
+}
+
+QString sqlChwilaJakoTekst(const char* kolumna) {
+    return QString("datetime(%1, 'unixepoch', 'localtime')").arg(kolumna);
+}
+
+} // namespace
+
+// === Schemat bazy danych ===
+
+namespace {
+
+struct Migracja {
+    int wersja;
+    const char* opis;
+    QStringList polecenia;
+};
+
+// Telefon w indeksie pełnotekstowym jako same cyfry - "600 100 200" i "600-100-200"
+// to ten sam numer, a zapytanie "600100"* znajduje go po prefiksie
+QString cyfryTelefonu(const char* kolumna) {
+    return QString("replace(replace(replace(replace(replace(replace(COALESCE(%1, ''), "
+                   "' ', ''), '-', ''), '+', ''), '(', ''), ')', ''), '.', '')").arg(kolumna);
+}
+
+// Cena karnetu w groszach - sumy przychodów w agregatach dodawane i odejmowane bez
+// narastającego błędu zaokrągleń REAL
+QString groszeCeny(const char* kolumna) {
+    return QString("CAST(ROUND(COALESCE(%1, 0) * 100) AS INTEGER)").arg(kolumna);
+}
+
+// Kolejne wersje schematu. Nowe zmiany dopisujemy wyłącznie na końcu listy,
+// numer wersji trafia do PRAGMA user_version razem z migracją (w jednej transakcji).
+const QList<Migracja>& migracje() {
+    static const QList<Migracja> lista = {
+        {1, "Tabele podstawowe", {
+            R"(
+                CREATE TABLE IF NOT EXISTS klient (
+                    id              INTEGER PRIMARY KEY AUTOINCREMENT,
+                    imie            TEXT    NOT NULL,
+                    nazwisko        TEXT    NOT NULL,
+                    email           TEXT,
+                    telefon         TEXT,
+                    dataUrodzenia   TEXT,
+                    dataRejestracji TEXT    NOT NULL,
+                    uwagi           TEXT
+                )
+            )",
+            R"(
+                CREATE TABLE IF NOT EXISTS zajecia (
+                    id                INTEGER PRIMARY KEY AUTOINCREMENT,
+                    nazwa             TEXT    NOT NULL,
+                    trener            TEXT,
+                    maksUczestnikow   INTEGER,
+                    data              TEXT,   -- w formacie 'YYYY-MM-DD'
+                    czas              TEXT,   -- np. 'HH:MM'
+                    czasTrwania       INTEGER, -- w minutach
+                    opis              TEXT
+                )
+            )",
+            R"(
+                CREATE TABLE IF NOT EXISTS karnet (
+                    id               INTEGER PRIMARY KEY AUTOINCREMENT,
+                    idKlienta        INTEGER    NOT NULL,
+                    typ              TEXT,
+                    dataRozpoczecia  TEXT,
+                    dataZakonczenia  TEXT,
+                    cena             REAL,
+                    czyAktywny       INTEGER,   -- 0 lub 1
+                    FOREIGN KEY(idKlienta) REFERENCES klient(id)
+                )
+            )",
+            R"(
+                CREATE TABLE IF NOT EXISTS rezerwacja (
+                    id               INTEGER PRIMARY KEY AUTOINCREMENT,
+                    idKlienta        INTEGER    NOT NULL,
+                    idZajec          INTEGER    NOT NULL,
+                    dataRezerwacji   TEXT,      -- format 'YYYY-MM-DD HH:MM:SS'
+                    status           TEXT,
+                    FOREIGN KEY(idKlienta) REFERENCES klient(id),
+                    FOREIGN KEY(idZajec)   REFERENCES zajecia(id)
+                )
+            )"
+        }},
+        {2, "Indeksy pod zapytania DatabaseManager", {
+            "CREATE INDEX IF NOT EXISTS idx_rezerwacja_zajecia_status ON rezerwacja(idZajec, status)",
+            "CREATE INDEX IF NOT EXISTS idx_rezerwacja_klient_status ON rezerwacja(idKlienta, status)",
+            "CREATE INDEX IF NOT EXISTS idx_karnet_klient_aktywny ON karnet(idKlienta, czyAktywny)",
+            "CREATE INDEX IF NOT EXISTS idx_karnet_data_zakonczenia ON karnet(dataZakonczenia)",
+            "CREATE INDEX IF NOT EXISTS idx_zajecia_data_czas ON zajecia(data, czas)",
+            "CREATE INDEX IF NOT EXISTS idx_klient_nazwisko_imie ON klient(nazwisko, imie)",
+            "CREATE INDEX IF NOT EXISTS idx_klient_email ON klient(email)"
+        }},
+        {3, "Licznik aktywnych rezerwacji w zajeciach", {
+            "ALTER TABLE zajecia ADD COLUMN aktualneRezerwacje INTEGER NOT NULL DEFAULT 0",
+            R"(
+                UPDATE zajecia SET aktualneRezerwacje = (
+                    SELECT COUNT(*) FROM rezerwacja r
+                    WHERE r.idZajec = zajecia.id AND r.status = 'aktywna'
+                )
+            )",
+            R"(
+                CREATE TRIGGER IF NOT EXISTS trg_rezerwacja_licznik_insert
+                AFTER INSERT ON rezerwacja WHEN NEW.status = 'aktywna'
+                BEGIN
+                    UPDATE zajecia SET aktualneRezerwacje = aktualneRezerwacje + 1 WHERE id = NEW.idZajec;
+                END
+            )",
+            R"(
+                CREATE TRIGGER IF NOT EXISTS trg_rezerwacja_licznik_delete
+                AFTER DELETE ON rezerwacja WHEN OLD.status = 'aktywna'
+                BEGIN
+                    UPDATE zajecia SET aktualneRezerwacje = aktualneRezerwacje - 1 WHERE id = OLD.idZajec;
+                END
+            )",
+            R"(
+                CREATE TRIGGER IF NOT EXISTS trg_rezerwacja_licznik_update
+                AFTER UPDATE OF status, idZajec ON rezerwacja
+                BEGIN
+                    UPDATE zajecia SET aktualneRezerwacje = aktualneRezerwacje - 1
+                    WHERE id = OLD.idZajec AND OLD.status = 'aktywna';
+                    UPDATE zajecia SET aktualneRezerwacje = aktualneRezerwacje + 1
+                    WHERE id = NEW.idZajec AND NEW.status = 'aktywna';
+                END
+            )"
+        }},
+        {4, "Indeksy pod stronicowanie po kluczu", {
+            // Wyrażenia muszą być identyczne z kluczami list w get*Strona - COALESCE
+            // zamienia NULL na '' (sortuje się tak samo), a porównanie krotek (a, b, id) > (...)
+            // staje się zakresem w indeksie
+            "CREATE INDEX IF NOT EXISTS idx_zajecia_stronicowanie ON zajecia(COALESCE(data, ''), COALESCE(czas, ''), nazwa)",
+            "CREATE INDEX IF NOT EXISTS idx_rezerwacja_stronicowanie ON rezerwacja(COALESCE(dataRezerwacji, ''))",
+            "CREATE INDEX IF NOT EXISTS idx_karnet_stronicowanie ON karnet(COALESCE(dataRozpoczecia, ''))"
+        }},
+        {5, "Indeksy pod filtry list rezerwacji i karnetów", {
+            // Równość na kolumnie filtra + klucz stronicowania: przefiltrowana strona to nadal
+            // jeden zakres w indeksie, bez sortowania (id jako rowid jest na końcu każdego indeksu)
+            "CREATE INDEX IF NOT EXISTS idx_rezerwacja_status_stronicowanie ON rezerwacja(status, COALESCE(dataRezerwacji, ''))",
+            "CREATE INDEX IF NOT EXISTS idx_karnet_typ_stronicowanie ON karnet(typ, COALESCE(dataRozpoczecia, ''))",
+            "CREATE INDEX IF NOT EXISTS idx_karnet_aktywny_stronicowanie ON karnet(czyAktywny, COALESCE(dataRozpoczecia, ''))",
+            "CREATE INDEX IF NOT EXISTS idx_zajecia_trener ON zajecia(trener)"
+        }},
+        {6, "Wyszukiwanie pełnotekstowe klientów (FTS5)", {
+            // Osobna kopia pól tekstowych (telefon jako cyfry) utrzymywana triggerami.
+            // remove_diacritics: "zolc" znajduje "Żółć"; prefix: indeksy pod zapytania "ko"*, "kow"*
+            R"(
+                CREATE VIRTUAL TABLE IF NOT EXISTS klient_fts USING fts5(
+                    imie, nazwisko, email, telefon, uwagi,
+                    tokenize = 'unicode61 remove_diacritics 2',
+                    prefix = '2 3'
+                )
+            )",
+            QString(R"(
+                INSERT INTO klient_fts(rowid, imie, nazwisko, email, telefon, uwagi)
+                SELECT id, imie, nazwisko, email, %1, uwagi FROM klient
+            )").arg(cyfryTelefonu("telefon")),
+            QString(R"(
+                CREATE TRIGGER IF NOT EXISTS trg_klient_fts_insert
+                AFTER INSERT ON klient
+                BEGIN
+                    INSERT INTO klient_fts(rowid, imie, nazwisko, email, telefon, uwagi)
+                    VALUES (NEW.id, NEW.imie, NEW.nazwisko, NEW.email, %1, NEW.uwagi);
+                END
+            )").arg(cyfryTelefonu("NEW.telefon")),
+            R"(
+                CREATE TRIGGER IF NOT EXISTS trg_klient_fts_delete
+                AFTER DELETE ON klient
+                BEGIN
+                    DELETE FROM klient_fts WHERE rowid = OLD.id;
+                END
+            )",
+            QString(R"(
+                CREATE TRIGGER IF NOT EXISTS trg_klient_fts_update
+                AFTER UPDATE OF imie, nazwisko, email, telefon, uwagi ON klient
+                BEGIN
+                    DELETE FROM klient_fts WHERE rowid = OLD.id;
+                    INSERT INTO klient_fts(rowid, imie, nazwisko, email, telefon, uwagi)
+                    VALUES (NEW.id, NEW.imie, NEW.nazwisko, NEW.email, %1, NEW.uwagi);
+                END
+            )").arg(cyfryTelefonu("NEW.telefon"))
+        }},
+        {7, "Daty i czasy jako liczby całkowite", {
+            // Kolumna TEXT zamieniłaby zapisaną liczbę z powrotem na tekst, więc tabele
+            // przebudowujemy: nowa tabela, przepisanie wierszy, podmiana. sqlite_sequence
+            // przenosimy, żeby AUTOINCREMENT nie wydał ponownie id usuniętych wierszy.
+            // Rezerwacje pierwsze - ich triggery odwołują się do zajęć i giną razem z tabelą.
+            R"(
+                CREATE TABLE rezerwacja_nowa (
+                    id               INTEGER PRIMARY KEY AUTOINCREMENT,
+                    idKlienta        INTEGER    NOT NULL,
+                    idZajec          INTEGER    NOT NULL,
+                    dataRezerwacji   INTEGER,   -- sekundy od 1970-01-01 00:00 UTC
+                    status           TEXT,
+                    FOREIGN KEY(idKlienta) REFERENCES klient(id),
+                    FOREIGN KEY(idZajec)   REFERENCES zajecia(id)
+                )
+            )",
+            QString(R"(
+                INSERT INTO rezerwacja_nowa (id, idKlienta, idZajec, dataRezerwacji, status)
+                SELECT id, idKlienta, idZajec, %1, status FROM rezerwacja
+            )").arg(sqlChwilaZTekstu("dataRezerwacji")),
+            "DELETE FROM sqlite_sequence WHERE name = 'rezerwacja_nowa'",
+            "UPDATE sqlite_sequence SET name = 'rezerwacja_nowa' WHERE name = 'rezerwacja'",
+            "DROP TABLE rezerwacja",
+            "ALTER TABLE rezerwacja_nowa RENAME TO rezerwacja",
+
+            R"(
+                CREATE TABLE zajecia_nowe (
+                    id                 INTEGER PRIMARY KEY AUTOINCREMENT,
+                    nazwa              TEXT    NOT NULL,
+                    trener             TEXT,
+                    maksUczestnikow    INTEGER,
+                    data               INTEGER, -- dni od 1970-01-01
+                    czas               INTEGER, -- minuty od północy
+                    czasTrwania        INTEGER, -- w minutach
+                    opis               TEXT,
+                    aktualneRezerwacje INTEGER NOT NULL DEFAULT 0
+                )
+            )",
+            QString(R"(
+                INSERT INTO zajecia_nowe (id, nazwa, trener, maksUczestnikow, data, czas, czasTrwania, opis, aktualneRezerwacje)
+                SELECT id, nazwa, trener, maksUczestnikow, %1, %2, czasTrwania, opis, aktualneRezerwacje FROM zajecia
+            )").arg(sqlDzienZTekstu("data"), sqlMinutaZTekstu("czas")),
+            "DELETE FROM sqlite_sequence WHERE name = 'zajecia_nowe'",
+            "UPDATE sqlite_sequence SET name = 'zajecia_nowe' WHERE name = 'zajecia'",
+            "DROP TABLE zajecia",
+            "ALTER TABLE zajecia_nowe RENAME TO zajecia",
+
+            R"(
+                CREATE TABLE karnet_nowy (
+                    id               INTEGER PRIMARY KEY AUTOINCREMENT,
+                    idKlienta        INTEGER    NOT NULL,
+                    typ              TEXT,
+                    dataRozpoczecia  INTEGER,   -- dni od 1970-01-01
+                    dataZakonczenia  INTEGER,
+                    cena             REAL,
+                    czyAktywny       INTEGER,   -- 0 lub 1
+                    FOREIGN KEY(idKlienta) REFERENCES klient(id)
+                )
+            )",
+            QString(R"(
+                INSERT INTO karnet_nowy (id, idKlienta, typ, dataRozpoczecia, dataZakonczenia, cena, czyAktywny)
+                SELECT id, idKlienta, typ, %1, %2, cena, czyAktywny FROM karnet
+            )").arg(sqlDzienZTekstu("dataRozpoczecia"), sqlDzienZTekstu("dataZakonczenia")),
+            "DELETE FROM sqlite_sequence WHERE name = 'karnet_nowy'",
+            "UPDATE sqlite_sequence SET name = 'karnet_nowy' WHERE name = 'karnet'",
+            "DROP TABLE karnet",
+            "ALTER TABLE karnet_nowy RENAME TO karnet",
+
+            // Indeksy z migracji 2, 4 i 5 - klucze stronicowania z NULL jako -1
+            // (brak daty przed każdą datą, jak nieprawidłowa QDate/QTime w C++)
+            "CREATE INDEX idx_rezerwacja_zajecia_status ON rezerwacja(idZajec, status)",
+            "CREATE INDEX idx_rezerwacja_klient_status ON rezerwacja(idKlienta, status)",
+            "CREATE INDEX idx_rezerwacja_stronicowanie ON rezerwacja(COALESCE(dataRezerwacji, -1))",
+            "CREATE INDEX idx_rezerwacja_status_stronicowanie ON rezerwacja(status, COALESCE(dataRezerwacji, -1))",
+            "CREATE INDEX idx_zajecia_data_czas ON zajecia(data, czas)",
+            "CREATE INDEX idx_zajecia_stronicowanie ON zajecia(COALESCE(data, -1), COALESCE(czas, -1), nazwa)",
+            "CREATE INDEX idx_zajecia_trener ON zajecia(trener)",
+            "CREATE INDEX idx_karnet_klient_aktywny ON karnet(idKlienta, czyAktywny)",
+            "CREATE INDEX idx_karnet_data_zakonczenia ON karnet(dataZakonczenia)",
+            "CREATE INDEX idx_karnet_stronicowanie ON karnet(COALESCE(dataRozpoczecia, -1))",
+            "CREATE INDEX idx_karnet_typ_stronicowanie ON karnet(typ, COALESCE(dataRozpoczecia, -1))",
+            "CREATE INDEX idx_karnet_aktywny_stronicowanie ON karnet(czyAktywny, COALESCE(dataRozpoczecia, -1))",
+
+            // Triggery licznika z migracji 3 (bez zmian)
+            R"(
+                CREATE TRIGGER trg_rezerwacja_licznik_insert
+                AFTER INSERT ON rezerwacja WHEN NEW.status = 'aktywna'
+                BEGIN
+                    UPDATE zajecia SET aktualneRezerwacje = aktualneRezerwacje + 1 WHERE id = NEW.idZajec;
+                END
+            )",
+            R"(
+                CREATE TRIGGER trg_rezerwacja_licznik_delete
+                AFTER DELETE ON rezerwacja WHEN OLD.status = 'aktywna'
+                BEGIN
+                    UPDATE zajecia SET aktualneRezerwacje = aktualneRezerwacje - 1 WHERE id = OLD.idZajec;
+                END
+            )",
+            R"(
+                CREATE TRIGGER trg_rezerwacja_licznik_update
+                AFTER UPDATE OF status, idZajec ON rezerwacja
+                BEGIN
+                    UPDATE zajecia SET aktualneRezerwacje = aktualneRezerwacje - 1
+                    WHERE id = OLD.idZajec AND OLD.status = 'aktywna';
+                    UPDATE zajecia SET aktualneRezerwacje = aktualneRezerwacje + 1
+                    WHERE id = NEW.idZajec AND NEW.status = 'aktywna';
+                END
+            )"
+        }},
+        {8, "Status rezerwacji jako liczba (StatusRezerwacji) z indeksami częściowymi", {
+            // CHECK da się dodać tylko przy tworzeniu tabeli - przebudowa jak w migracji 7.
+            // Inny tekst niż 'aktywna' nie liczył się do limitu miejsc, więc staje się anulowaną.
+            R"(
+                CREATE TABLE rezerwacja_nowa (
+                    id               INTEGER PRIMARY KEY AUTOINCREMENT,
+                    idKlienta        INTEGER    NOT NULL,
+                    idZajec          INTEGER    NOT NULL,
+                    dataRezerwacji   INTEGER,   -- sekundy od 1970-01-01 00:00 UTC
+                    status           INTEGER    NOT NULL DEFAULT 0 CHECK (status IN (0, 1)),   -- 0 aktywna, 1 anulowana
+                    FOREIGN KEY(idKlienta) REFERENCES klient(id),
+                    FOREIGN KEY(idZajec)   REFERENCES zajecia(id)
+                )
+            )",
+            R"(
+                INSERT INTO rezerwacja_nowa (id, idKlienta, idZajec, dataRezerwacji, status)
+                SELECT id, idKlienta, idZajec, dataRezerwacji, CASE WHEN status = 'aktywna' THEN 0 ELSE 1 END
+                FROM rezerwacja
+            )",
+            "DELETE FROM sqlite_sequence WHERE name = 'rezerwacja_nowa'",
+            "UPDATE sqlite_sequence SET name = 'rezerwacja_nowa' WHERE name = 'rezerwacja'",
+            "DROP TABLE rezerwacja",
+            "ALTER TABLE rezerwacja_nowa RENAME TO rezerwacja",
+
+            // Pełne indeksy po kliencie i zajęciach zostają dla list ze wszystkimi statusami
+            // (historia klienta, filtr listy) - aktywne obsługują indeksy częściowe poniżej.
+            "CREATE INDEX idx_rezerwacja_zajecia ON rezerwacja(idZajec)",
+            "CREATE INDEX idx_rezerwacja_klient ON rezerwacja(idKlienta)",
+            "CREATE INDEX idx_rezerwacja_stronicowanie ON rezerwacja(COALESCE(dataRezerwacji, -1))",
+            "CREATE INDEX idx_rezerwacja_status_stronicowanie ON rezerwacja(status, COALESCE(dataRezerwacji, -1))",
+            // Tylko aktywne rezerwacje - limit miejsc, duplikaty, obsada zajęć i raporty.
+            // Zapytanie trafia w indeks częściowy, gdy ma w warunku dosłownie status = 0.
+            "CREATE INDEX idx_rezerwacja_aktywne_zajecia ON rezerwacja(idZajec, idKlienta) WHERE status = 0",
+            "CREATE INDEX idx_rezerwacja_aktywne_klienta ON rezerwacja(idKlienta) WHERE status = 0",
+
+            R"(
+                CREATE TRIGGER trg_rezerwacja_licznik_insert
+                AFTER INSERT ON rezerwacja WHEN NEW.status = 0
+                BEGIN
+                    UPDATE zajecia SET aktualneRezerwacje = aktualneRezerwacje + 1 WHERE id = NEW.idZajec;
+                END
+            )",
+            R"(
+                CREATE TRIGGER trg_rezerwacja_licznik_delete
+                AFTER DELETE ON rezerwacja WHEN OLD.status = 0
+                BEGIN
+                    UPDATE zajecia SET aktualneRezerwacje = aktualneRezerwacje - 1 WHERE id = OLD.idZajec;
+                END
+            )",
+            R"(
+                CREATE TRIGGER trg_rezerwacja_licznik_update
+                AFTER UPDATE OF status, idZajec ON rezerwacja
+                BEGIN
+                    UPDATE zajecia SET aktualneRezerwacje = aktualneRezerwacje - 1
+                    WHERE id = OLD.idZajec AND OLD.status = 0;
+                    UPDATE zajecia SET aktualneRezerwacje = aktualneRezerwacje + 1
+                    WHERE id = NEW.idZajec AND NEW.status = 0;
+                END
+            )"
+        }},
+        {9, "Agregaty pod raporty statystyk", {
+            // Raporty czytają gotowe liczniki zamiast GROUP BY po całych tabelach: zajęcia mają
+            // już aktualneRezerwacje, klient dostaje taki sam licznik, a karnety - tabelę sum
+            // aktywnych karnetów na typ. Indeksy dają ranking top-N bez sortowania.
+            "ALTER TABLE klient ADD COLUMN aktywneRezerwacje INTEGER NOT NULL DEFAULT 0",
+            R"(
+                UPDATE klient SET aktywneRezerwacje = (
+                    SELECT COUNT(*) FROM rezerwacja r
+                    WHERE r.idKlienta = klient.id AND r.status = 0
+                )
+            )",
+            "CREATE INDEX idx_klient_ranking ON klient(aktywneRezerwacje DESC, nazwisko, imie)",
+            "CREATE INDEX idx_zajecia_ranking ON zajecia(aktualneRezerwacje DESC, nazwa)",
+
+            "DROP TRIGGER trg_rezerwacja_licznik_insert",
+            "DROP TRIGGER trg_rezerwacja_licznik_delete",
+            "DROP TRIGGER trg_rezerwacja_licznik_update",
+            R"(
+                CREATE TRIGGER trg_rezerwacja_licznik_insert
+                AFTER INSERT ON rezerwacja WHEN NEW.status = 0
+                BEGIN
+                    UPDATE zajecia SET aktualneRezerwacje = aktualneRezerwacje + 1 WHERE id = NEW.idZajec;
+                    UPDATE klient SET aktywneRezerwacje = aktywneRezerwacje + 1 WHERE id = NEW.idKlienta;
+                END
+            )",
+            R"(
+                CREATE TRIGGER trg_rezerwacja_licznik_delete
+                AFTER DELETE ON rezerwacja WHEN OLD.status = 0
+                BEGIN
+                    UPDATE zajecia SET aktualneRezerwacje = aktualneRezerwacje - 1 WHERE id = OLD.idZajec;
+                    UPDATE klient SET aktywneRezerwacje = aktywneRezerwacje - 1 WHERE id = OLD.idKlienta;
+                END
+            )",
+            R"(
+                CREATE TRIGGER trg_rezerwacja_licznik_update
+                AFTER UPDATE OF status, idZajec, idKlienta ON rezerwacja
+                BEGIN
+                    UPDATE zajecia SET aktualneRezerwacje = aktualneRezerwacje - 1
+                    WHERE id = OLD.idZajec AND OLD.status = 0;
+                    UPDATE zajecia SET aktualneRezerwacje = aktualneRezerwacje + 1
+                    WHERE id = NEW.idZajec AND NEW.status = 0;
+                    UPDATE klient SET aktywneRezerwacje = aktywneRezerwacje - 1
+                    WHERE id = OLD.idKlienta AND OLD.status = 0;
+                    UPDATE klient SET aktywneRezerwacje = aktywneRezerwacje + 1
+                    WHERE id = NEW.idKlienta AND NEW.status = 0;
+                END
+            )",
+
+            // Typ NULL liczony jako '' - tak jak wcześniej GROUP BY typ dawał pusty tekst
+            R"(
+                CREATE TABLE statystyka_karnetow (
+                    typ              TEXT       PRIMARY KEY NOT NULL,
+                    aktywne          INTEGER    NOT NULL DEFAULT 0,
+                    przychodGrosze   INTEGER    NOT NULL DEFAULT 0     -- suma cen aktywnych karnetów
+                )
+            )",
+            QString(R"(
+                INSERT INTO statystyka_karnetow (typ, aktywne, przychodGrosze)
+                SELECT COALESCE(typ, ''), COUNT(*), SUM(%1)
+                FROM karnet WHERE czyAktywny = 1
+                GROUP BY COALESCE(typ, '')
+            )").arg(groszeCeny("cena")),
+            QString(R"(
+                CREATE TRIGGER trg_karnet_statystyka_insert
+                AFTER INSERT ON karnet WHEN NEW.czyAktywny = 1
+                BEGIN
+                    INSERT INTO statystyka_karnetow (typ, aktywne, przychodGrosze)
+                    VALUES (COALESCE(NEW.typ, ''), 1, %1)
+                    ON CONFLICT(typ) DO UPDATE SET aktywne = aktywne + 1,
+                                                   przychodGrosze = przychodGrosze + excluded.przychodGrosze;
+                END
+            )").arg(groszeCeny("NEW.cena")),
+            QString(R"(
+                CREATE TRIGGER trg_karnet_statystyka_delete
+                AFTER DELETE ON karnet WHEN OLD.czyAktywny = 1
+                BEGIN
+                    UPDATE statystyka_karnetow SET aktywne = aktywne - 1, przychodGrosze = przychodGrosze - %1
+                    WHERE typ = COALESCE(OLD.typ, '');
+                END
+            )").arg(groszeCeny("OLD.cena")),
+            QString(R"(
+                CREATE TRIGGER trg_karnet_statystyka_update
+                AFTER UPDATE OF typ, cena, czyAktywny ON karnet
+                BEGIN
+                    UPDATE statystyka_karnetow SET aktywne = aktywne - 1, przychodGrosze = przychodGrosze - %1
+                    WHERE typ = COALESCE(OLD.typ, '') AND OLD.czyAktywny = 1;
+                    INSERT INTO statystyka_karnetow (typ, aktywne, przychodGrosze)
+                    SELECT COALESCE(NEW.typ, ''), 1, %2 WHERE NEW.czyAktywny = 1
+                    ON CONFLICT(typ) DO UPDATE SET aktywne = aktywne + 1,
+                                                   przychodGrosze = przychodGrosze + excluded.przychodGrosze;
+                END
+            )").arg(groszeCeny("OLD.cena"), groszeCeny("NEW.cena"))
+        }},
+        {10, "Dzienne przychody z karnetów wg typu", {
+            // Karnet liczy się w dniu rozpoczęcia, niezależnie od tego, czy jest jeszcze aktywny -
+            // sprzedaż już się odbyła. Raport za dowolny przedział to zakres w kluczu (dzien, typ).
+            R"(
+                CREATE TABLE przychod_dzienny (
+                    dzien            INTEGER    NOT NULL,   -- dataRozpoczecia, dni od 1970-01-01
+                    typ              TEXT       NOT NULL,
+                    liczba           INTEGER    NOT NULL DEFAULT 0,
+                    przychodGrosze   INTEGER    NOT NULL DEFAULT 0,
+                    PRIMARY KEY (dzien, typ)
+                ) WITHOUT ROWID
+            )",
+            QString(R"(
+                INSERT INTO przychod_dzienny (dzien, typ, liczba, przychodGrosze)
+                SELECT dataRozpoczecia, COALESCE(typ, ''), COUNT(*), SUM(%1)
+                FROM karnet WHERE dataRozpoczecia IS NOT NULL
+                GROUP BY dataRozpoczecia, COALESCE(typ, '')
+            )").arg(groszeCeny("cena")),
+            QString(R"(
+                CREATE TRIGGER trg_karnet_przychod_insert
+                AFTER INSERT ON karnet WHEN NEW.dataRozpoczecia IS NOT NULL
+                BEGIN
+                    INSERT INTO przychod_dzienny (dzien, typ, liczba, przychodGrosze)
+                    VALUES (NEW.dataRozpoczecia, COALESCE(NEW.typ, ''), 1, %1)
+                    ON CONFLICT(dzien, typ) DO UPDATE SET liczba = liczba + 1,
+                                                          przychodGrosze = przychodGrosze + excluded.przychodGrosze;
+                END
+            )").arg(groszeCeny("NEW.cena")),
+            QString(R"(
+                CREATE TRIGGER trg_karnet_przychod_delete
+                AFTER DELETE ON karnet WHEN OLD.dataRozpoczecia IS NOT NULL
+                BEGIN
+                    UPDATE przychod_dzienny SET liczba = liczba - 1, przychodGrosze = przychodGrosze - %1
+                    WHERE dzien = OLD.dataRozpoczecia AND typ = COALESCE(OLD.typ, '');
+                END
+            )").arg(groszeCeny("OLD.cena")),
+            QString(R"(
+                CREATE TRIGGER trg_karnet_przychod_update
+                AFTER UPDATE OF typ, cena, dataRozpoczecia ON karnet
+                BEGIN
+                    UPDATE przychod_dzienny SET liczba = liczba - 1, przychodGrosze = przychodGrosze - %1
+                    WHERE dzien = OLD.dataRozpoczecia AND typ = COALESCE(OLD.typ, '');
+                    INSERT INTO przychod_dzienny (dzien, typ, liczba, przychodGrosze)
+                    SELECT NEW.dataRozpoczecia, COALESCE(NEW.typ, ''), 1, %2 WHERE NEW.dataRozpoczecia IS NOT NULL
+                    ON CONFLICT(dzien, typ) DO UPDATE SET liczba = liczba + 1,
+                                                          przychodGrosze = przychodGrosze + excluded.przychodGrosze;
+                END
+            )").arg(groszeCeny("OLD.cena"), groszeCeny("NEW.cena"))
+        }},
+        {11, "Indeksy pod mapę obłożenia zajęć", {
+            // Mapa dla jednego trenera albo jednych zajęć to zakres dat w obrębie tej wartości.
+            // Indeks po samym trenerze jest prefiksem nowego, więc znika.
+            "DROP INDEX idx_zajecia_trener",
+            "CREATE INDEX idx_zajecia_trener_data ON zajecia(trener, data, czas)",
+            "CREATE INDEX idx_zajecia_nazwa_data ON zajecia(nazwa, data, czas)"
+        }}
+    };
+    return lista;
+}
+
+} // namespace
+
+int DatabaseManager::schemaVersion() {
+    QSqlQuery query(database());
+    if (!query.exec("PRAGMA user_version") || !query.next()) {
+        qWarning() << "Błąd odczytu wersji schematu:" << query.lastError().text();
+        return -1;
     }
-    QSqlDatabase::removeDatabase("gym_connection");
+    return query.value(0).toInt();
 }
 
-QSqlDatabase& DatabaseManager::instance() {
-    return db;
+bool DatabaseManager::migrateSchema() {
+    int wersja = schemaVersion();
+    if (wersja < 0) {
+        return false;
+    }
+
+    QSqlDatabase db = database();
+    const QList<Migracja>& lista = migracje();
+    int docelowa = lista.last().wersja;
+
+    // Schemat aktualny - żadnego DDL przy starcie
+    if (wersja >= docelowa) {
+        if (wersja > docelowa) {
+            qWarning() << "Baza ma nowszy schemat (" << wersja << ") niż obsługiwany (" << docelowa << ")";
+        }
+        return true;
+    }
+
+    for (const Migracja& migracja : lista) {
+        if (migracja.wersja <= wersja) continue;
+
+        if (!db.transaction()) {
+            qWarning() << "Nie można rozpocząć transakcji migracji:" << db.lastError().text();
+            return false;
+        }
+
+        QSqlQuery query(db);
+        for (const QString& polecenie : migracja.polecenia) {
+            if (!query.exec(polecenie)) {
+                qWarning() << "Błąd migracji" << migracja.wersja << "(" << migracja.opis << "):" << query.lastError().text();
+                db.rollback();
+                return false;
+            }
+        }
+
+        if (!query.exec(QString("PRAGMA user_version = %1").arg(migracja.wersja)) || !db.commit()) {
+            qWarning() << "Błąd zapisu wersji schematu" << migracja.wersja << ":" << db.lastError().text();
+            db.rollback();
+            return false;
+        }
+
+        qDebug() << "Zastosowano migrację schematu" << migracja.wersja << ":" << migracja.opis;
+    }
+
+    return true;
+}
+
+// === Stronicowanie po kluczu (keyset) ===
+
+// Opis listy stronicowanej: zapytanie z miejscem na warunek klucza i kolumny sortowania.
+// Wszystkie klucze sortowane są w jednym kierunku, ostatni (id) jest unikalny.
+struct DatabaseManager::ListaStronicowana {
+    struct Klucz {
+        const char* wyrazenie;      // jak w indeksie; daty/czasy (mogą być NULL) przez COALESCE(..., -1)
+        const char* pole;           // nazwa kolumny w wyniku zapytania
+    };
+
+    const char* nazwa;              // zapisywana w tokenie - token jednej listy nie pasuje do innej
+    const char* zapytanie;          // SELECT ... WHERE %1 - za %1 trafia warunek klucza
+    QList<Klucz> klucze;
+    bool malejaco;
+};
+
+namespace {
+
+// Skrót warunku filtra i wartości parametrów listy. Trafia do tokenu, więc token wydany
+// dla jednego filtra (albo frazy wyszukiwania) nie jest przyjmowany przy innym.
+QString podpisFiltra(const QVariantMap& parametry, const QString& warunekFiltra) {
+    QCryptographicHash skrot(QCryptographicHash::Sha1);
+    skrot.addData(warunekFiltra.toUtf8());
+    for (auto it = parametry.cbegin(); it != parametry.cend(); ++it) {
+        skrot.addData("\x1f");
+        skrot.addData(it.key().toUtf8());
+        skrot.addData("=");
+        skrot.addData(it.value().toString().toUtf8());
+    }
+    return QString::fromLatin1(skrot.result().left(8).toHex());
+}
+
+QString zakodujToken(const char* lista, const QString& filtr, const QVariantList& klucz) {
+    QJsonObject obiekt;
+    obiekt.insert("l", QString::fromLatin1(lista));
+    obiekt.insert("f", filtr);
+    obiekt.insert("k", QJsonArray::fromVariantList(klucz));
+    return QString::fromLatin1(QJsonDocument(obiekt).toJson(QJsonDocument::Compact)
+                                   .toBase64(QByteArray::Base64UrlEncoding));
+}
+
+bool odkodujToken(const QString& token, const char* lista, const QString& filtr, int liczbaKluczy, QVariantList& klucz) {
+    const QJsonObject obiekt = QJsonDocument::fromJson(
+        QByteArray::fromBase64(token.toLatin1(), QByteArray::Base64UrlEncoding)).object();
+    const QJsonArray wartosci = obiekt.value("k").toArray();
+    if (obiekt.value("l").toString() != QLatin1String(lista) || obiekt.value("f").toString() != filtr
+        || wartosci.size() != liczbaKluczy) {
+        return false;
+    }
+
+    klucz.clear();
+    for (const QJsonValue& wartosc : wartosci) {
+        if (wartosc.isString()) {
+            klucz << wartosc.toString();
+        } else if (wartosc.isDouble()) {
+            // JSON nie odróżnia liczb całkowitych - id wraca jako double
+            klucz << static_cast<qint64>(wartosc.toDouble());
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Wiersze wyniku (najwyżej limit) po konwersji - jedyne miejsce, w którym listy i strony
+// zamieniają wynik zapytania na struktury. Napisy z joinów idą przez jeden słownik.
+template<typename T>
+void odczytajWiersze(QSqlQuery& query, T (*konwersja)(QSqlQuery&), QList<T>& wynik,
+                     qsizetype limit = std::numeric_limits<qsizetype>::max()) {
+    SlownikNapisow slownik;
+    while (wynik.size() < limit && query.next()) {
+        wynik.append(konwersja(query));
+        slownik.wspoldziel(wynik.last());
+    }
+}
+
+} // namespace
+
+template<typename T>
+Strona<T> DatabaseManager::pobierzStrone(const ListaStronicowana& lista,
+                                        const QString& token,
+                                        int limit,
+                                        const QVariantMap& parametry,
+                                        T (*konwersja)(QSqlQuery&),
+                                        const QString& warunekFiltra) {
+    Strona<T> strona;
+    limit = qMax(1, limit);
+
+    const QString filtr = podpisFiltra(parametry, warunekFiltra);
+    QVariantList klucz;
+    if (!token.isEmpty() && !odkodujToken(token, lista.nazwa, filtr, static_cast<int>(lista.klucze.size()), klucz)) {
+        qWarning() << "Nieprawidłowy token stronicowania listy" << lista.nazwa << "(inna lista albo inny filtr)";
+        return strona;
+    }
+
+    QStringList wyrazenia;
+    for (const ListaStronicowana::Klucz& k : lista.klucze) {
+        wyrazenia << QString::fromLatin1(k.wyrazenie);
+    }
+    const QString kierunek = lista.malejaco ? " DESC" : "";
+
+    // Strona zaczyna się tuż za kluczem ostatniego wiersza poprzedniej strony -
+    // SQLite przechodzi do niego zakresem w indeksie zamiast odrzucać wiersze jak przy OFFSET
+    QStringList warunki;
+    if (!warunekFiltra.isEmpty()) {
+        warunki << warunekFiltra;
+    }
+    if (!klucz.isEmpty()) {
+        QStringList znaczniki;
+        for (int i = 0; i < klucz.size(); ++i) {
+            znaczniki << QString(":klucz%1").arg(i);
+        }
+        warunki << QString("(%1) %2 (%3)").arg(wyrazenia.join(", "), lista.malejaco ? "<" : ">", znaczniki.join(", "));
+    }
+    const QString warunek = warunki.isEmpty() ? QString("1") : warunki.join(" AND ");
+
+    QSqlQuery query = preparedQuery(QString::fromLatin1(lista.zapytanie).arg(warunek)
+                                    + " ORDER BY " + wyrazenia.join(kierunek + ", ") + kierunek
+                                    + " LIMIT :limit");
+    for (auto it = parametry.cbegin(); it != parametry.cend(); ++it) {
+        query.bindValue(it.key(), it.value());
+    }
+    for (int i = 0; i < klucz.size(); ++i) {
+        query.bindValue(QString(":klucz%1").arg(i), klucz.at(i));
+    }
+    // Jeden wiersz ponad limit mówi, czy istnieje następna strona
+    query.bindValue(":limit", limit + 1);
+
+    if (!execWithRetry(query)) {
+        qWarning() << "Błąd pobierania strony listy" << lista.nazwa << ":" << query.lastError().text();
+        return strona;
+    }
+
+    strona.elementy.reserve(limit);
+    odczytajWiersze(query, konwersja, strona.elementy, limit);
+
+    if (strona.elementy.size() == limit) {
+        QVariantList ostatni;
+        for (const ListaStronicowana::Klucz& k : lista.klucze) {
+            ostatni << (query.isNull(k.pole) ? QVariant(-1) : query.value(k.pole));
+        }
+        if (query.next()) {
+            strona.nastepnyToken = zakodujToken(lista.nazwa, filtr, ostatni);
+        }
+    }
+    query.finish();
+
+    return strona;
+}
+
+template<typename T>
+QList<T> DatabaseManager::pobierzListe(const QString& sql,
+                                       const QVariantMap& parametry,
+                                       std::initializer_list<TabelaDanych> tabele,
+                                       T (*konwersja)(QSqlQuery&),
+                                       const char* opisBledu) {
+    QString klucz = sql;
+    for (auto it = parametry.cbegin(); it != parametry.cend(); ++it) {
+        klucz += QString("\n%1=%2").arg(it.key(), it.value().toString());
+    }
+
+    QList<T> wynik;
+    CacheWynikow<T>& cache = cacheWynikow<T>();
+    if (cache.pobierz(klucz, wynik)) {
+        return wynik;
+    }
+
+    // Wersje sprzed zapytania - zapis, który wejdzie w trakcie, unieważni ten wynik
+    const WersjeTabel wersje = odczytajWersje(tabele);
+
+    QSqlQuery query = preparedQuery(sql);
+    for (auto it = parametry.cbegin(); it != parametry.cend(); ++it) {
+        query.bindValue(it.key(), it.value());
+    }
+    if (!execWithRetry(query)) {
+        qWarning() << opisBledu << query.lastError().text();
+        return wynik;
+    }
+
+    odczytajWiersze(query, konwersja, wynik);
+    query.finish();
+
+    cache.zapisz(klucz, wynik, wersje);
+    return wynik;
+}
+
+// === Filtry list rezerwacji i karnetów ===
+
+namespace {
+
+// Zakres dat jako porównania na wyrażeniu z indeksu stronicowania. Górna granica jest
+// wyłączna (następny dzień), granice już w postaci z bazy (dni albo sekundy).
+void dodajZakresDat(const QVariant& od, const QVariant& po, const QString& wyrazenie,
+                    QStringList& warunki, QVariantMap& parametry) {
+    if (!od.isNull()) {
+        warunki << wyrazenie + " >= :filtrDataOd";
+        parametry.insert(":filtrDataOd", od);
+    }
+    if (!po.isNull()) {
+        warunki << wyrazenie + " < :filtrDataPo";
+        parametry.insert(":filtrDataPo", po);
+    }
+}
+
+QVariant poczatekDnia(const QDate& data) {
+    return data.isValid() ? chwilaDoBazy(data.startOfDay()) : QVariant();
+}
+
+// Kolumny jak w zapytaniach list: rezerwacja r, zajecia z
+QString warunekFiltraRezerwacji(const FiltrListy& filtr, QVariantMap& parametry) {
+    QStringList warunki;
+    if (filtr.status.has_value()) {
+        warunki << "r.status = :filtrStatus";
+        parametry.insert(":filtrStatus", static_cast<int>(*filtr.status));
+    }
+    if (filtr.idKlienta > 0) {
+        warunki << "r.idKlienta = :filtrKlient";
+        parametry.insert(":filtrKlient", filtr.idKlienta);
+    }
+    if (filtr.idZajec > 0) {
+        warunki << "r.idZajec = :filtrZajecia";
+        parametry.insert(":filtrZajecia", filtr.idZajec);
+    }
+    if (!filtr.trener.isEmpty()) {
+        warunki << "z.trener = :filtrTrener";
+        parametry.insert(":filtrTrener", filtr.trener);
+    }
+    // Data rezerwacji to chwila - dzień filtra liczymy od północy czasu lokalnego
+    dodajZakresDat(poczatekDnia(filtr.dataOd), poczatekDnia(filtr.dataDo.addDays(1)),
+                   "COALESCE(r.dataRezerwacji, -1)", warunki, parametry);
+    return warunki.join(" AND ");
+}
+
+// Kolumny jak w zapytaniach list: karnet k
+QString warunekFiltraKarnetow(const FiltrListy& filtr, QVariantMap& parametry) {
+    QStringList warunki;
+    if (!filtr.typ.isEmpty()) {
+        warunki << "k.typ = :filtrTyp";
+        parametry.insert(":filtrTyp", filtr.typ);
+    }
+    if (filtr.czyAktywny.has_value()) {
+        warunki << "k.czyAktywny = :filtrAktywny";
+        parametry.insert(":filtrAktywny", *filtr.czyAktywny ? 1 : 0);
+    }
+    if (filtr.idKlienta > 0) {
+        warunki << "k.idKlienta = :filtrKlient";
+        parametry.insert(":filtrKlient", filtr.idKlienta);
+    }
+    dodajZakresDat(dzienDoBazy(filtr.dataOd), dzienDoBazy(filtr.dataDo.addDays(1)),
+                   "COALESCE(k.dataRozpoczecia, -1)", warunki, parametry);
+    return warunki.join(" AND ");
+}
+
+bool wZakresieDat(const FiltrListy& filtr, const QDate& dzien) {
+    return (!filtr.dataOd.isValid() || dzien >= filtr.dataOd)
+        && (!filtr.dataDo.isValid() || dzien <= filtr.dataDo);
+}
+
+} // namespace
+
+bool FiltrListy::czyPusty() const {
+    return !status.has_value() && typ.isEmpty() && !czyAktywny.has_value()
+        && !dataOd.isValid() && !dataDo.isValid()
+        && idKlienta <= 0 && idZajec <= 0 && trener.isEmpty();
+}
+
+bool FiltrListy::pasuje(const Rezerwacja& rezerwacja) const {
+    return (!status.has_value() || rezerwacja.status == *status)
+        && (idKlienta <= 0 || rezerwacja.idKlienta == idKlienta)
+        && (idZajec <= 0 || rezerwacja.idZajec == idZajec)
+        && (trener.isEmpty() || rezerwacja.trenerZajec == trener)
+        && wZakresieDat(*this, rezerwacja.dataRezerwacji.date());
+}
+
+bool FiltrListy::pasuje(const Karnet& karnet) const {
+    return (typ.isEmpty() || karnet.typ == typ)
+        && (!czyAktywny.has_value() || karnet.czyAktywny == *czyAktywny)
+        && (idKlienta <= 0 || karnet.idKlienta == idKlienta)
+        && wZakresieDat(*this, karnet.dataRozpoczecia);
 }
 
 // === CRUD dla KLIENTÓW ===
@@ -53,8 +1505,25 @@ bool DatabaseManager::addKlient(const QString& imie,
         return false;
     }
 
-    QSqlQuery query(db);
-    query.prepare(R"(
+    int noweId = -1;
+    if (!wstawKlienta(imie, nazwisko, email, telefon, dataUrodzenia, uwagi, &noweId)) {
+        return false;
+    }
+
+    qDebug() << "Dodano klienta:" << imie << nazwisko;
+    podbijWersje(TabelaDanych::Klienci);
+    DatabaseNotifier::instance()->zglosZmiane(TabelaDanych::Klienci, noweId, OperacjaZmiany::Dodanie);
+    return true;
+}
+
+bool DatabaseManager::wstawKlienta(const QString& imie,
+                                   const QString& nazwisko,
+                                   const QString& email,
+                                   const QString& telefon,
+                                   const QString& dataUrodzenia,
+                                   const QString& uwagi,
+                                   int* noweId) {
+    QSqlQuery query = preparedQuery(R"(
         INSERT INTO klient (imie, nazwisko, email, telefon, dataUrodzenia, dataRejestracji, uwagi)
         VALUES (:imie, :nazwisko, :email, :telefon, :dataUrodzenia, :dataRejestracji, :uwagi)
     )");
@@ -67,45 +1536,51 @@ bool DatabaseManager::addKlient(const QString& imie,
     query.bindValue(":dataRejestracji", QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss"));
     query.bindValue(":uwagi", uwagi.isEmpty() ? QVariant() : uwagi);
 
-    if (!query.exec()) {
+    if (!execWithRetry(query)) {
         qWarning() << "Błąd dodawania klienta:" << query.lastError().text();
         return false;
     }
-
-    qDebug() << "Dodano klienta:" << imie << nazwisko;
+    if (noweId) {
+        *noweId = query.lastInsertId().toInt();
+    }
     return true;
 }
 
 QList<Klient> DatabaseManager::getAllKlienci() {
-    QList<Klient> klienci;
-
-    QSqlQuery query(db);
-    if (!query.exec("SELECT id, imie, nazwisko, email, telefon, dataUrodzenia, dataRejestracji, uwagi FROM klient ORDER BY nazwisko, imie")) {
-        qWarning() << "Błąd pobierania klientów:" << query.lastError().text();
-        return klienci;
-    }
-
-    while (query.next()) {
-        klienci.append(queryToKlient(query));
-    }
+    return pobierzListe("SELECT id, imie, nazwisko, email, telefon, dataUrodzenia, dataRejestracji, uwagi FROM klient ORDER BY nazwisko, imie",
+                        {}, {TabelaDanych::Klienci}, &DatabaseManager::queryToKlient,
+                        "Błąd pobierania klientów:");
+}
 
-    return klienci;
+Strona<Klient> DatabaseManager::getKlienciStrona(const QString& token, int limit) {
+    static const ListaStronicowana lista = {
+        "klienci",
+        "SELECT id, imie, nazwisko, email, telefon, dataUrodzenia, dataRejestracji, uwagi FROM klient WHERE %1",
+        {{"nazwisko", "nazwisko"}, {"imie", "imie"}, {"id", "id"}},
+        false
+    };
+    return pobierzStrone(lista, token, limit, {}, &DatabaseManager::queryToKlient);
 }
 
 Klient DatabaseManager::getKlientById(int id) {
     Klient klient = {};
+    quint64 generacja = 0;
+    if (cacheKlientow.pobierz(id, klient, generacja)) {
+        return klient;
+    }
 
-    QSqlQuery query(db);
-    query.prepare("SELECT id, imie, nazwisko, email, telefon, dataUrodzenia, dataRejestracji, uwagi FROM klient WHERE id = :id");
+    QSqlQuery query = preparedQuery("SELECT id, imie, nazwisko, email, telefon, dataUrodzenia, dataRejestracji, uwagi FROM klient WHERE id = :id");
     query.bindValue(":id", id);
 
-    if (!query.exec()) {
+    if (!execWithRetry(query)) {
         qWarning() << "Błąd pobierania klienta o ID" << id << ":" << query.lastError().text();
         return klient;
     }
 
     if (query.next()) {
         klient = queryToKlient(query);
+        query.finish();
+        cacheKlientow.zapisz(id, klient, generacja);
     }
 
     return klient;
@@ -124,8 +1599,7 @@ bool DatabaseManager::updateKlient(int id,
         return false;
     }
 
-    QSqlQuery query(db);
-    query.prepare(R"(
+    QSqlQuery query = preparedQuery(R"(
         UPDATE klient
         SET imie = :imie, nazwisko = :nazwisko, email = :email,
             telefon = :telefon, dataUrodzenia = :dataUrodzenia, uwagi = :uwagi
@@ -140,7 +1614,7 @@ bool DatabaseManager::updateKlient(int id,
     query.bindValue(":dataUrodzenia", dataUrodzenia.isEmpty() ? QVariant() : dataUrodzenia);
     query.bindValue(":uwagi", uwagi.isEmpty() ? QVariant() : uwagi);
 
-    if (!query.exec()) {
+    if (!execWithRetry(query)) {
         qWarning() << "Błąd aktualizacji klienta:" << query.lastError().text();
         return false;
     }
@@ -151,56 +1625,124 @@ bool DatabaseManager::updateKlient(int id,
     }
 
     qDebug() << "Zaktualizowano klienta o ID:" << id;
+    cacheKlientow.usun(id);
+    cacheKarnetow.wyczysc();    // karnety trzymają imię i nazwisko klienta
+    podbijWersje(TabelaDanych::Klienci);
+    DatabaseNotifier::instance()->zglosZmiane(TabelaDanych::Klienci, id, OperacjaZmiany::Zmiana);
     return true;
 }
 
 bool DatabaseManager::deleteKlient(int id) {
-    QSqlQuery query(db);
-    query.prepare("DELETE FROM klient WHERE id = :id");
-    query.bindValue(":id", id);
+    // Baza nie ma kluczy obcych - rezerwacje klienta usuwamy razem z nim w jednej transakcji,
+    // triggery poprawiają liczniki zajęć. Karnetów nie ruszamy: sprzedaż już się odbyła
+    // (migracja 10), więc klienta z karnetami nie da się usunąć
+    if (!beginWriteTransaction()) {
+        return false;
+    }
 
-    if (!query.exec()) {
-        qWarning() << "Błąd usuwania klienta:" << query.lastError().text();
+    QSqlQuery karnety = preparedQuery("SELECT COUNT(*) FROM karnet WHERE idKlienta = :id");
+    karnety.bindValue(":id", id);
+    if (!execWithRetry(karnety) || !karnety.next()) {
+        qWarning() << "Błąd usuwania klienta:" << karnety.lastError().text();
+        rollbackTransaction();
+        return false;
+    }
+    const int liczbaKarnetow = karnety.value(0).toInt();
+    karnety.finish();
+    if (liczbaKarnetow > 0) {
+        qWarning() << "Klient o ID:" << id << "ma karnety (" << liczbaKarnetow << ") - nie można go usunąć";
+        rollbackTransaction();
         return false;
     }
 
-    if (query.numRowsAffected() == 0) {
-        qWarning() << "Nie znaleziono klienta o ID:" << id;
+    auto usun = [id](const char* sql) {
+        QSqlQuery query = preparedQuery(sql);
+        query.bindValue(":id", id);
+        if (!execWithRetry(query)) {
+            qWarning() << "Błąd usuwania klienta:" << query.lastError().text();
+            return -1;
+        }
+        return query.numRowsAffected();
+    };
+
+    // Zajęcia, którym zwolnią się miejsca - ich wiersze trzeba potem odświeżyć
+    QList<int> zwolnioneZajecia;
+    QSqlQuery zajecia = preparedQuery("SELECT DISTINCT idZajec FROM rezerwacja WHERE idKlienta = :id AND status = 0");
+    zajecia.bindValue(":id", id);
+    if (!execWithRetry(zajecia)) {
+        qWarning() << "Błąd usuwania klienta:" << zajecia.lastError().text();
+        rollbackTransaction();
         return false;
     }
+    while (zajecia.next()) {
+        zwolnioneZajecia << zajecia.value(0).toInt();
+    }
+    zajecia.finish();
+
+    const int rezerwacje = usun("DELETE FROM rezerwacja WHERE idKlienta = :id");
+    const int klienci = rezerwacje < 0 ? -1 : usun("DELETE FROM klient WHERE id = :id");
 
-    qDebug() << "Usunięto klienta o ID:" << id;
+    if (klienci <= 0) {
+        if (klienci == 0) {
+            qWarning() << "Nie znaleziono klienta o ID:" << id;
+        }
+        rollbackTransaction();
+        return false;
+    }
+    if (!commitTransaction()) {
+        rollbackTransaction();
+        return false;
+    }
+
+    qDebug() << "Usunięto klienta o ID:" << id << "- rezerwacji:" << rezerwacje;
+    cacheKlientow.usun(id);
+    for (int idZajec : std::as_const(zwolnioneZajecia)) {
+        cacheZajec.usun(idZajec);
+    }
+    podbijWersje(TabelaDanych::Klienci);
+    if (rezerwacje > 0) {
+        podbijWersje(TabelaDanych::Rezerwacje);
+    }
+
+    DatabaseNotifier* powiadomienia = DatabaseNotifier::instance();
+    powiadomienia->zglosZmiane(TabelaDanych::Klienci, id, OperacjaZmiany::Usuniecie);
+    for (int idZajec : std::as_const(zwolnioneZajecia)) {
+        powiadomienia->zglosZmiane(TabelaDanych::Zajecia, idZajec, OperacjaZmiany::Zmiana);
+    }
+    if (rezerwacje > 0) {
+        powiadomienia->zglosPrzeladowanie(TabelaDanych::Rezerwacje);
+    }
     return true;
 }
 
 bool DatabaseManager::emailExists(const QString& email, int excludeId) {
     if (email.isEmpty()) return false;
 
-    QSqlQuery query(db);
+    QSqlQuery query = preparedQuery(excludeId >= 0
+                                        ? "SELECT COUNT(*) FROM klient WHERE email = :email AND id != :excludeId"
+                                        : "SELECT COUNT(*) FROM klient WHERE email = :email");
     if (excludeId >= 0) {
-        query.prepare("SELECT COUNT(*) FROM klient WHERE email = :email AND id != :excludeId");
         query.bindValue(":excludeId", excludeId);
-    } else {
-        query.prepare("SELECT COUNT(*) FROM klient WHERE email = :email");
     }
     query.bindValue(":email", email);
 
-    if (!query.exec() || !query.next()) {
+    if (!execWithRetry(query) || !query.next()) {
         qWarning() << "Błąd sprawdzania email:" << query.lastError().text();
         return false;
     }
 
-    return query.value(0).toInt() > 0;
+    bool istnieje = query.value(0).toInt() > 0;
+    query.finish();
+    return istnieje;
 }
 
 QList<Klient> DatabaseManager::searchKlienciByNazwisko(const QString& nazwisko) {
     QList<Klient> klienci;
 
-    QSqlQuery query(db);
-    query.prepare("SELECT id, imie, nazwisko, email, telefon, dataUrodzenia, dataRejestracji, uwagi FROM klient WHERE nazwisko LIKE :nazwisko ORDER BY nazwisko, imie");
+    QSqlQuery query = preparedQuery("SELECT id, imie, nazwisko, email, telefon, dataUrodzenia, dataRejestracji, uwagi FROM klient WHERE nazwisko LIKE :nazwisko ORDER BY nazwisko, imie");
     query.bindValue(":nazwisko", "%" + nazwisko + "%");
 
-    if (!query.exec()) {
+    if (!execWithRetry(query)) {
         qWarning() << "Błąd wyszukiwania klientów:" << query.lastError().text();
         return klienci;
     }
@@ -212,15 +1754,89 @@ QList<Klient> DatabaseManager::searchKlienciByNazwisko(const QString& nazwisko)
     return klienci;
 }
 
+namespace {
+
+// Tekst z pola wyszukiwania jako zapytanie FTS5: każde słowo jako prefiks ("kow"*), słowa
+// łączone przez AND. Sam numer (cyfry i separatory) szukamy też jako prefiks telefonu.
+// Słowa trafiają do zapytania w cudzysłowach, więc operatory FTS5 z tekstu nie działają.
+QString zapytanieFts(const QString& fraza) {
+    static const QRegularExpression slowo("[\\p{L}\\p{N}]+");
+    static const QRegularExpression numer("^[\\d\\s+\\-().]+$");
+
+    QStringList slowa;
+    for (auto it = slowo.globalMatch(fraza); it.hasNext();) {
+        slowa << QString("\"%1\"*").arg(it.next().captured());
+    }
+    if (slowa.isEmpty()) {
+        return QString();
+    }
+
+    QString zapytanie = "(" + slowa.join(" ") + ")";
+    if (numer.match(fraza.trimmed()).hasMatch()) {
+        QString cyfry = fraza;
+        cyfry.remove(QRegularExpression("\\D"));
+        zapytanie = QString("telefon : \"%1\"* OR %2").arg(cyfry, zapytanie);
+    }
+    return zapytanie;
+}
+
+} // namespace
+
+QList<Klient> DatabaseManager::searchKlienci(const QString& fraza, int limit) {
+    QList<Klient> klienci;
+
+    const QString zapytanie = zapytanieFts(fraza);
+    if (zapytanie.isEmpty()) {
+        return klienci;
+    }
+
+    // bm25 z wagami kolumn (imie, nazwisko, email, telefon, uwagi) - trafienie w nazwisku
+    // liczy się bardziej niż w uwagach; mniejszy wynik = lepsze dopasowanie
+    QSqlQuery query = preparedQuery(R"(
+        SELECT k.id, k.imie, k.nazwisko, k.email, k.telefon, k.dataUrodzenia, k.dataRejestracji, k.uwagi
+        FROM klient_fts
+        JOIN klient k ON k.id = klient_fts.rowid
+        WHERE klient_fts MATCH :zapytanie
+        ORDER BY bm25(klient_fts, 5.0, 10.0, 3.0, 3.0, 1.0), k.nazwisko, k.imie
+        LIMIT :limit
+    )");
+    query.bindValue(":zapytanie", zapytanie);
+    query.bindValue(":limit", qMax(1, limit));
+
+    if (!execWithRetry(query)) {
+        qWarning() << "Błąd wyszukiwania pełnotekstowego klientów:" << query.lastError().text();
+        return klienci;
+    }
+
+    while (query.next()) {
+        klienci.append(queryToKlient(query));
+    }
+
+    return klienci;
+}
+
+Strona<Klient> DatabaseManager::searchKlienciByNazwiskoStrona(const QString& nazwisko, const QString& token, int limit) {
+    static const ListaStronicowana lista = {
+        "klienci-nazwisko",
+        "SELECT id, imie, nazwisko, email, telefon, dataUrodzenia, dataRejestracji, uwagi FROM klient "
+        "WHERE nazwisko LIKE :nazwisko AND %1",
+        {{"nazwisko", "nazwisko"}, {"imie", "imie"}, {"id", "id"}},
+        false
+    };
+    return pobierzStrone(lista, token, limit, {{":nazwisko", "%" + nazwisko + "%"}}, &DatabaseManager::queryToKlient);
+}
+
 int DatabaseManager::getKlienciCount() {
-    QSqlQuery query(db);
-    if (!query.exec("SELECT COUNT(*) FROM klient")) {
+    QSqlQuery query = preparedQuery("SELECT COUNT(*) FROM klient");
+    if (!execWithRetry(query)) {
         qWarning() << "Błąd liczenia klientów:" << query.lastError().text();
         return 0;
     }
 
     if (query.next()) {
-        return query.value(0).toInt();
+        int liczba = query.value(0).toInt();
+        query.finish();
+        return liczba;
     }
 
     return 0;
@@ -231,18 +1847,36 @@ int DatabaseManager::getKlienciCount() {
 bool DatabaseManager::addZajecia(const QString& nazwa,
                                  const QString& trener,
                                  int maksUczestnikow,
-                                 const QString& data,
-                                 const QString& czas,
+                                 const QDate& data,
+                                 const QTime& czas,
                                  int czasTrwania,
                                  const QString& opis) {
 
-    if (!data.isEmpty() && !czas.isEmpty() && zajeciaExist(nazwa, data, czas)) {
+    if (data.isValid() && czas.isValid() && zajeciaExist(nazwa, data, czas)) {
         qWarning() << "Zajęcia o tej nazwie, dacie i czasie już istnieją:" << nazwa << data << czas;
         return false;
     }
 
-    QSqlQuery query(db);
-    query.prepare(R"(
+    int noweId = -1;
+    if (!wstawZajecia(nazwa, trener, maksUczestnikow, data, czas, czasTrwania, opis, &noweId)) {
+        return false;
+    }
+
+    qDebug() << "Dodano zajęcia:" << nazwa << "(" << trener << ")";
+    podbijWersje(TabelaDanych::Zajecia);
+    DatabaseNotifier::instance()->zglosZmiane(TabelaDanych::Zajecia, noweId, OperacjaZmiany::Dodanie);
+    return true;
+}
+
+bool DatabaseManager::wstawZajecia(const QString& nazwa,
+                                   const QString& trener,
+                                   int maksUczestnikow,
+                                   const QDate& data,
+                                   const QTime& czas,
+                                   int czasTrwania,
+                                   const QString& opis,
+                                   int* noweId) {
+    QSqlQuery query = preparedQuery(R"(
         INSERT INTO zajecia (nazwa, trener, maksUczestnikow, data, czas, czasTrwania, opis)
         VALUES (:nazwa, :trener, :maksUczestnikow, :data, :czas, :czasTrwania, :opis)
     )");
@@ -250,50 +1884,57 @@ bool DatabaseManager::addZajecia(const QString& nazwa,
     query.bindValue(":nazwa", nazwa);
     query.bindValue(":trener", trener.isEmpty() ? QVariant() : trener);
     query.bindValue(":maksUczestnikow", maksUczestnikow);
-    query.bindValue(":data", data.isEmpty() ? QVariant() : data);
-    query.bindValue(":czas", czas.isEmpty() ? QVariant() : czas);
+    query.bindValue(":data", dzienDoBazy(data));
+    query.bindValue(":czas", minutaDoBazy(czas));
     query.bindValue(":czasTrwania", czasTrwania);
     query.bindValue(":opis", opis.isEmpty() ? QVariant() : opis);
 
-    if (!query.exec()) {
+    if (!execWithRetry(query)) {
         qWarning() << "Błąd dodawania zajęć:" << query.lastError().text();
         return false;
     }
-
-    qDebug() << "Dodano zajęcia:" << nazwa << "(" << trener << ")";
+    if (noweId) {
+        *noweId = query.lastInsertId().toInt();
+    }
     return true;
 }
 
 QList<Zajecia> DatabaseManager::getAllZajecia() {
-    QList<Zajecia> zajecia;
-
-    QSqlQuery query(db);
-    if (!query.exec("SELECT id, nazwa, trener, maksUczestnikow, data, czas, czasTrwania, opis FROM zajecia ORDER BY data, czas, nazwa")) {
-        qWarning() << "Błąd pobierania zajęć:" << query.lastError().text();
-        return zajecia;
-    }
-
-    while (query.next()) {
-        zajecia.append(queryToZajecia(query));
-    }
+    // aktualneRezerwacje zmienia się przy zapisie rezerwacji
+    return pobierzListe("SELECT id, nazwa, trener, maksUczestnikow, data, czas, czasTrwania, opis, aktualneRezerwacje FROM zajecia ORDER BY data, czas, nazwa",
+                        {}, {TabelaDanych::Zajecia, TabelaDanych::Rezerwacje}, &DatabaseManager::queryToZajecia,
+                        "Błąd pobierania zajęć:");
+}
 
-    return zajecia;
+Strona<Zajecia> DatabaseManager::getZajeciaStrona(const QString& token, int limit) {
+    static const ListaStronicowana lista = {
+        "zajecia",
+        "SELECT id, nazwa, trener, maksUczestnikow, data, czas, czasTrwania, opis, aktualneRezerwacje FROM zajecia WHERE %1",
+        {{"COALESCE(data, -1)", "data"}, {"COALESCE(czas, -1)", "czas"}, {"nazwa", "nazwa"}, {"id", "id"}},
+        false
+    };
+    return pobierzStrone(lista, token, limit, {}, &DatabaseManager::queryToZajecia);
 }
 
 Zajecia DatabaseManager::getZajeciaById(int id) {
     Zajecia zajecia = {};
+    quint64 generacja = 0;
+    if (cacheZajec.pobierz(id, zajecia, generacja)) {
+        return zajecia;
+    }
 
-    QSqlQuery query(db);
-    query.prepare("SELECT id, nazwa, trener, maksUczestnikow, data, czas, czasTrwania, opis FROM zajecia WHERE id = :id");
+    QSqlQuery query = preparedQuery("SELECT id, nazwa, trener, maksUczestnikow, data, czas, czasTrwania, opis, aktualneRezerwacje FROM zajecia WHERE id = :id");
     query.bindValue(":id", id);
 
-    if (!query.exec()) {
+    if (!execWithRetry(query)) {
         qWarning() << "Błąd pobierania zajęć o ID" << id << ":" << query.lastError().text();
         return zajecia;
     }
 
     if (query.next()) {
         zajecia = queryToZajecia(query);
+        query.finish();
+        cacheZajec.zapisz(id, zajecia, generacja);
     }
 
     return zajecia;
@@ -303,18 +1944,17 @@ bool DatabaseManager::updateZajecia(int id,
                                     const QString& nazwa,
                                     const QString& trener,
                                     int maksUczestnikow,
-                                    const QString& data,
-                                    const QString& czas,
+                                    const QDate& data,
+                                    const QTime& czas,
                                     int czasTrwania,
                                     const QString& opis) {
 
-    if (!data.isEmpty() && !czas.isEmpty() && zajeciaExist(nazwa, data, czas, id)) {
+    if (data.isValid() && czas.isValid() && zajeciaExist(nazwa, data, czas, id)) {
         qWarning() << "Zajęcia o tej nazwie, dacie i czasie już istnieją:" << nazwa << data << czas;
         return false;
     }
 
-    QSqlQuery query(db);
-    query.prepare(R"(
+    QSqlQuery query = preparedQuery(R"(
         UPDATE zajecia
         SET nazwa = :nazwa, trener = :trener, maksUczestnikow = :maksUczestnikow,
             data = :data, czas = :czas, czasTrwania = :czasTrwania, opis = :opis
@@ -325,12 +1965,12 @@ bool DatabaseManager::updateZajecia(int id,
     query.bindValue(":nazwa", nazwa);
     query.bindValue(":trener", trener.isEmpty() ? QVariant() : trener);
     query.bindValue(":maksUczestnikow", maksUczestnikow);
-    query.bindValue(":data", data.isEmpty() ? QVariant() : data);
-    query.bindValue(":czas", czas.isEmpty() ? QVariant() : czas);
+    query.bindValue(":data", dzienDoBazy(data));
+    query.bindValue(":czas", minutaDoBazy(czas));
     query.bindValue(":czasTrwania", czasTrwania);
     query.bindValue(":opis", opis.isEmpty() ? QVariant() : opis);
 
-    if (!query.exec()) {
+    if (!execWithRetry(query)) {
         qWarning() << "Błąd aktualizacji zajęć:" << query.lastError().text();
         return false;
     }
@@ -341,36 +1981,66 @@ bool DatabaseManager::updateZajecia(int id,
     }
 
     qDebug() << "Zaktualizowano zajęcia o ID:" << id;
+    cacheZajec.usun(id);
+    podbijWersje(TabelaDanych::Zajecia);
+    DatabaseNotifier::instance()->zglosZmiane(TabelaDanych::Zajecia, id, OperacjaZmiany::Zmiana);
     return true;
 }
 
 bool DatabaseManager::deleteZajecia(int id) {
-    QSqlQuery query(db);
-    query.prepare("DELETE FROM zajecia WHERE id = :id");
-    query.bindValue(":id", id);
-
-    if (!query.exec()) {
-        qWarning() << "Błąd usuwania zajęć:" << query.lastError().text();
+    // Rezerwacje zajęć usuwamy w tej samej transakcji (baza nie ma kluczy obcych);
+    // trigger zmniejsza przy tym liczniki aktywnych rezerwacji klientów
+    if (!beginWriteTransaction()) {
         return false;
     }
 
-    if (query.numRowsAffected() == 0) {
-        qWarning() << "Nie znaleziono zajęć o ID:" << id;
+    auto usun = [id](const char* sql) {
+        QSqlQuery query = preparedQuery(sql);
+        query.bindValue(":id", id);
+        if (!execWithRetry(query)) {
+            qWarning() << "Błąd usuwania zajęć:" << query.lastError().text();
+            return -1;
+        }
+        return query.numRowsAffected();
+    };
+
+    const int rezerwacje = usun("DELETE FROM rezerwacja WHERE idZajec = :id");
+    const int zajecia = rezerwacje < 0 ? -1 : usun("DELETE FROM zajecia WHERE id = :id");
+
+    if (zajecia <= 0) {
+        if (zajecia == 0) {
+            qWarning() << "Nie znaleziono zajęć o ID:" << id;
+        }
+        rollbackTransaction();
         return false;
     }
+    if (!commitTransaction()) {
+        rollbackTransaction();
+        return false;
+    }
+
+    qDebug() << "Usunięto zajęcia o ID:" << id << "- rezerwacji:" << rezerwacje;
+    cacheZajec.usun(id);
+    podbijWersje(TabelaDanych::Zajecia);
+    if (rezerwacje > 0) {
+        podbijWersje(TabelaDanych::Rezerwacje);
+    }
 
-    qDebug() << "Usunięto zajęcia o ID:" << id;
+    DatabaseNotifier* powiadomienia = DatabaseNotifier::instance();
+    powiadomienia->zglosZmiane(TabelaDanych::Zajecia, id, OperacjaZmiany::Usuniecie);
+    if (rezerwacje > 0) {
+        powiadomienia->zglosPrzeladowanie(TabelaDanych::Rezerwacje);
+    }
     return true;
 }
 
 QList<Zajecia> DatabaseManager::searchZajeciaByNazwa(const QString& nazwa) {
     QList<Zajecia> zajecia;
 
-    QSqlQuery query(db);
-    query.prepare("SELECT id, nazwa, trener, maksUczestnikow, data, czas, czasTrwania, opis FROM zajecia WHERE nazwa LIKE :nazwa ORDER BY data, czas, nazwa");
+    QSqlQuery query = preparedQuery("SELECT id, nazwa, trener, maksUczestnikow, data, czas, czasTrwania, opis, aktualneRezerwacje FROM zajecia WHERE nazwa LIKE :nazwa ORDER BY data, czas, nazwa");
     query.bindValue(":nazwa", "%" + nazwa + "%");
 
-    if (!query.exec()) {
+    if (!execWithRetry(query)) {
         qWarning() << "Błąd wyszukiwania zajęć po nazwie:" << query.lastError().text();
         return zajecia;
     }
@@ -382,14 +2052,24 @@ QList<Zajecia> DatabaseManager::searchZajeciaByNazwa(const QString& nazwa) {
     return zajecia;
 }
 
+Strona<Zajecia> DatabaseManager::searchZajeciaByNazwaStrona(const QString& nazwa, const QString& token, int limit) {
+    static const ListaStronicowana lista = {
+        "zajecia-nazwa",
+        "SELECT id, nazwa, trener, maksUczestnikow, data, czas, czasTrwania, opis, aktualneRezerwacje FROM zajecia "
+        "WHERE nazwa LIKE :nazwa AND %1",
+        {{"COALESCE(data, -1)", "data"}, {"COALESCE(czas, -1)", "czas"}, {"nazwa", "nazwa"}, {"id", "id"}},
+        false
+    };
+    return pobierzStrone(lista, token, limit, {{":nazwa", "%" + nazwa + "%"}}, &DatabaseManager::queryToZajecia);
+}
+
 QList<Zajecia> DatabaseManager::searchZajeciaByTrener(const QString& trener) {
     QList<Zajecia> zajecia;
 
-    QSqlQuery query(db);
-    query.prepare("SELECT id, nazwa, trener, maksUczestnikow, data, czas, czasTrwania, opis FROM zajecia WHERE trener LIKE :trener ORDER BY data, czas, nazwa");
+    QSqlQuery query = preparedQuery("SELECT id, nazwa, trener, maksUczestnikow, data, czas, czasTrwania, opis, aktualneRezerwacje FROM zajecia WHERE trener LIKE :trener ORDER BY data, czas, nazwa");
     query.bindValue(":trener", "%" + trener + "%");
 
-    if (!query.exec()) {
+    if (!execWithRetry(query)) {
         qWarning() << "Błąd wyszukiwania zajęć po trenerze:" << query.lastError().text();
         return zajecia;
     }
@@ -401,14 +2081,24 @@ QList<Zajecia> DatabaseManager::searchZajeciaByTrener(const QString& trener) {
     return zajecia;
 }
 
-QList<Zajecia> DatabaseManager::getZajeciaByData(const QString& data) {
+Strona<Zajecia> DatabaseManager::searchZajeciaByTrenerStrona(const QString& trener, const QString& token, int limit) {
+    static const ListaStronicowana lista = {
+        "zajecia-trener",
+        "SELECT id, nazwa, trener, maksUczestnikow, data, czas, czasTrwania, opis, aktualneRezerwacje FROM zajecia "
+        "WHERE trener LIKE :trener AND %1",
+        {{"COALESCE(data, -1)", "data"}, {"COALESCE(czas, -1)", "czas"}, {"nazwa", "nazwa"}, {"id", "id"}},
+        false
+    };
+    return pobierzStrone(lista, token, limit, {{":trener", "%" + trener + "%"}}, &DatabaseManager::queryToZajecia);
+}
+
+QList<Zajecia> DatabaseManager::getZajeciaByData(const QDate& data) {
     QList<Zajecia> zajecia;
 
-    QSqlQuery query(db);
-    query.prepare("SELECT id, nazwa, trener, maksUczestnikow, data, czas, czasTrwania, opis FROM zajecia WHERE data = :data ORDER BY czas, nazwa");
-    query.bindValue(":data", data);
+    QSqlQuery query = preparedQuery("SELECT id, nazwa, trener, maksUczestnikow, data, czas, czasTrwania, opis, aktualneRezerwacje FROM zajecia WHERE data = :data ORDER BY czas, nazwa");
+    query.bindValue(":data", dzienDoBazy(data));
 
-    if (!query.exec()) {
+    if (!execWithRetry(query)) {
         qWarning() << "Błąd pobierania zajęć z dnia" << data << ":" << query.lastError().text();
         return zajecia;
     }
@@ -420,80 +2110,179 @@ QList<Zajecia> DatabaseManager::getZajeciaByData(const QString& data) {
     return zajecia;
 }
 
+QList<Zajecia> DatabaseManager::getZajeciaWPrzedziale(const QDateTime& od, const QDateTime& przed) {
+    QList<Zajecia> zajecia;
+    if (!od.isValid() || !przed.isValid()) {
+        return zajecia;
+    }
+
+    // Chwila jako para (dzień, minuta) - porównanie par to zakres w idx_zajecia_data_czas.
+    // Zajęcia bez daty albo godziny nie mają początku, więc nie trafiają do żadnego przedziału.
+    QSqlQuery query = preparedQuery(R"(
+        SELECT id, nazwa, trener, maksUczestnikow, data, czas, czasTrwania, opis, aktualneRezerwacje
+        FROM zajecia
+        WHERE (data, czas) >= (:dzienOd, :minutaOd) AND (data, czas) < (:dzienPrzed, :minutaPrzed)
+        ORDER BY data, czas, nazwa
+    )");
+    query.bindValue(":dzienOd", dzienDoBazy(od.date()));
+    query.bindValue(":minutaOd", minutaDoBazy(od.time()));
+    query.bindValue(":dzienPrzed", dzienDoBazy(przed.date()));
+    query.bindValue(":minutaPrzed", minutaDoBazy(przed.time()));
+
+    if (!execWithRetry(query)) {
+        qWarning() << "Błąd pobierania zajęć z przedziału" << od << "-" << przed << ":" << query.lastError().text();
+        return zajecia;
+    }
+
+    while (query.next()) {
+        zajecia.append(queryToZajecia(query));
+    }
+
+    return zajecia;
+}
+
 int DatabaseManager::getZajeciaCount() {
-    QSqlQuery query(db);
-    if (!query.exec("SELECT COUNT(*) FROM zajecia")) {
+    QSqlQuery query = preparedQuery("SELECT COUNT(*) FROM zajecia");
+    if (!execWithRetry(query)) {
         qWarning() << "Błąd liczenia zajęć:" << query.lastError().text();
         return 0;
     }
 
     if (query.next()) {
-        return query.value(0).toInt();
+        int liczba = query.value(0).toInt();
+        query.finish();
+        return liczba;
     }
 
     return 0;
 }
 
-bool DatabaseManager::zajeciaExist(const QString& nazwa, const QString& data, const QString& czas, int excludeId) {
-    if (nazwa.isEmpty() || data.isEmpty() || czas.isEmpty()) return false;
+bool DatabaseManager::zajeciaExist(const QString& nazwa, const QDate& data, const QTime& czas, int excludeId) {
+    if (nazwa.isEmpty() || !data.isValid() || !czas.isValid()) return false;
 
-    QSqlQuery query(db);
+    QSqlQuery query = preparedQuery(excludeId >= 0
+                                        ? "SELECT COUNT(*) FROM zajecia WHERE nazwa = :nazwa AND data = :data AND czas = :czas AND id != :excludeId"
+                                        : "SELECT COUNT(*) FROM zajecia WHERE nazwa = :nazwa AND data = :data AND czas = :czas");
     if (excludeId >= 0) {
-        query.prepare("SELECT COUNT(*) FROM zajecia WHERE nazwa = :nazwa AND data = :data AND czas = :czas AND id != :excludeId");
         query.bindValue(":excludeId", excludeId);
-    } else {
-        query.prepare("SELECT COUNT(*) FROM zajecia WHERE nazwa = :nazwa AND data = :data AND czas = :czas");
     }
     query.bindValue(":nazwa", nazwa);
-    query.bindValue(":data", data);
-    query.bindValue(":czas", czas);
+    query.bindValue(":data", dzienDoBazy(data));
+    query.bindValue(":czas", minutaDoBazy(czas));
 
-    if (!query.exec() || !query.next()) {
+    if (!execWithRetry(query) || !query.next()) {
         qWarning() << "Błąd sprawdzania istnienia zajęć:" << query.lastError().text();
         return false;
     }
 
-    return query.value(0).toInt() > 0;
+    bool istnieje = query.value(0).toInt() > 0;
+    query.finish();
+    return istnieje;
 }
 
 // === CRUD dla REZERWACJI === (pozostają bez zmian - skrócone dla oszczędności miejsca)
 
-bool DatabaseManager::addRezerwacja(int idKlienta, int idZajec, const QString& status) {
-    if (klientMaRezerwacje(idKlienta, idZajec)) {
-        qWarning() << "Klient już ma rezerwację na te zajęcia. Klient ID:" << idKlienta << "Zajęcia ID:" << idZajec;
-        return false;
+bool DatabaseManager::addRezerwacja(int idKlienta, int idZajec, StatusRezerwacji status) {
+    return zarezerwuj(idKlienta, idZajec, status) == WynikRezerwacji::Ok;
+}
+
+WynikRezerwacji DatabaseManager::zarezerwuj(int idKlienta, int idZajec, StatusRezerwacji status) {
+    // Blokada zapisu od początku transakcji - dwa stanowiska nie zajmą ostatniego miejsca jednocześnie
+    if (!beginWriteTransaction()) {
+        return WynikRezerwacji::Blad;
     }
 
-    if (!moznaZarezerwowac(idZajec)) {
+    int noweId = -1;
+    WynikRezerwacji wynik = wstawRezerwacje(idKlienta, idZajec, status, &noweId);
+
+    if (wynik != WynikRezerwacji::Ok) {
+        rollbackTransaction();
+    } else if (!commitTransaction()) {
+        rollbackTransaction();
+        return WynikRezerwacji::Blad;
+    }
+
+    switch (wynik) {
+    case WynikRezerwacji::Ok:
+        qDebug() << "Dodano rezerwację: klient" << idKlienta << "na zajęcia" << idZajec;
+        cacheZajec.usun(idZajec);   // trigger zwiększył aktualneRezerwacje
+        podbijWersje(TabelaDanych::Rezerwacje);
+        DatabaseNotifier::instance()->zglosZmiane(TabelaDanych::Rezerwacje, noweId, OperacjaZmiany::Dodanie);
+        break;
+    case WynikRezerwacji::Duplikat:
+        qWarning() << "Klient już ma rezerwację na te zajęcia. Klient ID:" << idKlienta << "Zajęcia ID:" << idZajec;
+        break;
+    case WynikRezerwacji::BrakMiejsc:
         qWarning() << "Przekroczono limit uczestników dla zajęć ID:" << idZajec;
-        return false;
+        break;
+    case WynikRezerwacji::NieznaneZajecia:
+        qWarning() << "Nie znaleziono zajęć o ID:" << idZajec;
+        break;
+    case WynikRezerwacji::Blad:
+        break;
     }
 
-    QSqlQuery query(db);
-    query.prepare(R"(
+    return wynik;
+}
+
+WynikRezerwacji DatabaseManager::wstawRezerwacje(int idKlienta, int idZajec, StatusRezerwacji status, int* noweId) {
+    // Limit i duplikat sprawdzane tylko dla aktywnych rezerwacji - anulowana nie zajmuje miejsca
+    QSqlQuery query = preparedQuery(R"(
         INSERT INTO rezerwacja (idKlienta, idZajec, dataRezerwacji, status)
-        VALUES (:idKlienta, :idZajec, :dataRezerwacji, :status)
+        SELECT :idKlienta, z.id, :dataRezerwacji, :status
+        FROM zajecia z
+        WHERE z.id = :idZajec
+          AND (:statusWarunek <> 0 OR (
+                z.aktualneRezerwacje < z.maksUczestnikow
+                AND NOT EXISTS (SELECT 1 FROM rezerwacja r
+                                WHERE r.idKlienta = :idKlientaWarunek AND r.idZajec = z.id AND r.status = 0)))
     )");
 
     query.bindValue(":idKlienta", idKlienta);
     query.bindValue(":idZajec", idZajec);
-    query.bindValue(":dataRezerwacji", QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss"));
-    query.bindValue(":status", status);
+    query.bindValue(":dataRezerwacji", QDateTime::currentSecsSinceEpoch());
+    query.bindValue(":status", static_cast<int>(status));
+    query.bindValue(":statusWarunek", static_cast<int>(status));
+    query.bindValue(":idKlientaWarunek", idKlienta);
 
-    if (!query.exec()) {
+    if (!execWithRetry(query)) {
         qWarning() << "Błąd dodawania rezerwacji:" << query.lastError().text();
-        return false;
+        return WynikRezerwacji::Blad;
     }
 
-    qDebug() << "Dodano rezerwację: klient" << idKlienta << "na zajęcia" << idZajec;
-    return true;
+    if (query.numRowsAffected() > 0) {
+        if (noweId) {
+            *noweId = query.lastInsertId().toInt();
+        }
+        return WynikRezerwacji::Ok;
+    }
+
+    // Nic nie wstawiono - ustal przyczynę w tej samej transakcji
+    QSqlQuery przyczyna = preparedQuery(R"(
+        SELECT EXISTS (SELECT 1 FROM rezerwacja r
+                       WHERE r.idKlienta = :idKlienta AND r.idZajec = z.id AND r.status = 0) AS duplikat
+        FROM zajecia z
+        WHERE z.id = :idZajec
+    )");
+    przyczyna.bindValue(":idKlienta", idKlienta);
+    przyczyna.bindValue(":idZajec", idZajec);
+
+    if (!execWithRetry(przyczyna)) {
+        qWarning() << "Błąd sprawdzania przyczyny odrzucenia rezerwacji:" << przyczyna.lastError().text();
+        return WynikRezerwacji::Blad;
+    }
+
+    if (!przyczyna.next()) {
+        return WynikRezerwacji::NieznaneZajecia;
+    }
+
+    bool duplikat = przyczyna.value(0).toInt() > 0;
+    przyczyna.finish();
+    return duplikat ? WynikRezerwacji::Duplikat : WynikRezerwacji::BrakMiejsc;
 }
 
 QList<Rezerwacja> DatabaseManager::getAllRezerwacje() {
-    QList<Rezerwacja> rezerwacje;
-
-    QSqlQuery query(db);
-    if (!query.exec(R"(
+    return pobierzListe(R"(
         SELECT r.id, r.idKlienta, r.idZajec, r.dataRezerwacji, r.status,
                k.imie, k.nazwisko,
                z.nazwa, z.trener, z.data, z.czas
@@ -501,23 +2290,38 @@ QList<Rezerwacja> DatabaseManager::getAllRezerwacje() {
         JOIN klient k ON r.idKlienta = k.id
         JOIN zajecia z ON r.idZajec = z.id
         ORDER BY r.dataRezerwacji DESC
-    )")) {
-        qWarning() << "Błąd pobierania rezerwacji:" << query.lastError().text();
-        return rezerwacje;
-    }
+    )", {}, {TabelaDanych::Rezerwacje, TabelaDanych::Klienci, TabelaDanych::Zajecia},
+        &DatabaseManager::queryToRezerwacja, "Błąd pobierania rezerwacji:");
+}
 
-    while (query.next()) {
-        rezerwacje.append(queryToRezerwacja(query));
-    }
+Strona<Rezerwacja> DatabaseManager::getRezerwacjeStrona(const QString& token, int limit) {
+    return getRezerwacjeStrona(FiltrListy(), token, limit);
+}
 
-    return rezerwacje;
+Strona<Rezerwacja> DatabaseManager::getRezerwacjeStrona(const FiltrListy& filtr, const QString& token, int limit) {
+    static const ListaStronicowana lista = {
+        "rezerwacje",
+        R"(
+            SELECT r.id, r.idKlienta, r.idZajec, r.dataRezerwacji, r.status,
+                   k.imie, k.nazwisko,
+                   z.nazwa, z.trener, z.data, z.czas
+            FROM rezerwacja r
+            JOIN klient k ON r.idKlienta = k.id
+            JOIN zajecia z ON r.idZajec = z.id
+            WHERE %1
+        )",
+        {{"COALESCE(r.dataRezerwacji, -1)", "dataRezerwacji"}, {"r.id", "id"}},
+        true
+    };
+    QVariantMap parametry;
+    const QString warunek = warunekFiltraRezerwacji(filtr, parametry);
+    return pobierzStrone(lista, token, limit, parametry, &DatabaseManager::queryToRezerwacja, warunek);
 }
 
 Rezerwacja DatabaseManager::getRezerwacjaById(int id) {
     Rezerwacja rezerwacja = {};
 
-    QSqlQuery query(db);
-    query.prepare(R"(
+    QSqlQuery query = preparedQuery(R"(
         SELECT r.id, r.idKlienta, r.idZajec, r.dataRezerwacji, r.status,
                k.imie, k.nazwisko,
                z.nazwa, z.trener, z.data, z.czas
@@ -528,107 +2332,173 @@ Rezerwacja DatabaseManager::getRezerwacjaById(int id) {
     )");
     query.bindValue(":id", id);
 
-    if (!query.exec()) {
+    if (!execWithRetry(query)) {
         qWarning() << "Błąd pobierania rezerwacji o ID" << id << ":" << query.lastError().text();
         return rezerwacja;
     }
 
     if (query.next()) {
         rezerwacja = queryToRezerwacja(query);
+        query.finish();
     }
 
     return rezerwacja;
 }
 
-bool DatabaseManager::updateRezerwacjaStatus(int id, const QString& status) {
-    QSqlQuery query(db);
-    query.prepare("UPDATE rezerwacja SET status = :status WHERE id = :id");
+bool DatabaseManager::updateRezerwacjaStatus(int id, StatusRezerwacji status) {
+    // Id zajęć odczytane w tej samej transakcji co zapis - trigger zmienia ich aktualneRezerwacje
+    if (!beginWriteTransaction()) {
+        return false;
+    }
+
+    const int idZajec = zajeciaRezerwacji(id);
+    if (idZajec < 0) {
+        rollbackTransaction();
+        return false;
+    }
+
+    QSqlQuery query = preparedQuery("UPDATE rezerwacja SET status = :status WHERE id = :id");
     query.bindValue(":id", id);
-    query.bindValue(":status", status);
+    query.bindValue(":status", static_cast<int>(status));
 
-    if (!query.exec()) {
+    if (!execWithRetry(query)) {
         qWarning() << "Błąd aktualizacji statusu rezerwacji:" << query.lastError().text();
+        rollbackTransaction();
         return false;
     }
-
-    if (query.numRowsAffected() == 0) {
-        qWarning() << "Nie znaleziono rezerwacji o ID:" << id;
+    if (!commitTransaction()) {
+        rollbackTransaction();
         return false;
     }
 
-    qDebug() << "Zaktualizowano status rezerwacji o ID:" << id << "na:" << status;
+    qDebug() << "Zaktualizowano status rezerwacji o ID:" << id << "na:" << nazwaStatusuRezerwacji(status);
+    cacheZajec.usun(idZajec);
+    podbijWersje(TabelaDanych::Rezerwacje);
+    DatabaseNotifier::instance()->zglosZmiane(TabelaDanych::Rezerwacje, id, OperacjaZmiany::Zmiana);
     return true;
 }
 
 bool DatabaseManager::deleteRezerwacja(int id) {
-    QSqlQuery query(db);
-    query.prepare("DELETE FROM rezerwacja WHERE id = :id");
+    if (!beginWriteTransaction()) {
+        return false;
+    }
+
+    const int idZajec = zajeciaRezerwacji(id);
+    if (idZajec < 0) {
+        rollbackTransaction();
+        return false;
+    }
+
+    QSqlQuery query = preparedQuery("DELETE FROM rezerwacja WHERE id = :id");
     query.bindValue(":id", id);
 
-    if (!query.exec()) {
+    if (!execWithRetry(query)) {
         qWarning() << "Błąd usuwania rezerwacji:" << query.lastError().text();
+        rollbackTransaction();
         return false;
     }
-
-    if (query.numRowsAffected() == 0) {
-        qWarning() << "Nie znaleziono rezerwacji o ID:" << id;
+    if (!commitTransaction()) {
+        rollbackTransaction();
         return false;
     }
 
     qDebug() << "Usunięto rezerwację o ID:" << id;
+    cacheZajec.usun(idZajec);
+    podbijWersje(TabelaDanych::Rezerwacje);
+    DatabaseNotifier::instance()->zglosZmiane(TabelaDanych::Rezerwacje, id, OperacjaZmiany::Usuniecie);
     return true;
 }
 
 // === Pomocnicze metody dla rezerwacji ===
 
+int DatabaseManager::zajeciaRezerwacji(int idRezerwacji) {
+    QSqlQuery query = preparedQuery("SELECT idZajec FROM rezerwacja WHERE id = :id");
+    query.bindValue(":id", idRezerwacji);
+
+    if (!execWithRetry(query)) {
+        qWarning() << "Błąd odczytu rezerwacji:" << query.lastError().text();
+        return -1;
+    }
+    if (!query.next()) {
+        qWarning() << "Nie znaleziono rezerwacji o ID:" << idRezerwacji;
+        return -1;
+    }
+
+    const int idZajec = query.value(0).toInt();
+    query.finish();
+    return idZajec;
+}
+
+QString DatabaseManager::nazwaStatusuRezerwacji(StatusRezerwacji status) {
+    switch (status) {
+    case StatusRezerwacji::Aktywna:
+        return "aktywna";
+    case StatusRezerwacji::Anulowana:
+        return "anulowana";
+    }
+    return QString();
+}
+
+std::optional<StatusRezerwacji> DatabaseManager::statusRezerwacjiZNazwy(const QString& nazwa) {
+    const QString tekst = nazwa.trimmed().toLower();
+    if (tekst == "aktywna") {
+        return StatusRezerwacji::Aktywna;
+    }
+    if (tekst == "anulowana") {
+        return StatusRezerwacji::Anulowana;
+    }
+    return std::nullopt;
+}
+
 bool DatabaseManager::klientMaRezerwacje(int idKlienta, int idZajec) {
-    QSqlQuery query(db);
-    query.prepare("SELECT COUNT(*) FROM rezerwacja WHERE idKlienta = :idKlienta AND idZajec = :idZajec AND status = 'aktywna'");
+    QSqlQuery query = preparedQuery("SELECT COUNT(*) FROM rezerwacja WHERE idKlienta = :idKlienta AND idZajec = :idZajec AND status = 0");
     query.bindValue(":idKlienta", idKlienta);
     query.bindValue(":idZajec", idZajec);
 
-    if (!query.exec() || !query.next()) {
+    if (!execWithRetry(query) || !query.next()) {
         qWarning() << "Błąd sprawdzania rezerwacji klienta:" << query.lastError().text();
         return false;
     }
 
-    return query.value(0).toInt() > 0;
+    bool istnieje = query.value(0).toInt() > 0;
+    query.finish();
+    return istnieje;
 }
 
 int DatabaseManager::getIloscAktywnychRezerwacji(int idZajec) {
-    QSqlQuery query(db);
-    query.prepare("SELECT COUNT(*) FROM rezerwacja WHERE idZajec = :idZajec AND status = 'aktywna'");
+    QSqlQuery query = preparedQuery("SELECT aktualneRezerwacje FROM zajecia WHERE id = :idZajec");
     query.bindValue(":idZajec", idZajec);
 
-    if (!query.exec() || !query.next()) {
+    if (!execWithRetry(query)) {
         qWarning() << "Błąd liczenia aktywnych rezerwacji:" << query.lastError().text();
         return 0;
     }
 
-    return query.value(0).toInt();
+    if (!query.next()) {
+        return 0;
+    }
+
+    int ilosc = query.value(0).toInt();
+    query.finish();
+    return ilosc;
 }
 
 bool DatabaseManager::moznaZarezerwowac(int idZajec) {
-    QSqlQuery query(db);
-    query.prepare("SELECT maksUczestnikow FROM zajecia WHERE id = :id");
+    QSqlQuery query = preparedQuery("SELECT aktualneRezerwacje < maksUczestnikow FROM zajecia WHERE id = :id");
     query.bindValue(":id", idZajec);
 
-    if (!query.exec() || !query.next()) {
+    if (!execWithRetry(query) || !query.next()) {
         qWarning() << "Błąd pobierania limitu zajęć:" << query.lastError().text();
         return false;
     }
 
-    int limit = query.value(0).toInt();
-    int aktualne = getIloscAktywnychRezerwacji(idZajec);
-
-    return aktualne < limit;
+    bool wolne = query.value(0).toInt() > 0;
+    query.finish();
+    return wolne;
 }
 
 QList<Rezerwacja> DatabaseManager::getRezerwacjeKlienta(int idKlienta) {
-    QList<Rezerwacja> rezerwacje;
-
-    QSqlQuery query(db);
-    query.prepare(R"(
+    return pobierzListe(R"(
         SELECT r.id, r.idKlienta, r.idZajec, r.dataRezerwacji, r.status,
                k.imie, k.nazwisko,
                z.nazwa, z.trener, z.data, z.czas
@@ -637,82 +2507,97 @@ QList<Rezerwacja> DatabaseManager::getRezerwacjeKlienta(int idKlienta) {
         JOIN zajecia z ON r.idZajec = z.id
         WHERE r.idKlienta = :idKlienta
         ORDER BY z.data, z.czas
-    )");
-    query.bindValue(":idKlienta", idKlienta);
-
-    if (!query.exec()) {
-        qWarning() << "Błąd pobierania rezerwacji klienta:" << query.lastError().text();
-        return rezerwacje;
-    }
-
-    while (query.next()) {
-        rezerwacje.append(queryToRezerwacja(query));
-    }
-
-    return rezerwacje;
+    )", {{":idKlienta", idKlienta}}, {TabelaDanych::Rezerwacje, TabelaDanych::Klienci, TabelaDanych::Zajecia},
+        &DatabaseManager::queryToRezerwacja, "Błąd pobierania rezerwacji klienta:");
 }
 
 QList<Rezerwacja> DatabaseManager::getRezerwacjeZajec(int idZajec) {
-    QList<Rezerwacja> rezerwacje;
-
-    QSqlQuery query(db);
-    query.prepare(R"(
+    return pobierzListe(R"(
         SELECT r.id, r.idKlienta, r.idZajec, r.dataRezerwacji, r.status,
                k.imie, k.nazwisko,
                z.nazwa, z.trener, z.data, z.czas
         FROM rezerwacja r
         JOIN klient k ON r.idKlienta = k.id
         JOIN zajecia z ON r.idZajec = z.id
-        WHERE r.idZajec = :idZajec AND r.status = 'aktywna'
+        WHERE r.idZajec = :idZajec AND r.status = 0
         ORDER BY k.nazwisko, k.imie
-    )");
-    query.bindValue(":idZajec", idZajec);
-
-    if (!query.exec()) {
-        qWarning() << "Błąd pobierania rezerwacji zajęć:" << query.lastError().text();
-        return rezerwacje;
-    }
+    )", {{":idZajec", idZajec}}, {TabelaDanych::Rezerwacje, TabelaDanych::Klienci, TabelaDanych::Zajecia},
+        &DatabaseManager::queryToRezerwacja, "Błąd pobierania rezerwacji zajęć:");
+}
 
-    while (query.next()) {
-        rezerwacje.append(queryToRezerwacja(query));
+QList<Rezerwacja> DatabaseManager::getRezerwacjeWPrzedziale(const QDateTime& od, const QDateTime& przed) {
+    if (!od.isValid() || !przed.isValid()) {
+        return {};
     }
 
-    return rezerwacje;
+    // Wyrażenie jak w idx_rezerwacja_stronicowanie - zakres sekund w indeksie
+    return pobierzListe(R"(
+        SELECT r.id, r.idKlienta, r.idZajec, r.dataRezerwacji, r.status,
+               k.imie, k.nazwisko,
+               z.nazwa, z.trener, z.data, z.czas
+        FROM rezerwacja r
+        JOIN klient k ON r.idKlienta = k.id
+        JOIN zajecia z ON r.idZajec = z.id
+        WHERE COALESCE(r.dataRezerwacji, -1) >= :od AND COALESCE(r.dataRezerwacji, -1) < :przed
+        ORDER BY COALESCE(r.dataRezerwacji, -1) DESC, r.id DESC
+    )", {{":od", chwilaDoBazy(od)}, {":przed", chwilaDoBazy(przed)}}, {TabelaDanych::Rezerwacje, TabelaDanych::Klienci, TabelaDanych::Zajecia},
+        &DatabaseManager::queryToRezerwacja, "Błąd pobierania rezerwacji z przedziału:");
 }
 
 QList<Zajecia> DatabaseManager::getZajeciaDostepneDoRezerwacji() {
-    QList<Zajecia> zajecia;
+    // Tylko nadchodzące zajęcia (zakres po indeksie zajecia(data, czas)) z wolnym miejscem wg licznika.
+    // Dzisiejsza data jest w kluczu cache - po północy wynik liczy się od nowa.
+    return pobierzListe(R"(
+        SELECT id, nazwa, trener, maksUczestnikow, data, czas, czasTrwania, opis, aktualneRezerwacje
+        FROM zajecia
+        WHERE data >= :dzisiaj AND aktualneRezerwacje < maksUczestnikow
+        ORDER BY data, czas
+    )", {{":dzisiaj", dzienDoBazy(QDate::currentDate())}}, {TabelaDanych::Zajecia, TabelaDanych::Rezerwacje},
+        &DatabaseManager::queryToZajecia, "Błąd pobierania dostępnych zajęć:");
+}
 
-    QSqlQuery query(db);
-    if (!query.exec(R"(
-        SELECT z.id, z.nazwa, z.trener, z.maksUczestnikow, z.data, z.czas, z.czasTrwania, z.opis,
-               COUNT(r.id) as aktualne_rezerwacje
-        FROM zajecia z
-        LEFT JOIN rezerwacja r ON z.id = r.idZajec AND r.status = 'aktywna'
-        GROUP BY z.id, z.nazwa, z.trener, z.maksUczestnikow, z.data, z.czas, z.czasTrwania, z.opis
-        HAVING COUNT(r.id) < z.maksUczestnikow
-        ORDER BY z.data, z.czas
-    )")) {
-        qWarning() << "Błąd pobierania dostępnych zajęć:" << query.lastError().text();
-        return zajecia;
+int DatabaseManager::getRezerwacjeCount() {
+    QSqlQuery query = preparedQuery("SELECT COUNT(*) FROM rezerwacja");
+    if (!execWithRetry(query)) {
+        qWarning() << "Błąd liczenia rezerwacji:" << query.lastError().text();
+        return 0;
     }
 
-    while (query.next()) {
-        zajecia.append(queryToZajecia(query));
+    if (query.next()) {
+        int liczba = query.value(0).toInt();
+        query.finish();
+        return liczba;
     }
 
-    return zajecia;
+    return 0;
 }
 
-int DatabaseManager::getRezerwacjeCount() {
-    QSqlQuery query(db);
-    if (!query.exec("SELECT COUNT(*) FROM rezerwacja")) {
-        qWarning() << "Błąd liczenia rezerwacji:" << query.lastError().text();
+int DatabaseManager::getRezerwacjeCount(const FiltrListy& filtr) {
+    QVariantMap parametry;
+    const QString warunek = warunekFiltraRezerwacji(filtr, parametry);
+    if (warunek.isEmpty()) {
+        return getRezerwacjeCount();
+    }
+
+    // Zajęcia dołączamy tylko dla filtra po trenerze - pozostałe kolumny są w rezerwacji
+    QString sql = "SELECT COUNT(*) FROM rezerwacja r ";
+    if (!filtr.trener.isEmpty()) {
+        sql += "JOIN zajecia z ON r.idZajec = z.id ";
+    }
+    QSqlQuery query = preparedQuery(sql + "WHERE " + warunek);
+    for (auto it = parametry.cbegin(); it != parametry.cend(); ++it) {
+        query.bindValue(it.key(), it.value());
+    }
+
+    if (!execWithRetry(query)) {
+        qWarning() << "Błąd liczenia przefiltrowanych rezerwacji:" << query.lastError().text();
         return 0;
     }
 
     if (query.next()) {
-        return query.value(0).toInt();
+        int liczba = query.value(0).toInt();
+        query.finish();
+        return liczba;
     }
 
     return 0;
@@ -722,8 +2607,8 @@ int DatabaseManager::getRezerwacjeCount() {
 
 bool DatabaseManager::addKarnet(int idKlienta,
                                 const QString& typ,
-                                const QString& dataRozpoczecia,
-                                const QString& dataZakonczenia,
+                                const QDate& dataRozpoczecia,
+                                const QDate& dataZakonczenia,
                                 double cena,
                                 bool czyAktywny) {
 
@@ -733,55 +2618,89 @@ bool DatabaseManager::addKarnet(int idKlienta,
         return false;
     }
 
-    QSqlQuery query(db);
-    query.prepare(R"(
+    int noweId = -1;
+    if (!wstawKarnet(idKlienta, typ, dataRozpoczecia, dataZakonczenia, cena, czyAktywny, &noweId)) {
+        return false;
+    }
+
+    qDebug() << "Dodano karnet typu" << typ << "dla klienta ID:" << idKlienta;
+    podbijWersje(TabelaDanych::Karnety);
+    DatabaseNotifier::instance()->zglosZmiane(TabelaDanych::Karnety, noweId, OperacjaZmiany::Dodanie);
+    return true;
+}
+
+bool DatabaseManager::wstawKarnet(int idKlienta,
+                                  const QString& typ,
+                                  const QDate& dataRozpoczecia,
+                                  const QDate& dataZakonczenia,
+                                  double cena,
+                                  bool czyAktywny,
+                                  int* noweId) {
+    QSqlQuery query = preparedQuery(R"(
         INSERT INTO karnet (idKlienta, typ, dataRozpoczecia, dataZakonczenia, cena, czyAktywny)
         VALUES (:idKlienta, :typ, :dataRozpoczecia, :dataZakonczenia, :cena, :czyAktywny)
     )");
 
     query.bindValue(":idKlienta", idKlienta);
     query.bindValue(":typ", typ);
-    query.bindValue(":dataRozpoczecia", dataRozpoczecia);
-    query.bindValue(":dataZakonczenia", dataZakonczenia);
+    query.bindValue(":dataRozpoczecia", dzienDoBazy(dataRozpoczecia));
+    query.bindValue(":dataZakonczenia", dzienDoBazy(dataZakonczenia));
     query.bindValue(":cena", cena);
     query.bindValue(":czyAktywny", czyAktywny ? 1 : 0);
 
-    if (!query.exec()) {
+    if (!execWithRetry(query)) {
         qWarning() << "Błąd dodawania karnetu:" << query.lastError().text();
         return false;
     }
-
-    qDebug() << "Dodano karnet typu" << typ << "dla klienta ID:" << idKlienta;
+    if (noweId) {
+        *noweId = query.lastInsertId().toInt();
+    }
     return true;
 }
 
 QList<Karnet> DatabaseManager::getAllKarnety() {
-    QList<Karnet> karnety;
-
-    QSqlQuery query(db);
-    if (!query.exec(R"(
+    return pobierzListe(R"(
         SELECT k.id, k.idKlienta, k.typ, k.dataRozpoczecia, k.dataZakonczenia, k.cena, k.czyAktywny,
                kl.imie, kl.nazwisko, kl.email
         FROM karnet k
         JOIN klient kl ON k.idKlienta = kl.id
         ORDER BY k.dataRozpoczecia DESC, kl.nazwisko, kl.imie
-    )")) {
-        qWarning() << "Błąd pobierania karnetów:" << query.lastError().text();
-        return karnety;
-    }
+    )", {}, {TabelaDanych::Karnety, TabelaDanych::Klienci},
+        &DatabaseManager::queryToKarnet, "Błąd pobierania karnetów:");
+}
 
-    while (query.next()) {
-        karnety.append(queryToKarnet(query));
-    }
+Strona<Karnet> DatabaseManager::getKarnetyStrona(const QString& token, int limit) {
+    return getKarnetyStrona(FiltrListy(), token, limit);
+}
 
-    return karnety;
+Strona<Karnet> DatabaseManager::getKarnetyStrona(const FiltrListy& filtr, const QString& token, int limit) {
+    // W obrębie jednej daty rozpoczęcia kolejność wg id - sortowanie po nazwisku
+    // z dołączonej tabeli klientów nie dałoby się oprzeć na indeksie karnetów
+    static const ListaStronicowana lista = {
+        "karnety",
+        R"(
+            SELECT k.id, k.idKlienta, k.typ, k.dataRozpoczecia, k.dataZakonczenia, k.cena, k.czyAktywny,
+                   kl.imie, kl.nazwisko, kl.email
+            FROM karnet k
+            JOIN klient kl ON k.idKlienta = kl.id
+            WHERE %1
+        )",
+        {{"COALESCE(k.dataRozpoczecia, -1)", "dataRozpoczecia"}, {"k.id", "id"}},
+        true
+    };
+    QVariantMap parametry;
+    const QString warunek = warunekFiltraKarnetow(filtr, parametry);
+    return pobierzStrone(lista, token, limit, parametry, &DatabaseManager::queryToKarnet, warunek);
 }
 
 Karnet DatabaseManager::getKarnetById(int id) {
     Karnet karnet = {};
+    quint64 generacja = 0;
+    if (cacheKarnetow.pobierz(id, karnet, generacja)) {
+        return karnet;
+    }
 
-    QSqlQuery query(db);
-    query.prepare(R"(
+    QSqlQuery query = preparedQuery(R"(
         SELECT k.id, k.idKlienta, k.typ, k.dataRozpoczecia, k.dataZakonczenia, k.cena, k.czyAktywny,
                kl.imie, kl.nazwisko, kl.email
         FROM karnet k
@@ -790,13 +2709,15 @@ Karnet DatabaseManager::getKarnetById(int id) {
     )");
     query.bindValue(":id", id);
 
-    if (!query.exec()) {
+    if (!execWithRetry(query)) {
         qWarning() << "Błąd pobierania karnetu o ID" << id << ":" << query.lastError().text();
         return karnet;
     }
 
     if (query.next()) {
         karnet = queryToKarnet(query);
+        query.finish();
+        cacheKarnetow.zapisz(id, karnet, generacja);
     }
 
     return karnet;
@@ -805,13 +2726,12 @@ Karnet DatabaseManager::getKarnetById(int id) {
 bool DatabaseManager::updateKarnet(int id,
                                    int idKlienta,
                                    const QString& typ,
-                                   const QString& dataRozpoczecia,
-                                   const QString& dataZakonczenia,
+                                   const QDate& dataRozpoczecia,
+                                   const QDate& dataZakonczenia,
                                    double cena,
                                    bool czyAktywny) {
 
-    QSqlQuery query(db);
-    query.prepare(R"(
+    QSqlQuery query = preparedQuery(R"(
         UPDATE karnet
         SET idKlienta = :idKlienta, typ = :typ, dataRozpoczecia = :dataRozpoczecia,
             dataZakonczenia = :dataZakonczenia, cena = :cena, czyAktywny = :czyAktywny
@@ -821,12 +2741,12 @@ bool DatabaseManager::updateKarnet(int id,
     query.bindValue(":id", id);
     query.bindValue(":idKlienta", idKlienta);
     query.bindValue(":typ", typ);
-    query.bindValue(":dataRozpoczecia", dataRozpoczecia);
-    query.bindValue(":dataZakonczenia", dataZakonczenia);
+    query.bindValue(":dataRozpoczecia", dzienDoBazy(dataRozpoczecia));
+    query.bindValue(":dataZakonczenia", dzienDoBazy(dataZakonczenia));
     query.bindValue(":cena", cena);
     query.bindValue(":czyAktywny", czyAktywny ? 1 : 0);
 
-    if (!query.exec()) {
+    if (!execWithRetry(query)) {
         qWarning() << "Błąd aktualizacji karnetu:" << query.lastError().text();
         return false;
     }
@@ -837,15 +2757,17 @@ bool DatabaseManager::updateKarnet(int id,
     }
 
     qDebug() << "Zaktualizowano karnet o ID:" << id;
+    cacheKarnetow.usun(id);
+    podbijWersje(TabelaDanych::Karnety);
+    DatabaseNotifier::instance()->zglosZmiane(TabelaDanych::Karnety, id, OperacjaZmiany::Zmiana);
     return true;
 }
 
 bool DatabaseManager::deleteKarnet(int id) {
-    QSqlQuery query(db);
-    query.prepare("DELETE FROM karnet WHERE id = :id");
+    QSqlQuery query = preparedQuery("DELETE FROM karnet WHERE id = :id");
     query.bindValue(":id", id);
 
-    if (!query.exec()) {
+    if (!execWithRetry(query)) {
         qWarning() << "Błąd usuwania karnetu:" << query.lastError().text();
         return false;
     }
@@ -856,200 +2778,160 @@ bool DatabaseManager::deleteKarnet(int id) {
     }
 
     qDebug() << "Usunięto karnet o ID:" << id;
+    cacheKarnetow.usun(id);
+    podbijWersje(TabelaDanych::Karnety);
+    DatabaseNotifier::instance()->zglosZmiane(TabelaDanych::Karnety, id, OperacjaZmiany::Usuniecie);
     return true;
 }
 
 // === Pomocnicze metody dla karnetów ===
 
 QList<Karnet> DatabaseManager::getKarnetyKlienta(int idKlienta) {
-    QList<Karnet> karnety;
-
-    QSqlQuery query(db);
-    query.prepare(R"(
+    return pobierzListe(R"(
         SELECT k.id, k.idKlienta, k.typ, k.dataRozpoczecia, k.dataZakonczenia, k.cena, k.czyAktywny,
                kl.imie, kl.nazwisko, kl.email
         FROM karnet k
         JOIN klient kl ON k.idKlienta = kl.id
         WHERE k.idKlienta = :idKlienta
         ORDER BY k.dataRozpoczecia DESC
-    )");
-    query.bindValue(":idKlienta", idKlienta);
-
-    if (!query.exec()) {
-        qWarning() << "Błąd pobierania karnetów klienta:" << query.lastError().text();
-        return karnety;
-    }
-
-    while (query.next()) {
-        karnety.append(queryToKarnet(query));
-    }
-
-    return karnety;
+    )", {{":idKlienta", idKlienta}}, {TabelaDanych::Karnety, TabelaDanych::Klienci},
+        &DatabaseManager::queryToKarnet, "Błąd pobierania karnetów klienta:");
 }
 
 QList<Karnet> DatabaseManager::getAktywneKarnetyKlienta(int idKlienta) {
-    QList<Karnet> karnety;
-
-    QSqlQuery query(db);
-    query.prepare(R"(
+    return pobierzListe(R"(
         SELECT k.id, k.idKlienta, k.typ, k.dataRozpoczecia, k.dataZakonczenia, k.cena, k.czyAktywny,
                kl.imie, kl.nazwisko, kl.email
         FROM karnet k
         JOIN klient kl ON k.idKlienta = kl.id
         WHERE k.idKlienta = :idKlienta AND k.czyAktywny = 1
         ORDER BY k.dataRozpoczecia DESC
-    )");
-    query.bindValue(":idKlienta", idKlienta);
-
-    if (!query.exec()) {
-        qWarning() << "Błąd pobierania aktywnych karnetów klienta:" << query.lastError().text();
-        return karnety;
-    }
-
-    while (query.next()) {
-        karnety.append(queryToKarnet(query));
-    }
-
-    return karnety;
+    )", {{":idKlienta", idKlienta}}, {TabelaDanych::Karnety, TabelaDanych::Klienci},
+        &DatabaseManager::queryToKarnet, "Błąd pobierania aktywnych karnetów klienta:");
 }
 
 bool DatabaseManager::klientMaAktywnyKarnet(int idKlienta) {
-    QSqlQuery query(db);
-    query.prepare("SELECT COUNT(*) FROM karnet WHERE idKlienta = :idKlienta AND czyAktywny = 1");
+    QSqlQuery query = preparedQuery("SELECT COUNT(*) FROM karnet WHERE idKlienta = :idKlienta AND czyAktywny = 1");
     query.bindValue(":idKlienta", idKlienta);
 
-    if (!query.exec() || !query.next()) {
+    if (!execWithRetry(query) || !query.next()) {
         qWarning() << "Błąd sprawdzania aktywnych karnetów klienta:" << query.lastError().text();
         return false;
     }
 
-    return query.value(0).toInt() > 0;
+    bool istnieje = query.value(0).toInt() > 0;
+    query.finish();
+    return istnieje;
 }
 
 QList<Karnet> DatabaseManager::getKarnetyByTyp(const QString& typ) {
-    QList<Karnet> karnety;
-
-    QSqlQuery query(db);
-    query.prepare(R"(
+    return pobierzListe(R"(
         SELECT k.id, k.idKlienta, k.typ, k.dataRozpoczecia, k.dataZakonczenia, k.cena, k.czyAktywny,
                kl.imie, kl.nazwisko, kl.email
         FROM karnet k
         JOIN klient kl ON k.idKlienta = kl.id
         WHERE k.typ = :typ
         ORDER BY k.dataRozpoczecia DESC, kl.nazwisko, kl.imie
-    )");
-    query.bindValue(":typ", typ);
-
-    if (!query.exec()) {
-        qWarning() << "Błąd pobierania karnetów po typie:" << query.lastError().text();
-        return karnety;
-    }
-
-    while (query.next()) {
-        karnety.append(queryToKarnet(query));
-    }
-
-    return karnety;
+    )", {{":typ", typ}}, {TabelaDanych::Karnety, TabelaDanych::Klienci},
+        &DatabaseManager::queryToKarnet, "Błąd pobierania karnetów po typie:");
 }
 
 QList<Karnet> DatabaseManager::getKarnetyByStatus(bool czyAktywny) {
-    QList<Karnet> karnety;
-
-    QSqlQuery query(db);
-    query.prepare(R"(
+    return pobierzListe(R"(
         SELECT k.id, k.idKlienta, k.typ, k.dataRozpoczecia, k.dataZakonczenia, k.cena, k.czyAktywny,
                kl.imie, kl.nazwisko, kl.email
         FROM karnet k
         JOIN klient kl ON k.idKlienta = kl.id
         WHERE k.czyAktywny = :czyAktywny
         ORDER BY k.dataRozpoczecia DESC, kl.nazwisko, kl.imie
-    )");
-    query.bindValue(":czyAktywny", czyAktywny ? 1 : 0);
-
-    if (!query.exec()) {
-        qWarning() << "Błąd pobierania karnetów po statusie:" << query.lastError().text();
-        return karnety;
-    }
-
-    while (query.next()) {
-        karnety.append(queryToKarnet(query));
-    }
-
-    return karnety;
+    )", {{":czyAktywny", czyAktywny ? 1 : 0}}, {TabelaDanych::Karnety, TabelaDanych::Klienci},
+        &DatabaseManager::queryToKarnet, "Błąd pobierania karnetów po statusie:");
 }
 
-QList<Karnet> DatabaseManager::getKarnetyWygasajace(const QString& dataOd, const QString& dataDo) {
-    QList<Karnet> karnety;
-
-    QSqlQuery query(db);
-    query.prepare(R"(
+QList<Karnet> DatabaseManager::getKarnetyWygasajace(const QDate& dataOd, const QDate& dataDo) {
+    return pobierzListe(R"(
         SELECT k.id, k.idKlienta, k.typ, k.dataRozpoczecia, k.dataZakonczenia, k.cena, k.czyAktywny,
                kl.imie, kl.nazwisko, kl.email
         FROM karnet k
         JOIN klient kl ON k.idKlienta = kl.id
         WHERE k.dataZakonczenia BETWEEN :dataOd AND :dataDo AND k.czyAktywny = 1
         ORDER BY k.dataZakonczenia ASC, kl.nazwisko, kl.imie
-    )");
-    query.bindValue(":dataOd", dataOd);
-    query.bindValue(":dataDo", dataDo);
+    )", {{":dataOd", dzienDoBazy(dataOd)}, {":dataDo", dzienDoBazy(dataDo)}}, {TabelaDanych::Karnety, TabelaDanych::Klienci},
+        &DatabaseManager::queryToKarnet, "Błąd pobierania wygasających karnetów:");
+}
 
-    if (!query.exec()) {
-        qWarning() << "Błąd pobierania wygasających karnetów:" << query.lastError().text();
-        return karnety;
+int DatabaseManager::getKarnetyCount() {
+    QSqlQuery query = preparedQuery("SELECT COUNT(*) FROM karnet");
+    if (!execWithRetry(query)) {
+        qWarning() << "Błąd liczenia karnetów:" << query.lastError().text();
+        return 0;
     }
 
-    while (query.next()) {
-        karnety.append(queryToKarnet(query));
+    if (query.next()) {
+        int liczba = query.value(0).toInt();
+        query.finish();
+        return liczba;
     }
 
-    return karnety;
+    return 0;
 }
 
-int DatabaseManager::getKarnetyCount() {
-    QSqlQuery query(db);
-    if (!query.exec("SELECT COUNT(*) FROM karnet")) {
-        qWarning() << "Błąd liczenia karnetów:" << query.lastError().text();
+int DatabaseManager::getKarnetyCount(const FiltrListy& filtr) {
+    QVariantMap parametry;
+    const QString warunek = warunekFiltraKarnetow(filtr, parametry);
+    if (warunek.isEmpty()) {
+        return getKarnetyCount();
+    }
+
+    QSqlQuery query = preparedQuery("SELECT COUNT(*) FROM karnet k WHERE " + warunek);
+    for (auto it = parametry.cbegin(); it != parametry.cend(); ++it) {
+        query.bindValue(it.key(), it.value());
+    }
+
+    if (!execWithRetry(query)) {
+        qWarning() << "Błąd liczenia przefiltrowanych karnetów:" << query.lastError().text();
         return 0;
     }
 
     if (query.next()) {
-        return query.value(0).toInt();
+        int liczba = query.value(0).toInt();
+        query.finish();
+        return liczba;
     }
 
     return 0;
 }
 
 bool DatabaseManager::moznaUtworzycKarnet(int idKlienta, const QString& typ) {
-    QSqlQuery query(db);
-    query.prepare("SELECT COUNT(*) FROM karnet WHERE idKlienta = :idKlienta AND typ = :typ AND czyAktywny = 1");
+    QSqlQuery query = preparedQuery("SELECT COUNT(*) FROM karnet WHERE idKlienta = :idKlienta AND typ = :typ AND czyAktywny = 1");
     query.bindValue(":idKlienta", idKlienta);
     query.bindValue(":typ", typ);
 
-    if (!query.exec() || !query.next()) {
+    if (!execWithRetry(query) || !query.next()) {
         qWarning() << "Błąd sprawdzania możliwości utworzenia karnetu:" << query.lastError().text();
         return false;
     }
 
-    return query.value(0).toInt() == 0; // Można utworzyć jeśli nie ma aktywnych karnetów tego typu
+    bool mozna = query.value(0).toInt() == 0; // Można utworzyć jeśli nie ma aktywnych karnetów tego typu
+    query.finish();
+    return mozna;
 }
 
 // === Metody raportowe ===
+// Czytają agregaty utrzymywane triggerami (migracja 9) - koszt nie rośnie z liczbą rezerwacji i karnetów
 
 QList<QPair<QString, int>> DatabaseManager::getNajpopularniejszeZajecia(int limit) {
     QList<QPair<QString, int>> wyniki;
 
-    QSqlQuery query(db);
-    query.prepare(R"(
-        SELECT z.nazwa, COUNT(r.id) as liczba_rezerwacji
-        FROM zajecia z
-        LEFT JOIN rezerwacja r ON z.id = r.idZajec AND r.status = 'aktywna'
-        GROUP BY z.id, z.nazwa
-        ORDER BY liczba_rezerwacji DESC, z.nazwa
+    QSqlQuery query = preparedQuery(R"(
+        SELECT nazwa, aktualneRezerwacje as liczba_rezerwacji
+        FROM zajecia
+        ORDER BY aktualneRezerwacje DESC, nazwa
         LIMIT :limit
     )");
     query.bindValue(":limit", limit);
 
-    if (!query.exec()) {
+    if (!execWithRetry(query)) {
         qWarning() << "Błąd pobierania najpopularniejszych zajęć:" << query.lastError().text();
         return wyniki;
     }
@@ -1066,18 +2948,15 @@ QList<QPair<QString, int>> DatabaseManager::getNajpopularniejszeZajecia(int limi
 QList<QPair<QString, int>> DatabaseManager::getNajaktywniejszychKlientow(int limit) {
     QList<QPair<QString, int>> wyniki;
 
-    QSqlQuery query(db);
-    query.prepare(R"(
-        SELECT k.imie || ' ' || k.nazwisko as pelne_imie, COUNT(r.id) as liczba_rezerwacji
-        FROM klient k
-        LEFT JOIN rezerwacja r ON k.id = r.idKlienta AND r.status = 'aktywna'
-        GROUP BY k.id, k.imie, k.nazwisko
-        ORDER BY liczba_rezerwacji DESC, k.nazwisko, k.imie
+    QSqlQuery query = preparedQuery(R"(
+        SELECT imie || ' ' || nazwisko as pelne_imie, aktywneRezerwacje as liczba_rezerwacji
+        FROM klient
+        ORDER BY aktywneRezerwacje DESC, nazwisko, imie
         LIMIT :limit
     )");
     query.bindValue(":limit", limit);
 
-    if (!query.exec()) {
+    if (!execWithRetry(query)) {
         qWarning() << "Błąd pobierania najaktywniejszych klientów:" << query.lastError().text();
         return wyniki;
     }
@@ -1094,14 +2973,13 @@ QList<QPair<QString, int>> DatabaseManager::getNajaktywniejszychKlientow(int lim
 QList<QPair<QString, int>> DatabaseManager::getStatystykiKarnetow() {
     QList<QPair<QString, int>> wyniki;
 
-    QSqlQuery query(db);
-    if (!query.exec(R"(
-        SELECT typ, COUNT(*) as liczba
-        FROM karnet
-        WHERE czyAktywny = 1
-        GROUP BY typ
+    QSqlQuery query = preparedQuery(R"(
+        SELECT typ, aktywne as liczba
+        FROM statystyka_karnetow
+        WHERE aktywne > 0
         ORDER BY liczba DESC
-    )")) {
+    )");
+    if (!execWithRetry(query)) {
         qWarning() << "Błąd pobierania statystyk karnetów:" << query.lastError().text();
         return wyniki;
     }
@@ -1116,31 +2994,223 @@ QList<QPair<QString, int>> DatabaseManager::getStatystykiKarnetow() {
 }
 
 double DatabaseManager::getCalkowitePrzychodyZKarnetow() {
-    QSqlQuery query(db);
-    if (!query.exec("SELECT SUM(cena) FROM karnet WHERE czyAktywny = 1")) {
+    QSqlQuery query = preparedQuery("SELECT SUM(przychodGrosze) FROM statystyka_karnetow");
+    if (!execWithRetry(query)) {
         qWarning() << "Błąd liczenia przychodów z karnetów:" << query.lastError().text();
         return 0.0;
     }
 
     if (query.next()) {
-        return query.value(0).toDouble();
+        double suma = query.value(0).toLongLong() / 100.0;
+        query.finish();
+        return suma;
+    }
+
+    return 0.0;
+}
+
+int DatabaseManager::getLiczbaAktywnychKarnetow() {
+    QSqlQuery query = preparedQuery("SELECT SUM(aktywne) FROM statystyka_karnetow");
+    if (!execWithRetry(query)) {
+        qWarning() << "Błąd liczenia aktywnych karnetów:" << query.lastError().text();
+        return 0;
+    }
+
+    if (query.next()) {
+        int liczba = query.value(0).toInt();
+        query.finish();
+        return liczba;
+    }
+
+    return 0;
+}
+
+QList<PrzychodOkresu> DatabaseManager::getPrzychodyKarnetow(const QDate& dataOd, const QDate& dataDo, OkresRaportu okres) {
+    QList<PrzychodOkresu> wyniki;
+    if (!dataOd.isValid() || !dataDo.isValid() || dataOd > dataDo) {
+        return wyniki;
+    }
+
+    // Zakres w kluczu głównym przychod_dzienny - tyle wierszy, ile dni razy typów w przedziale
+    QSqlQuery query = preparedQuery(R"(
+        SELECT dzien, typ, liczba, przychodGrosze
+        FROM przychod_dzienny
+        WHERE dzien BETWEEN :dzienOd AND :dzienDo AND liczba > 0
+        ORDER BY dzien, typ
+    )");
+    query.bindValue(":dzienOd", dzienDoBazy(dataOd));
+    query.bindValue(":dzienDo", dzienDoBazy(dataDo));
+
+    if (!execWithRetry(query)) {
+        qWarning() << "Błąd pobierania przychodów z karnetów:" << query.lastError().text();
+        return wyniki;
+    }
+
+    // Dni przychodzą po kolei, więc wpisy jednego okresu leżą na końcu listy - typ
+    // szukamy tylko wśród nich. Grosze sumowane osobno, na złote zamieniane na końcu.
+    int pierwszyWOkresie = 0;
+    QList<qint64> grosze;
+    while (query.next()) {
+        const QDate dzien = dzienZBazy(query.value("dzien"));
+        QDate poczatek = dzien;
+        QDate koniec = dzien;
+        if (okres == OkresRaportu::Tydzien) {
+            poczatek = dzien.addDays(1 - dzien.dayOfWeek());
+            koniec = poczatek.addDays(6);
+        } else if (okres == OkresRaportu::Miesiac) {
+            poczatek = QDate(dzien.year(), dzien.month(), 1);
+            koniec = poczatek.addMonths(1).addDays(-1);
+        }
+        // Okres na brzegu przedziału obejmuje tylko jego dni
+        poczatek = qMax(poczatek, dataOd);
+        koniec = qMin(koniec, dataDo);
+        if (wyniki.isEmpty() || wyniki.last().poczatek != poczatek) {
+            pierwszyWOkresie = static_cast<int>(wyniki.size());
+        }
+
+        const QString typ = query.value("typ").toString();
+        int i = pierwszyWOkresie;
+        while (i < wyniki.size() && wyniki.at(i).typ != typ) {
+            ++i;
+        }
+        if (i == wyniki.size()) {
+            wyniki.append({poczatek, koniec, typ, 0, 0.0});
+            grosze.append(0);
+        }
+        wyniki[i].liczbaKarnetow += query.value("liczba").toInt();
+        grosze[i] += query.value("przychodGrosze").toLongLong();
+    }
+    query.finish();
+
+    for (int i = 0; i < wyniki.size(); ++i) {
+        wyniki[i].przychod = grosze.at(i) / 100.0;
+    }
+    // W obrębie okresu typy są w kolejności pierwszego wystąpienia - porządkujemy po nazwie
+    std::stable_sort(wyniki.begin(), wyniki.end(), [](const PrzychodOkresu& a, const PrzychodOkresu& b) {
+        return a.poczatek < b.poczatek || (a.poczatek == b.poczatek && a.typ < b.typ);
+    });
+    return wyniki;
+}
+
+MapaOblozenia DatabaseManager::getMapaOblozenia(const QDate& dataOd,
+                                                const QDate& dataDo,
+                                                const QString& nazwa,
+                                                const QString& trener) {
+    MapaOblozenia mapa;
+    if (!dataOd.isValid() || !dataDo.isValid() || dataOd > dataDo) {
+        return mapa;
+    }
+
+    QStringList warunki = {"data BETWEEN :dzienOd AND :dzienDo", "czas IS NOT NULL"};
+    if (!nazwa.isEmpty()) {
+        warunki << "nazwa = :nazwa";
+    }
+    if (!trener.isEmpty()) {
+        warunki << "trener = :trener";
+    }
+
+    // Jeden przebieg po zakresie dat w indeksie; aktywne rezerwacje z licznika utrzymywanego
+    // triggerami, bez złączenia z rezerwacja. Dzień 0 (1970-01-01) to czwartek, stąd + 3.
+    QSqlQuery query = preparedQuery(QString(R"(
+        SELECT ((data + 3) % 7 + 7) % 7 AS dzienTygodnia, czas / 60 AS godzina,
+               COUNT(*) AS zajecia, SUM(aktualneRezerwacje) AS rezerwacje, SUM(maksUczestnikow) AS miejsca
+        FROM zajecia
+        WHERE %1
+        GROUP BY dzienTygodnia, godzina
+    )").arg(warunki.join(" AND ")));
+    query.bindValue(":dzienOd", dzienDoBazy(dataOd));
+    query.bindValue(":dzienDo", dzienDoBazy(dataDo));
+    if (!nazwa.isEmpty()) {
+        query.bindValue(":nazwa", nazwa);
+    }
+    if (!trener.isEmpty()) {
+        query.bindValue(":trener", trener);
+    }
+
+    if (!execWithRetry(query)) {
+        qWarning() << "Błąd liczenia obłożenia zajęć:" << query.lastError().text();
+        return mapa;
+    }
+
+    while (query.next()) {
+        const int dzienTygodnia = query.value("dzienTygodnia").toInt();
+        const int godzina = query.value("godzina").toInt();
+        if (godzina < 0 || godzina > 23) {
+            continue;
+        }
+        KomorkaOblozenia& komorka = mapa.komorki[dzienTygodnia][godzina];
+        komorka.zajecia = query.value("zajecia").toInt();
+        komorka.rezerwacje = query.value("rezerwacje").toInt();
+        komorka.miejsca = query.value("miejsca").toInt();
+    }
+    query.finish();
+
+    return mapa;
+}
+
+QStringList DatabaseManager::getNazwyZajec() {
+    QStringList nazwy;
+    QSqlQuery query = preparedQuery("SELECT DISTINCT nazwa FROM zajecia WHERE nazwa <> ''");
+
+    if (!execWithRetry(query)) {
+        qWarning() << "Błąd pobierania nazw zajęć:" << query.lastError().text();
+        return nazwy;
+    }
+    while (query.next()) {
+        nazwy << query.value(0).toString();
+    }
+    query.finish();
+    return nazwy;
+}
+
+QStringList DatabaseManager::getTrenerzyZajec() {
+    QStringList trenerzy;
+    QSqlQuery query = preparedQuery("SELECT DISTINCT trener FROM zajecia WHERE trener <> ''");
+
+    if (!execWithRetry(query)) {
+        qWarning() << "Błąd pobierania trenerów zajęć:" << query.lastError().text();
+        return trenerzy;
+    }
+    while (query.next()) {
+        trenerzy << query.value(0).toString();
+    }
+    query.finish();
+    return trenerzy;
+}
+
+// === Słownik napisów wyników ===
+
+QString SlownikNapisow::wspolny(const QString& tekst) {
+    if (tekst.isEmpty()) {
+        return QString();
+    }
+    auto it = napisy.constFind(tekst);
+    if (it == napisy.cend()) {
+        it = napisy.insert(tekst);
     }
+    return *it;
+}
 
-    return 0.0;
+void SlownikNapisow::wspoldziel(Rezerwacja& rezerwacja) {
+    rezerwacja.imieKlienta = wspolny(rezerwacja.imieKlienta);
+    rezerwacja.nazwiskoKlienta = wspolny(rezerwacja.nazwiskoKlienta);
+    rezerwacja.nazwaZajec = wspolny(rezerwacja.nazwaZajec);
+    rezerwacja.trenerZajec = wspolny(rezerwacja.trenerZajec);
 }
 
-int DatabaseManager::getLiczbaAktywnychKarnetow() {
-    QSqlQuery query(db);
-    if (!query.exec("SELECT COUNT(*) FROM karnet WHERE czyAktywny = 1")) {
-        qWarning() << "Błąd liczenia aktywnych karnetów:" << query.lastError().text();
-        return 0;
-    }
+void SlownikNapisow::wspoldziel(Karnet& karnet) {
+    karnet.typ = wspolny(karnet.typ);
+    karnet.imieKlienta = wspolny(karnet.imieKlienta);
+    karnet.nazwiskoKlienta = wspolny(karnet.nazwiskoKlienta);
+    karnet.emailKlienta = wspolny(karnet.emailKlienta);
+}
 
-    if (query.next()) {
-        return query.value(0).toInt();
-    }
+int SlownikNapisow::rozmiar() const {
+    return static_cast<int>(napisy.size());
+}
 
-    return 0;
+void SlownikNapisow::wyczysc() {
+    napisy.clear();
 }
 
 // === Metody pomocnicze ===
@@ -1164,10 +3234,11 @@ Zajecia DatabaseManager::queryToZajecia(QSqlQuery& query) {
     zajecia.nazwa = query.value("nazwa").toString();
     zajecia.trener = query.value("trener").toString();
     zajecia.maksUczestnikow = query.value("maksUczestnikow").toInt();
-    zajecia.data = query.value("data").toString();
-    zajecia.czas = query.value("czas").toString();
+    zajecia.data = dzienZBazy(query.value("data"));
+    zajecia.czas = minutaZBazy(query.value("czas"));
     zajecia.czasTrwania = query.value("czasTrwania").toInt();
     zajecia.opis = query.value("opis").toString();
+    zajecia.aktualneRezerwacje = query.value("aktualneRezerwacje").toInt();
     return zajecia;
 }
 
@@ -1176,16 +3247,16 @@ Rezerwacja DatabaseManager::queryToRezerwacja(QSqlQuery& query) {
     rezerwacja.id = query.value("id").toInt();
     rezerwacja.idKlienta = query.value("idKlienta").toInt();
     rezerwacja.idZajec = query.value("idZajec").toInt();
-    rezerwacja.dataRezerwacji = query.value("dataRezerwacji").toString();
-    rezerwacja.status = query.value("status").toString();
+    rezerwacja.dataRezerwacji = chwilaZBazy(query.value("dataRezerwacji"));
+    rezerwacja.status = static_cast<StatusRezerwacji>(query.value("status").toInt());
 
     // Informacje z joinów
     rezerwacja.imieKlienta = query.value("imie").toString();
     rezerwacja.nazwiskoKlienta = query.value("nazwisko").toString();
     rezerwacja.nazwaZajec = query.value("nazwa").toString();
     rezerwacja.trenerZajec = query.value("trener").toString();
-    rezerwacja.dataZajec = query.value("data").toString();
-    rezerwacja.czasZajec = query.value("czas").toString();
+    rezerwacja.dataZajec = dzienZBazy(query.value("data"));
+    rezerwacja.czasZajec = minutaZBazy(query.value("czas"));
 
     return rezerwacja;
 }
@@ -1195,8 +3266,8 @@ Karnet DatabaseManager::queryToKarnet(QSqlQuery& query) {
     karnet.id = query.value("id").toInt();
     karnet.idKlienta = query.value("idKlienta").toInt();
     karnet.typ = query.value("typ").toString();
-    karnet.dataRozpoczecia = query.value("dataRozpoczecia").toString();
-    karnet.dataZakonczenia = query.value("dataZakonczenia").toString();
+    karnet.dataRozpoczecia = dzienZBazy(query.value("dataRozpoczecia"));
+    karnet.dataZakonczenia = dzienZBazy(query.value("dataZakonczenia"));
     karnet.cena = query.value("cena").toDouble();
     karnet.czyAktywny = query.value("czyAktywny").toInt() == 1;
 
@@ -1210,152 +3281,145 @@ Karnet DatabaseManager::queryToKarnet(QSqlQuery& query) {
 
 // === FUNKCJE EKSPORTU CSV ===
 
-bool DatabaseManager::exportKlienciToCSV(const QString& filePath) {
-    QFile file(filePath);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        qWarning() << "Nie można otworzyć pliku do zapisu:" << filePath;
-        return false;
-    }
-
-    QTextStream stream(&file);
-    stream.setCodec("UTF-8");
-
-    // Nagłówek CSV
-    QStringList headers = {"ID", "Imie", "Nazwisko", "Email", "Telefon", "DataUrodzenia", "DataRejestracji", "Uwagi"};
-    stream << formatCSVHeader(headers) << "\n";
+namespace {
+const int ROZMIAR_BUFORA_EKSPORTU = 64 * 1024;
+} // namespace
 
-    // Dane
-    QList<Klient> klienci = getAllKlienci();
-    for (const Klient& k : klienci) {
-        QStringList row;
-        row << QString::number(k.id)
-            << k.imie
-            << k.nazwisko
-            << k.email
-            << k.telefon
-            << k.dataUrodzenia
-            << k.dataRejestracji
-            << k.uwagi;
-
-        stream << formatCSVRow(row) << "\n";
-    }
+double StatystykiEksportu::wierszeNaSekunde() const {
+    return czasMs > 0 ? wiersze * 1000.0 / czasMs : 0.0;
+}
 
-    file.close();
-    qDebug() << "Wyeksportowano" << klienci.size() << "klientów do:" << filePath;
-    return true;
+double StatystykiEksportu::megabajtyNaSekunde() const {
+    return czasMs > 0 ? (bajty / (1024.0 * 1024.0)) * 1000.0 / czasMs : 0.0;
 }
 
-bool DatabaseManager::exportZajeciaToCSV(const QString& filePath) {
+bool DatabaseManager::eksportujZapytanie(const QString& filePath,
+                                         const QStringList& headers,
+                                         const QString& sql,
+                                         StatystykiEksportu* statystyki) {
+    QElapsedTimer timer;
+    timer.start();
+
     QFile file(filePath);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
         qWarning() << "Nie można otworzyć pliku do zapisu:" << filePath;
         return false;
     }
 
-    QTextStream stream(&file);
-    stream.setCodec("UTF-8");
+    // Kursor tylko do przodu - w pamięci jest najwyżej jeden wiersz wyniku i bufor zapisu
+    QSqlQuery query = preparedQuery(sql);
+    if (!execWithRetry(query)) {
+        qWarning() << "Błąd odczytu danych do eksportu:" << query.lastError().text();
+        return false;
+    }
 
-    // Nagłówek CSV
-    QStringList headers = {"ID", "Nazwa", "Trener", "MaksUczestnikow", "Data", "Czas", "CzasTrwania", "Opis"};
-    stream << formatCSVHeader(headers) << "\n";
+    QByteArray bufor;
+    bufor.reserve(ROZMIAR_BUFORA_EKSPORTU + 4096);
+    bufor.append(formatCSVHeader(headers).toUtf8());
+    bufor.append('\n');
 
-    // Dane
-    QList<Zajecia> zajecia = getAllZajecia();
-    for (const Zajecia& z : zajecia) {
-        QStringList row;
-        row << QString::number(z.id)
-            << z.nazwa
-            << z.trener
-            << QString::number(z.maksUczestnikow)
-            << z.data
-            << z.czas
-            << QString::number(z.czasTrwania)
-            << z.opis;
+    qint64 wiersze = 0;
+    qint64 bajty = 0;
+    const int kolumny = headers.size();
 
-        stream << formatCSVRow(row) << "\n";
-    }
+    auto zapiszBufor = [&]() {
+        if (file.write(bufor) != bufor.size()) {
+            return false;
+        }
+        bajty += bufor.size();
+        bufor.clear();   // clear() zachowuje zarezerwowaną pamięć
+        return true;
+    };
 
-    file.close();
-    qDebug() << "Wyeksportowano" << zajecia.size() << "zajęć do:" << filePath;
-    return true;
-}
+    while (query.next()) {
+        for (int i = 0; i < kolumny; ++i) {
+            if (i > 0) {
+                bufor.append(',');
+            }
+            // Liczby i daty formatuje już SQL - tutaj tylko tekst i NULL jako puste pole
+            const QVariant wartosc = query.value(i);
+            if (!wartosc.isNull()) {
+                escapeCSVField(wartosc.toString().toUtf8(), bufor);
+            }
+        }
+        bufor.append('\n');
+        ++wiersze;
 
-bool DatabaseManager::exportRezerwacjeToCSV(const QString& filePath) {
-    QFile file(filePath);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        qWarning() << "Nie można otworzyć pliku do zapisu:" << filePath;
-        return false;
+        if (bufor.size() >= ROZMIAR_BUFORA_EKSPORTU && !zapiszBufor()) {
+            qWarning() << "Błąd zapisu do pliku:" << filePath << file.errorString();
+            return false;
+        }
     }
+    query.finish();
 
-    QTextStream stream(&file);
-    stream.setCodec("UTF-8");
+    if (!zapiszBufor()) {
+        qWarning() << "Błąd zapisu do pliku:" << filePath << file.errorString();
+        return false;
+    }
+    file.close();
 
-    // Nagłówek CSV
-    QStringList headers = {"ID", "IdKlienta", "IdZajec", "ImieKlienta", "NazwiskoKlienta",
-                           "NazwaZajec", "TrenerZajec", "DataZajec", "CzasZajec",
-                           "DataRezerwacji", "Status"};
-    stream << formatCSVHeader(headers) << "\n";
+    StatystykiEksportu wynik;
+    wynik.wiersze = wiersze;
+    wynik.bajty = bajty;
+    wynik.czasMs = timer.elapsed();
 
-    // Dane
-    QList<Rezerwacja> rezerwacje = getAllRezerwacje();
-    for (const Rezerwacja& r : rezerwacje) {
-        QStringList row;
-        row << QString::number(r.id)
-            << QString::number(r.idKlienta)
-            << QString::number(r.idZajec)
-            << r.imieKlienta
-            << r.nazwiskoKlienta
-            << r.nazwaZajec
-            << r.trenerZajec
-            << r.dataZajec
-            << r.czasZajec
-            << r.dataRezerwacji
-            << r.status;
+    qDebug() << "Wyeksportowano" << wiersze << "wierszy do:" << filePath
+             << QString("(%1 wierszy/s, %2 MB/s)")
+                    .arg(wynik.wierszeNaSekunde(), 0, 'f', 0)
+                    .arg(wynik.megabajtyNaSekunde(), 0, 'f', 2);
 
-        stream << formatCSVRow(row) << "\n";
+    if (statystyki) {
+        *statystyki = wynik;
     }
-
-    file.close();
-    qDebug() << "Wyeksportowano" << rezerwacje.size() << "rezerwacji do:" << filePath;
     return true;
 }
 
-bool DatabaseManager::exportKarnetyToCSV(const QString& filePath) {
-    QFile file(filePath);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        qWarning() << "Nie można otworzyć pliku do zapisu:" << filePath;
-        return false;
-    }
-
-    QTextStream stream(&file);
-    stream.setCodec("UTF-8");
-
-    // Nagłówek CSV
-    QStringList headers = {"ID", "IdKlienta", "ImieKlienta", "NazwiskoKlienta", "EmailKlienta",
-                           "Typ", "DataRozpoczecia", "DataZakonczenia", "Cena", "CzyAktywny"};
-    stream << formatCSVHeader(headers) << "\n";
+bool DatabaseManager::exportKlienciToCSV(const QString& filePath, StatystykiEksportu* statystyki) {
+    return eksportujZapytanie(filePath,
+                              {"ID", "Imie", "Nazwisko", "Email", "Telefon", "DataUrodzenia", "DataRejestracji", "Uwagi"},
+                              "SELECT id, imie, nazwisko, email, telefon, dataUrodzenia, dataRejestracji, uwagi "
+                              "FROM klient ORDER BY nazwisko, imie",
+                              statystyki);
+}
 
-    // Dane
-    QList<Karnet> karnety = getAllKarnety();
-    for (const Karnet& k : karnety) {
-        QStringList row;
-        row << QString::number(k.id)
-            << QString::number(k.idKlienta)
-            << k.imieKlienta
-            << k.nazwiskoKlienta
-            << k.emailKlienta
-            << k.typ
-            << k.dataRozpoczecia
-            << k.dataZakonczenia
-            << QString::number(k.cena, 'f', 2)
-            << (k.czyAktywny ? "1" : "0");
+bool DatabaseManager::exportZajeciaToCSV(const QString& filePath, StatystykiEksportu* statystyki) {
+    return eksportujZapytanie(filePath,
+                              {"ID", "Nazwa", "Trener", "MaksUczestnikow", "Data", "Czas", "CzasTrwania", "Opis"},
+                              QString("SELECT id, nazwa, trener, maksUczestnikow, %1, %2, czasTrwania, opis "
+                                      "FROM zajecia ORDER BY data, czas, nazwa")
+                                  .arg(sqlDzienJakoTekst("data"), sqlMinutaJakoTekst("czas")),
+                              statystyki);
+}
 
-        stream << formatCSVRow(row) << "\n";
-    }
+bool DatabaseManager::exportRezerwacjeToCSV(const QString& filePath, StatystykiEksportu* statystyki) {
+    return eksportujZapytanie(filePath,
+                              {"ID", "IdKlienta", "IdZajec", "ImieKlienta", "NazwiskoKlienta",
+                               "NazwaZajec", "TrenerZajec", "DataZajec", "CzasZajec",
+                               "DataRezerwacji", "Status"},
+                              QString(R"(
+        SELECT r.id, r.idKlienta, r.idZajec, k.imie, k.nazwisko,
+               z.nazwa, z.trener, %1, %2,
+               %3, CASE r.status WHEN 0 THEN 'aktywna' WHEN 1 THEN 'anulowana' END
+        FROM rezerwacja r
+        JOIN klient k ON r.idKlienta = k.id
+        JOIN zajecia z ON r.idZajec = z.id
+        ORDER BY r.dataRezerwacji DESC
+    )").arg(sqlDzienJakoTekst("z.data"), sqlMinutaJakoTekst("z.czas"), sqlChwilaJakoTekst("r.dataRezerwacji")),
+                              statystyki);
+}
 
-    file.close();
-    qDebug() << "Wyeksportowano" << karnety.size() << "karnetów do:" << filePath;
-    return true;
+bool DatabaseManager::exportKarnetyToCSV(const QString& filePath, StatystykiEksportu* statystyki) {
+    return eksportujZapytanie(filePath,
+                              {"ID", "IdKlienta", "ImieKlienta", "NazwiskoKlienta", "EmailKlienta",
+                               "Typ", "DataRozpoczecia", "DataZakonczenia", "Cena", "CzyAktywny"},
+                              QString(R"(
+        SELECT k.id, k.idKlienta, kl.imie, kl.nazwisko, kl.email,
+               k.typ, %1, %2, printf('%.2f', k.cena), k.czyAktywny
+        FROM karnet k
+        JOIN klient kl ON k.idKlienta = kl.id
+        ORDER BY k.dataRozpoczecia DESC, kl.nazwisko, kl.imie
+    )").arg(sqlDzienJakoTekst("k.dataRozpoczecia"), sqlDzienJakoTekst("k.dataZakonczenia")),
+                              statystyki);
 }
 
 bool DatabaseManager::exportAllToCSV(const QString& dirPath) {
@@ -1384,327 +3448,515 @@ bool DatabaseManager::exportAllToCSV(const QString& dirPath) {
 
 // === FUNKCJE IMPORTU CSV ===
 
-QPair<int, QStringList> DatabaseManager::importKlienciFromCSV(const QString& filePath) {
-    QFile file(filePath);
-    QStringList errors;
-    int importedCount = 0;
+namespace {
+QAtomicInt rozmiarPartiiImportu(500);
 
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        errors << "Nie można otworzyć pliku: " + filePath;
-        return qMakePair(0, errors);
+// Klucz z kilku pól do zbiorów sprawdzających duplikaty (separator jak char(31) w SQL)
+QString kluczImportu(const QStringList& pola) {
+    return pola.join(QChar(0x1f));
+}
+
+// Konwersje pól CSV wprost z widoków czytnika - liczby, daty i statusy bez kopii do QString.
+// Wszystkie oczekują pola po trimmed().
+
+// Liczba zapisana samymi cyframi (część daty albo godziny); -1 gdy są inne znaki
+int cyfryPola(QByteArrayView cyfry) {
+    int wynik = 0;
+    for (char znak : cyfry) {
+        if (znak < '0' || znak > '9') {
+            return -1;
+        }
+        wynik = wynik * 10 + (znak - '0');
     }
+    return wynik;
+}
 
-    QTextStream stream(&file);
-    stream.setCodec("UTF-8");
+// Data w formacie yyyy-MM-dd; błędna daje QDate z isValid() == false
+QDate dataZPola(QByteArrayView pole) {
+    if (pole.size() != 10 || pole[4] != '-' || pole[7] != '-') {
+        return QDate();
+    }
+    const int rok = cyfryPola(pole.sliced(0, 4));
+    const int miesiac = cyfryPola(pole.sliced(5, 2));
+    const int dzien = cyfryPola(pole.sliced(8, 2));
+    if (rok < 0 || miesiac < 0 || dzien < 0) {
+        return QDate();
+    }
+    return QDate(rok, miesiac, dzien);
+}
 
-    // Pomiń nagłówek
-    if (!stream.atEnd()) {
-        stream.readLine();
+// Godzina w formacie HH:mm; błędna daje QTime z isValid() == false
+QTime godzinaZPola(QByteArrayView pole) {
+    if (pole.size() != 5 || pole[2] != ':') {
+        return QTime();
+    }
+    const int godzina = cyfryPola(pole.sliced(0, 2));
+    const int minuta = cyfryPola(pole.sliced(3, 2));
+    if (godzina < 0 || minuta < 0) {
+        return QTime();
     }
+    return QTime(godzina, minuta);
+}
+
+// Te same nazwy co DatabaseManager::statusRezerwacjiZNazwy
+std::optional<StatusRezerwacji> statusZPola(QByteArrayView pole) {
+    const QLatin1String tekst(pole.data(), pole.size());
+    if (tekst.compare(QLatin1String("aktywna"), Qt::CaseInsensitive) == 0) {
+        return StatusRezerwacji::Aktywna;
+    }
+    if (tekst.compare(QLatin1String("anulowana"), Qt::CaseInsensitive) == 0) {
+        return StatusRezerwacji::Anulowana;
+    }
+    return std::nullopt;
+}
+} // namespace
 
-    int lineNumber = 1;
-    while (!stream.atEnd()) {
-        lineNumber++;
-        QString line = stream.readLine().trimmed();
-        if (line.isEmpty()) continue;
+void DatabaseManager::setImportBatchSize(int rozmiar) {
+    rozmiarPartiiImportu.storeRelaxed(qMax(1, rozmiar));
+}
 
-        QStringList fields = parseCSVLine(line);
-        if (fields.size() < 7) {  // Minimalna liczba pól (bez uwag)
-            errors << QString("Linia %1: Za mało pól (%2, oczekiwano minimum 7)").arg(lineNumber).arg(fields.size());
-            continue;
+int DatabaseManager::importBatchSize() {
+    return rozmiarPartiiImportu.loadRelaxed();
+}
+
+// Wiersze importu trafiają do bazy w transakcjach po importBatchSize() wierszy.
+// Każdy wiersz ma własny SAVEPOINT, więc błąd jednego wiersza nie wycofuje całej partii.
+class DatabaseManager::PartiaImportu {
+public:
+    explicit PartiaImportu(QStringList& errors)
+        : errors(errors), rozmiarPartii(importBatchSize()) {}
+
+    ~PartiaImportu() {
+        zakoncz();
+    }
+
+    bool rozpocznijWiersz(int lineNumber) {
+        if (!otwarta) {
+            if (!beginWriteTransaction()) {
+                return false;
+            }
+            otwarta = true;
+            pierwszaLinia = lineNumber;
         }
+        return wykonaj("SAVEPOINT wiersz_importu");
+    }
 
-        QString errorMsg;
-        if (!validateKlientCSVRow(fields, errorMsg)) {
-            errors << QString("Linia %1: %2").arg(lineNumber).arg(errorMsg);
-            continue;
+    void zakonczWiersz(bool ok, int lineNumber) {
+        if (ok) {
+            ++wstawioneWPartii;
+        } else {
+            // ROLLBACK TO nie zdejmuje savepointu ze stosu - RELEASE poniżej robi to w obu przypadkach
+            wykonaj("ROLLBACK TO SAVEPOINT wiersz_importu");
         }
+        wykonaj("RELEASE SAVEPOINT wiersz_importu");
 
-        // Pola: ID, Imie, Nazwisko, Email, Telefon, DataUrodzenia, DataRejestracji, Uwagi
-        QString imie = fields[1].trimmed();
-        QString nazwisko = fields[2].trimmed();
-        QString email = fields[3].trimmed();
-        QString telefon = fields[4].trimmed();
-        QString dataUrodzenia = fields[5].trimmed();
-        QString uwagi = fields.size() > 7 ? fields[7].trimmed() : "";
-
-        // Sprawdź czy email już istnieje (jeśli nie jest pusty)
-        if (!email.isEmpty() && emailExists(email)) {
-            errors << QString("Linia %1: Email %2 już istnieje w bazie").arg(lineNumber).arg(email);
-            continue;
+        ostatniaLinia = lineNumber;
+        if (++wierszeWPartii >= rozmiarPartii) {
+            zatwierdz();
         }
+    }
 
-        if (addKlient(imie, nazwisko, email, telefon, dataUrodzenia, uwagi)) {
-            importedCount++;
-        } else {
-            errors << QString("Linia %1: Błąd dodawania klienta do bazy").arg(lineNumber);
+    bool zakoncz() {
+        return !otwarta || zatwierdz();
+    }
+
+    int zaimportowane() const {
+        return zatwierdzone;
+    }
+
+private:
+    bool wykonaj(const QString& sql) {
+        QSqlQuery query = preparedQuery(sql);
+        if (!execWithRetry(query)) {
+            qWarning() << "Błąd polecenia importu" << sql << ":" << query.lastError().text();
+            return false;
         }
+        return true;
     }
 
-    file.close();
-    qDebug() << "Zaimportowano" << importedCount << "klientów z" << (lineNumber - 1) << "wierszy";
-    return qMakePair(importedCount, errors);
-}
+    bool zatwierdz() {
+        const int wstawione = wstawioneWPartii;
+        otwarta = false;
+        wierszeWPartii = 0;
+        wstawioneWPartii = 0;
 
-QPair<int, QStringList> DatabaseManager::importZajeciaFromCSV(const QString& filePath) {
-    QFile file(filePath);
-    QStringList errors;
-    int importedCount = 0;
+        if (!commitTransaction()) {
+            rollbackTransaction();
+            errors << QString("Linie %1-%2: Błąd zatwierdzania partii, wiersze nie zostały zapisane")
+                          .arg(pierwszaLinia).arg(ostatniaLinia);
+            return false;
+        }
 
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        errors << "Nie można otworzyć pliku: " + filePath;
-        return qMakePair(0, errors);
+        zatwierdzone += wstawione;
+        return true;
     }
 
-    QTextStream stream(&file);
-    stream.setCodec("UTF-8");
+    QStringList& errors;
+    int rozmiarPartii;
+    bool otwarta = false;
+    int wierszeWPartii = 0;
+    int wstawioneWPartii = 0;
+    int zatwierdzone = 0;
+    int pierwszaLinia = 0;
+    int ostatniaLinia = 0;
+};
 
-    // Pomiń nagłówek
-    if (!stream.atEnd()) {
-        stream.readLine();
+QSet<QString> DatabaseManager::wczytajKlucze(const QString& sql) {
+    QSet<QString> klucze;
+
+    QSqlQuery query = preparedQuery(sql);
+    if (!execWithRetry(query)) {
+        qWarning() << "Błąd wczytywania kluczy do importu:" << query.lastError().text();
+        return klucze;
     }
 
-    int lineNumber = 1;
-    while (!stream.atEnd()) {
-        lineNumber++;
-        QString line = stream.readLine().trimmed();
-        if (line.isEmpty()) continue;
+    while (query.next()) {
+        klucze.insert(query.value(0).toString());
+    }
+    return klucze;
+}
 
-        QStringList fields = parseCSVLine(line);
-        if (fields.size() < 7) {  // Minimalna liczba pól (bez opisu)
-            errors << QString("Linia %1: Za mało pól (%2, oczekiwano minimum 7)").arg(lineNumber).arg(fields.size());
-            continue;
-        }
+QSet<int> DatabaseManager::wczytajIdentyfikatory(const QString& sql) {
+    QSet<int> identyfikatory;
 
-        QString errorMsg;
-        if (!validateZajeciaCSVRow(fields, errorMsg)) {
-            errors << QString("Linia %1: %2").arg(lineNumber).arg(errorMsg);
-            continue;
-        }
+    QSqlQuery query = preparedQuery(sql);
+    if (!execWithRetry(query)) {
+        qWarning() << "Błąd wczytywania identyfikatorów do importu:" << query.lastError().text();
+        return identyfikatory;
+    }
 
-        // Pola: ID, Nazwa, Trener, MaksUczestnikow, Data, Czas, CzasTrwania, Opis
-        QString nazwa = fields[1].trimmed();
-        QString trener = fields[2].trimmed();
-        int maksUczestnikow = fields[3].toInt();
-        QString data = fields[4].trimmed();
-        QString czas = fields[5].trimmed();
-        int czasTrwania = fields[6].toInt();
-        QString opis = fields.size() > 7 ? fields[7].trimmed() : "";
-
-        // Sprawdź czy zajęcia już istnieją
-        if (!data.isEmpty() && !czas.isEmpty() && zajeciaExist(nazwa, data, czas)) {
-            errors << QString("Linia %1: Zajęcia '%2' już istnieją w tym terminie").arg(lineNumber).arg(nazwa);
-            continue;
+    while (query.next()) {
+        identyfikatory.insert(query.value(0).toInt());
+    }
+    return identyfikatory;
+}
+
+bool DatabaseManager::sprawdzWierszCSV(RodzajImportu rodzaj, const CsvRow& row, WierszImportu& wiersz, QString& errorMsg) {
+    const int liczbaPol = row.fieldCount();
+    switch (rodzaj) {
+    case RodzajImportu::Klienci:
+        if (liczbaPol < 7) {  // Minimalna liczba pól (bez uwag)
+            errorMsg = QString("Za mało pól (%1, oczekiwano minimum 7)").arg(liczbaPol);
+            return false;
+        }
+        return validateKlientCSVRow(row, wiersz.klient, errorMsg);
+    case RodzajImportu::Zajecia:
+        if (liczbaPol < 7) {  // Minimalna liczba pól (bez opisu)
+            errorMsg = QString("Za mało pól (%1, oczekiwano minimum 7)").arg(liczbaPol);
+            return false;
+        }
+        return validateZajeciaCSVRow(row, wiersz.zajecia, errorMsg);
+    case RodzajImportu::Rezerwacje:
+        if (liczbaPol < 11) {
+            errorMsg = QString("Za mało pól (%1, oczekiwano 11)").arg(liczbaPol);
+            return false;
+        }
+        return validateRezerwacjaCSVRow(row, wiersz.rezerwacja, errorMsg);
+    case RodzajImportu::Karnety:
+        if (liczbaPol < 10) {
+            errorMsg = QString("Za mało pól (%1, oczekiwano 10)").arg(liczbaPol);
+            return false;
         }
+        return validateKarnetCSVRow(row, wiersz.karnet, errorMsg);
+    }
+    return false;
+}
 
-        if (addZajecia(nazwa, trener, maksUczestnikow, data, czas, czasTrwania, opis)) {
-            importedCount++;
-        } else {
-            errors << QString("Linia %1: Błąd dodawania zajęć do bazy").arg(lineNumber);
+QString DatabaseManager::nazwaRodzajuImportu(RodzajImportu rodzaj) {
+    switch (rodzaj) {
+    case RodzajImportu::Klienci:    return "klientów";
+    case RodzajImportu::Zajecia:    return "zajęć";
+    case RodzajImportu::Rezerwacje: return "rezerwacji";
+    case RodzajImportu::Karnety:    return "karnetów";
+    }
+    return QString();
+}
+
+DatabaseManager::ZapisImportu::ZapisImportu(RodzajImportu rodzaj, QStringList& errors)
+    : rodzaj(rodzaj),
+      errors(errors),
+      profilImportu(ProfilBazy::ImportMasowy),  // bez fsync w połączeniu importu, reszta bez zmian
+      partia(new PartiaImportu(errors)) {
+    // Duplikaty sprawdzane w pamięci zamiast zapytania na każdy wiersz
+    switch (rodzaj) {
+    case RodzajImportu::Klienci:
+        klucze = wczytajKlucze("SELECT email FROM klient WHERE email IS NOT NULL");
+        break;
+    case RodzajImportu::Zajecia:
+        klucze = wczytajKlucze(
+            "SELECT nazwa || char(31) || data || char(31) || czas FROM zajecia WHERE data IS NOT NULL AND czas IS NOT NULL");
+        break;
+    case RodzajImportu::Rezerwacje:
+        // Limit miejsc i duplikaty sprawdza wstawRezerwacje w tym samym poleceniu co INSERT
+        klienci = wczytajIdentyfikatory("SELECT id FROM klient");
+        zajecia = wczytajIdentyfikatory("SELECT id FROM zajecia");
+        break;
+    case RodzajImportu::Karnety:
+        klienci = wczytajIdentyfikatory("SELECT id FROM klient");
+        klucze = wczytajKlucze("SELECT idKlienta || char(31) || typ FROM karnet WHERE czyAktywny = 1");
+        break;
+    }
+}
+
+DatabaseManager::ZapisImportu::~ZapisImportu() = default;
+
+bool DatabaseManager::ZapisImportu::zakoncz() {
+    const bool ok = partia->zakoncz();
+
+    // Import zmienia zbyt wiele wierszy na pojedyncze powiadomienia - widoki przeładowują listę
+    if (partia->zaimportowane() > 0) {
+        DatabaseNotifier* powiadomienia = DatabaseNotifier::instance();
+        switch (rodzaj) {
+        case RodzajImportu::Klienci:
+            cacheKlientow.wyczysc();
+            podbijWersje(TabelaDanych::Klienci);
+            powiadomienia->zglosPrzeladowanie(TabelaDanych::Klienci);
+            break;
+        case RodzajImportu::Zajecia:
+            cacheZajec.wyczysc();
+            podbijWersje(TabelaDanych::Zajecia);
+            powiadomienia->zglosPrzeladowanie(TabelaDanych::Zajecia);
+            break;
+        case RodzajImportu::Rezerwacje:
+            // Triggery zmieniły też liczniki aktywnych rezerwacji zajęć
+            cacheZajec.wyczysc();
+            podbijWersje(TabelaDanych::Rezerwacje);
+            powiadomienia->zglosPrzeladowanie(TabelaDanych::Rezerwacje);
+            powiadomienia->zglosPrzeladowanie(TabelaDanych::Zajecia);
+            break;
+        case RodzajImportu::Karnety:
+            cacheKarnetow.wyczysc();
+            podbijWersje(TabelaDanych::Karnety);
+            powiadomienia->zglosPrzeladowanie(TabelaDanych::Karnety);
+            break;
         }
     }
+    return ok;
+}
 
-    file.close();
-    qDebug() << "Zaimportowano" << importedCount << "zajęć z" << (lineNumber - 1) << "wierszy";
-    return qMakePair(importedCount, errors);
+int DatabaseManager::ZapisImportu::zaimportowane() const {
+    return partia->zaimportowane();
 }
 
-QPair<int, QStringList> DatabaseManager::importRezerwacjeFromCSV(const QString& filePath) {
-    QFile file(filePath);
-    QStringList errors;
-    int importedCount = 0;
+bool DatabaseManager::ZapisImportu::zapisz(int lineNumber, const WierszImportu& wiersz) {
+    switch (rodzaj) {
+    case RodzajImportu::Klienci:    return zapiszKlienta(lineNumber, wiersz.klient);
+    case RodzajImportu::Zajecia:    return zapiszZajecia(lineNumber, wiersz.zajecia);
+    case RodzajImportu::Rezerwacje: return zapiszRezerwacje(lineNumber, wiersz.rezerwacja);
+    case RodzajImportu::Karnety:    return zapiszKarnet(lineNumber, wiersz.karnet);
+    }
+    return false;
+}
 
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        errors << "Nie można otworzyć pliku: " + filePath;
-        return qMakePair(0, errors);
+bool DatabaseManager::ZapisImportu::zapiszKlienta(int lineNumber, const Klient& klient) {
+    const QString& email = klient.email;
+
+    // Sprawdź czy email już istnieje (jeśli nie jest pusty) - także wśród wierszy tego pliku
+    if (!email.isEmpty() && klucze.contains(email)) {
+        errors << QString("Linia %1: Email %2 już istnieje w bazie").arg(lineNumber).arg(email);
+        return false;
+    }
+
+    if (!partia->rozpocznijWiersz(lineNumber)) {
+        errors << QString("Linia %1: Błąd dodawania klienta do bazy").arg(lineNumber);
+        return false;
     }
 
-    QTextStream stream(&file);
-    stream.setCodec("UTF-8");
+    bool ok = wstawKlienta(klient.imie, klient.nazwisko, email, klient.telefon, klient.dataUrodzenia, klient.uwagi);
+    partia->zakonczWiersz(ok, lineNumber);
 
-    // Pomiń nagłówek
-    if (!stream.atEnd()) {
-        stream.readLine();
+    if (!ok) {
+        errors << QString("Linia %1: Błąd dodawania klienta do bazy").arg(lineNumber);
+        return false;
     }
+    if (!email.isEmpty()) {
+        klucze.insert(email);
+    }
+    return true;
+}
 
-    int lineNumber = 1;
-    while (!stream.atEnd()) {
-        lineNumber++;
-        QString line = stream.readLine().trimmed();
-        if (line.isEmpty()) continue;
+bool DatabaseManager::ZapisImportu::zapiszZajecia(int lineNumber, const Zajecia& nowe) {
+    const QString& nazwa = nowe.nazwa;
+    const QDate& data = nowe.data;
+    const QTime& czas = nowe.czas;
 
-        QStringList fields = parseCSVLine(line);
-        if (fields.size() < 11) {
-            errors << QString("Linia %1: Za mało pól (%2, oczekiwano 11)").arg(lineNumber).arg(fields.size());
-            continue;
-        }
+    // Sprawdź czy zajęcia już istnieją (klucz z liczb zapisanych w bazie, jak w wczytajKlucze)
+    const QString termin = kluczImportu({nazwa, dzienDoBazy(data).toString(), minutaDoBazy(czas).toString()});
+    const bool maTermin = data.isValid() && czas.isValid();
+    if (maTermin && klucze.contains(termin)) {
+        errors << QString("Linia %1: Zajęcia '%2' już istnieją w tym terminie").arg(lineNumber).arg(nazwa);
+        return false;
+    }
 
-        QString errorMsg;
-        if (!validateRezerwacjaCSVRow(fields, errorMsg)) {
-            errors << QString("Linia %1: %2").arg(lineNumber).arg(errorMsg);
-            continue;
-        }
+    if (!partia->rozpocznijWiersz(lineNumber)) {
+        errors << QString("Linia %1: Błąd dodawania zajęć do bazy").arg(lineNumber);
+        return false;
+    }
 
-        // Pola: ID, IdKlienta, IdZajec, ImieKlienta, NazwiskoKlienta, NazwaZajec, TrenerZajec, DataZajec, CzasZajec, DataRezerwacji, Status
-        int idKlienta = fields[1].toInt();
-        int idZajec = fields[2].toInt();
-        QString status = fields[10].trimmed();
+    bool ok = wstawZajecia(nazwa, nowe.trener, nowe.maksUczestnikow, data, czas, nowe.czasTrwania, nowe.opis);
+    partia->zakonczWiersz(ok, lineNumber);
 
-        // Sprawdź czy klient i zajęcia istnieją
-        Klient klient = getKlientById(idKlienta);
-        if (klient.id <= 0) {
-            errors << QString("Linia %1: Nie znaleziono klienta o ID %2").arg(lineNumber).arg(idKlienta);
-            continue;
-        }
+    if (!ok) {
+        errors << QString("Linia %1: Błąd dodawania zajęć do bazy").arg(lineNumber);
+        return false;
+    }
+    if (maTermin) {
+        klucze.insert(termin);
+    }
+    return true;
+}
 
-        Zajecia zajecia = getZajeciaById(idZajec);
-        if (zajecia.id <= 0) {
-            errors << QString("Linia %1: Nie znaleziono zajęć o ID %2").arg(lineNumber).arg(idZajec);
-            continue;
-        }
+bool DatabaseManager::ZapisImportu::zapiszRezerwacje(int lineNumber, const Rezerwacja& rezerwacja) {
+    const int idKlienta = rezerwacja.idKlienta;
+    const int idZajec = rezerwacja.idZajec;
 
-        // Sprawdź czy klient już ma rezerwację na te zajęcia (tylko dla aktywnych)
-        if (status == "aktywna" && klientMaRezerwacje(idKlienta, idZajec)) {
-            errors << QString("Linia %1: Klient już ma aktywną rezerwację na te zajęcia").arg(lineNumber);
-            continue;
-        }
+    // Sprawdź czy klient i zajęcia istnieją
+    if (!klienci.contains(idKlienta)) {
+        errors << QString("Linia %1: Nie znaleziono klienta o ID %2").arg(lineNumber).arg(idKlienta);
+        return false;
+    }
 
-        if (addRezerwacja(idKlienta, idZajec, status)) {
-            importedCount++;
-        } else {
-            errors << QString("Linia %1: Błąd dodawania rezerwacji do bazy").arg(lineNumber);
-        }
+    if (!zajecia.contains(idZajec)) {
+        errors << QString("Linia %1: Nie znaleziono zajęć o ID %2").arg(lineNumber).arg(idZajec);
+        return false;
     }
 
-    file.close();
-    qDebug() << "Zaimportowano" << importedCount << "rezerwacji z" << (lineNumber - 1) << "wierszy";
-    return qMakePair(importedCount, errors);
+    if (!partia->rozpocznijWiersz(lineNumber)) {
+        errors << QString("Linia %1: Błąd dodawania rezerwacji do bazy").arg(lineNumber);
+        return false;
+    }
+
+    WynikRezerwacji wynik = wstawRezerwacje(idKlienta, idZajec, rezerwacja.status);
+    partia->zakonczWiersz(wynik == WynikRezerwacji::Ok, lineNumber);
+
+    switch (wynik) {
+    case WynikRezerwacji::Ok:
+        return true;
+    case WynikRezerwacji::Duplikat:
+        errors << QString("Linia %1: Klient już ma aktywną rezerwację na te zajęcia").arg(lineNumber);
+        break;
+    case WynikRezerwacji::BrakMiejsc:
+        errors << QString("Linia %1: Brak wolnych miejsc na zajęciach o ID %2").arg(lineNumber).arg(idZajec);
+        break;
+    case WynikRezerwacji::NieznaneZajecia:
+        errors << QString("Linia %1: Nie znaleziono zajęć o ID %2").arg(lineNumber).arg(idZajec);
+        break;
+    case WynikRezerwacji::Blad:
+        errors << QString("Linia %1: Błąd dodawania rezerwacji do bazy").arg(lineNumber);
+        break;
+    }
+    return false;
 }
 
-QPair<int, QStringList> DatabaseManager::importKarnetyFromCSV(const QString& filePath) {
-    QFile file(filePath);
+bool DatabaseManager::ZapisImportu::zapiszKarnet(int lineNumber, const Karnet& karnet) {
+    const int idKlienta = karnet.idKlienta;
+    const QString& typ = karnet.typ;
+    const bool czyAktywny = karnet.czyAktywny;
+
+    // Sprawdź czy klient istnieje
+    if (!klienci.contains(idKlienta)) {
+        errors << QString("Linia %1: Nie znaleziono klienta o ID %2").arg(lineNumber).arg(idKlienta);
+        return false;
+    }
+
+    // Sprawdź czy można utworzyć karnet (tylko dla aktywnych)
+    const QString karnetKlienta = kluczImportu({QString::number(idKlienta), typ});
+    if (czyAktywny && klucze.contains(karnetKlienta)) {
+        errors << QString("Linia %1: Klient już ma aktywny karnet typu '%2'").arg(lineNumber).arg(typ);
+        return false;
+    }
+
+    if (!partia->rozpocznijWiersz(lineNumber)) {
+        errors << QString("Linia %1: Błąd dodawania karnetu do bazy").arg(lineNumber);
+        return false;
+    }
+
+    bool ok = wstawKarnet(idKlienta, typ, karnet.dataRozpoczecia, karnet.dataZakonczenia, karnet.cena, czyAktywny);
+    partia->zakonczWiersz(ok, lineNumber);
+
+    if (!ok) {
+        errors << QString("Linia %1: Błąd dodawania karnetu do bazy").arg(lineNumber);
+        return false;
+    }
+    if (czyAktywny) {
+        klucze.insert(karnetKlienta);
+    }
+    return true;
+}
+
+QPair<int, QStringList> DatabaseManager::importujCSV(RodzajImportu rodzaj, const QString& filePath) {
+    CsvReader reader;
     QStringList errors;
-    int importedCount = 0;
 
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    if (!reader.open(filePath)) {
         errors << "Nie można otworzyć pliku: " + filePath;
         return qMakePair(0, errors);
     }
 
-    QTextStream stream(&file);
-    stream.setCodec("UTF-8");
+    ZapisImportu zapis(rodzaj, errors);
 
     // Pomiń nagłówek
-    if (!stream.atEnd()) {
-        stream.readLine();
-    }
-
-    int lineNumber = 1;
-    while (!stream.atEnd()) {
-        lineNumber++;
-        QString line = stream.readLine().trimmed();
-        if (line.isEmpty()) continue;
+    reader.readRow();
 
-        QStringList fields = parseCSVLine(line);
-        if (fields.size() < 10) {
-            errors << QString("Linia %1: Za mało pól (%2, oczekiwano 10)").arg(lineNumber).arg(fields.size());
-            continue;
-        }
+    int rowCount = 0;
+    while (reader.readRow()) {
+        const int lineNumber = reader.lineNumber();
+        rowCount++;
 
+        WierszImportu wiersz;
         QString errorMsg;
-        if (!validateKarnetCSVRow(fields, errorMsg)) {
+        if (!sprawdzWierszCSV(rodzaj, reader.row(), wiersz, errorMsg)) {
             errors << QString("Linia %1: %2").arg(lineNumber).arg(errorMsg);
             continue;
         }
 
-        // Pola: ID, IdKlienta, ImieKlienta, NazwiskoKlienta, EmailKlienta, Typ, DataRozpoczecia, DataZakonczenia, Cena, CzyAktywny
-        int idKlienta = fields[1].toInt();
-        QString typ = fields[5].trimmed();
-        QString dataRozpoczecia = fields[6].trimmed();
-        QString dataZakonczenia = fields[7].trimmed();
-        double cena = fields[8].toDouble();
-        bool czyAktywny = (fields[9].trimmed() == "1");
-
-        // Sprawdź czy klient istnieje
-        Klient klient = getKlientById(idKlienta);
-        if (klient.id <= 0) {
-            errors << QString("Linia %1: Nie znaleziono klienta o ID %2").arg(lineNumber).arg(idKlienta);
-            continue;
-        }
+        zapis.zapisz(lineNumber, wiersz);
+    }
 
-        // Sprawdź czy można utworzyć karnet (tylko dla aktywnych)
-        if (czyAktywny && !moznaUtworzycKarnet(idKlienta, typ)) {
-            errors << QString("Linia %1: Klient już ma aktywny karnet typu '%2'").arg(lineNumber).arg(typ);
-            continue;
-        }
+    zapis.zakoncz();
+    qDebug() << "Zaimportowano" << zapis.zaimportowane() << nazwaRodzajuImportu(rodzaj) << "z" << rowCount << "wierszy";
+    return qMakePair(zapis.zaimportowane(), errors);
+}
 
-        if (addKarnet(idKlienta, typ, dataRozpoczecia, dataZakonczenia, cena, czyAktywny)) {
-            importedCount++;
-        } else {
-            errors << QString("Linia %1: Błąd dodawania karnetu do bazy").arg(lineNumber);
-        }
-    }
+QPair<int, QStringList> DatabaseManager::importKlienciFromCSV(const QString& filePath) {
+    return importujCSV(RodzajImportu::Klienci, filePath);
+}
 
-    file.close();
-    qDebug() << "Zaimportowano" << importedCount << "karnetów z" << (lineNumber - 1) << "wierszy";
-    return qMakePair(importedCount, errors);
+QPair<int, QStringList> DatabaseManager::importZajeciaFromCSV(const QString& filePath) {
+    return importujCSV(RodzajImportu::Zajecia, filePath);
+}
+
+QPair<int, QStringList> DatabaseManager::importRezerwacjeFromCSV(const QString& filePath) {
+    return importujCSV(RodzajImportu::Rezerwacje, filePath);
+}
+
+QPair<int, QStringList> DatabaseManager::importKarnetyFromCSV(const QString& filePath) {
+    return importujCSV(RodzajImportu::Karnety, filePath);
 }
 
 // === FUNKCJE POMOCNICZE CSV ===
 
 QString DatabaseManager::escapeCSVField(const QString& field) {
-    QString escaped = field;
+    QByteArray escaped;
+    escapeCSVField(field.toUtf8(), escaped);
+    return QString::fromUtf8(escaped);
+}
 
+void DatabaseManager::escapeCSVField(const QByteArray& field, QByteArray& bufor) {
     // Jeśli pole zawiera przecinek, cudzysłów lub znak nowej linii, owiń w cudzysłowy
-    if (escaped.contains(',') || escaped.contains('"') || escaped.contains('\n') || escaped.contains('\r')) {
-        // Podwój cudzysłowy wewnętrzne
-        escaped.replace('"', "\"\"");
-        // Owiń w cudzysłowy
-        escaped = "\"" + escaped + "\"";
-    }
-
-    return escaped;
-}
-
-QStringList DatabaseManager::parseCSVLine(const QString& line) {
-    QStringList result;
-    QString currentField;
-    bool inQuotes = false;
-    bool quoteNext = false;
-
-    for (int i = 0; i < line.length(); i++) {
-        QChar c = line[i];
-
-        if (quoteNext) {
-            currentField += c;
-            quoteNext = false;
-        } else if (c == '"') {
-            if (inQuotes) {
-                if (i + 1 < line.length() && line[i + 1] == '"') {
-                    // Podwójny cudzysłów - dodaj jeden
-                    currentField += '"';
-                    quoteNext = true;
-                } else {
-                    // Koniec pola w cudzysłowach
-                    inQuotes = false;
-                }
-            } else {
-                // Początek pola w cudzysłowach
-                inQuotes = true;
+    if (field.contains(',') || field.contains('"') || field.contains('\n') || field.contains('\r')) {
+        bufor.append('"');
+        for (char znak : field) {
+            // Podwój cudzysłowy wewnętrzne
+            if (znak == '"') {
+                bufor.append('"');
             }
-        } else if (c == ',' && !inQuotes) {
-            // Separator pól
-            result << currentField;
-            currentField.clear();
-        } else {
-            currentField += c;
+            bufor.append(znak);
         }
+        bufor.append('"');
+    } else {
+        bufor.append(field);
     }
-
-    // Dodaj ostatnie pole
-    result << currentField;
-
-    return result;
 }
 
 QString DatabaseManager::formatCSVHeader(const QStringList& headers) {
@@ -1715,191 +3967,192 @@ QString DatabaseManager::formatCSVHeader(const QStringList& headers) {
     return escapedHeaders.join(",");
 }
 
-QString DatabaseManager::formatCSVRow(const QStringList& values) {
-    QStringList escapedValues;
-    for (const QString& value : values) {
-        escapedValues << escapeCSVField(value);
-    }
-    return escapedValues.join(",");
-}
-
 // === FUNKCJE WALIDACJI CSV ===
 
-bool DatabaseManager::validateKlientCSVRow(const QStringList& row, QString& errorMsg) {
-    if (row.size() < 7) {
+bool DatabaseManager::validateKlientCSVRow(const CsvRow& row, Klient& klient, QString& errorMsg) {
+    // Pola: ID, Imie, Nazwisko, Email, Telefon, DataUrodzenia, DataRejestracji, Uwagi
+    if (row.fieldCount() < 7) {
         errorMsg = "Za mało kolumn";
         return false;
     }
 
     // Walidacja imienia
-    if (row[1].trimmed().isEmpty()) {
+    if (row.fieldView(1).trimmed().isEmpty()) {
         errorMsg = "Imię nie może być puste";
         return false;
     }
 
     // Walidacja nazwiska
-    if (row[2].trimmed().isEmpty()) {
+    if (row.fieldView(2).trimmed().isEmpty()) {
         errorMsg = "Nazwisko nie może być puste";
         return false;
     }
 
     // Walidacja emaila (jeśli nie jest pusty)
-    QString email = row[3].trimmed();
-    if (!email.isEmpty() && !email.contains("@")) {
+    QByteArrayView email = row.fieldView(3).trimmed();
+    if (!email.isEmpty() && !email.contains('@')) {
         errorMsg = "Nieprawidłowy format emaila";
         return false;
     }
 
     // Walidacja daty urodzenia (jeśli nie jest pusta)
-    QString dataUrodzenia = row[5].trimmed();
-    if (!dataUrodzenia.isEmpty()) {
-        QDate data = QDate::fromString(dataUrodzenia, "yyyy-MM-dd");
-        if (!data.isValid()) {
-            errorMsg = "Nieprawidłowy format daty urodzenia (oczekiwano yyyy-MM-dd)";
-            return false;
-        }
+    QByteArrayView dataUrodzenia = row.fieldView(5).trimmed();
+    if (!dataUrodzenia.isEmpty() && !dataZPola(dataUrodzenia).isValid()) {
+        errorMsg = "Nieprawidłowy format daty urodzenia (oczekiwano yyyy-MM-dd)";
+        return false;
     }
 
+    // Do QString tylko pola zapisywane w bazie
+    klient.imie = row.field(1).trimmed();
+    klient.nazwisko = row.field(2).trimmed();
+    klient.email = row.field(3).trimmed();
+    klient.telefon = row.field(4).trimmed();
+    klient.dataUrodzenia = QString::fromLatin1(dataUrodzenia);
+    klient.uwagi = row.fieldCount() > 7 ? row.field(7).trimmed() : QString();
     return true;
 }
 
-bool DatabaseManager::validateZajeciaCSVRow(const QStringList& row, QString& errorMsg) {
-    if (row.size() < 7) {
+bool DatabaseManager::validateZajeciaCSVRow(const CsvRow& row, Zajecia& zajecia, QString& errorMsg) {
+    // Pola: ID, Nazwa, Trener, MaksUczestnikow, Data, Czas, CzasTrwania, Opis
+    if (row.fieldCount() < 7) {
         errorMsg = "Za mało kolumn";
         return false;
     }
 
     // Walidacja nazwy
-    if (row[1].trimmed().isEmpty()) {
+    if (row.fieldView(1).trimmed().isEmpty()) {
         errorMsg = "Nazwa zajęć nie może być pusta";
         return false;
     }
 
     // Walidacja maksymalnej liczby uczestników
     bool ok;
-    int maksUczestnikow = row[3].toInt(&ok);
-    if (!ok || maksUczestnikow <= 0) {
+    zajecia.maksUczestnikow = row.fieldView(3).trimmed().toInt(&ok);
+    if (!ok || zajecia.maksUczestnikow <= 0) {
         errorMsg = "Nieprawidłowa maksymalna liczba uczestników";
         return false;
     }
 
     // Walidacja daty (jeśli nie jest pusta)
-    QString data = row[4].trimmed();
-    if (!data.isEmpty()) {
-        QDate dataObj = QDate::fromString(data, "yyyy-MM-dd");
-        if (!dataObj.isValid()) {
-            errorMsg = "Nieprawidłowy format daty (oczekiwano yyyy-MM-dd)";
-            return false;
-        }
+    QByteArrayView data = row.fieldView(4).trimmed();
+    zajecia.data = dataZPola(data);
+    if (!data.isEmpty() && !zajecia.data.isValid()) {
+        errorMsg = "Nieprawidłowy format daty (oczekiwano yyyy-MM-dd)";
+        return false;
     }
 
     // Walidacja czasu (jeśli nie jest pusty)
-    QString czas = row[5].trimmed();
-    if (!czas.isEmpty()) {
-        QTime czasObj = QTime::fromString(czas, "HH:mm");
-        if (!czasObj.isValid()) {
-            errorMsg = "Nieprawidłowy format czasu (oczekiwano HH:mm)";
-            return false;
-        }
+    QByteArrayView czas = row.fieldView(5).trimmed();
+    zajecia.czas = godzinaZPola(czas);
+    if (!czas.isEmpty() && !zajecia.czas.isValid()) {
+        errorMsg = "Nieprawidłowy format czasu (oczekiwano HH:mm)";
+        return false;
     }
 
     // Walidacja czasu trwania
-    int czasTrwania = row[6].toInt(&ok);
-    if (!ok || czasTrwania <= 0) {
+    zajecia.czasTrwania = row.fieldView(6).trimmed().toInt(&ok);
+    if (!ok || zajecia.czasTrwania <= 0) {
         errorMsg = "Nieprawidłowy czas trwania";
         return false;
     }
 
+    zajecia.nazwa = row.field(1).trimmed();
+    zajecia.trener = row.field(2).trimmed();
+    zajecia.opis = row.fieldCount() > 7 ? row.field(7).trimmed() : QString();
     return true;
 }
 
-bool DatabaseManager::validateRezerwacjaCSVRow(const QStringList& row, QString& errorMsg) {
-    if (row.size() < 11) {
+bool DatabaseManager::validateRezerwacjaCSVRow(const CsvRow& row, Rezerwacja& rezerwacja, QString& errorMsg) {
+    // Pola: ID, IdKlienta, IdZajec, ImieKlienta, NazwiskoKlienta, NazwaZajec, TrenerZajec, DataZajec, CzasZajec, DataRezerwacji, Status
+    // Zapisywane są tylko identyfikatory i status - kolumn z joinów nie kopiujemy
+    if (row.fieldCount() < 11) {
         errorMsg = "Za mało kolumn";
         return false;
     }
 
     // Walidacja ID klienta
     bool ok;
-    int idKlienta = row[1].toInt(&ok);
-    if (!ok || idKlienta <= 0) {
+    rezerwacja.idKlienta = row.fieldView(1).trimmed().toInt(&ok);
+    if (!ok || rezerwacja.idKlienta <= 0) {
         errorMsg = "Nieprawidłowe ID klienta";
         return false;
     }
 
     // Walidacja ID zajęć
-    int idZajec = row[2].toInt(&ok);
-    if (!ok || idZajec <= 0) {
+    rezerwacja.idZajec = row.fieldView(2).trimmed().toInt(&ok);
+    if (!ok || rezerwacja.idZajec <= 0) {
         errorMsg = "Nieprawidłowe ID zajęć";
         return false;
     }
 
     // Walidacja statusu
-    QString status = row[10].trimmed().toLower();
-    if (status != "aktywna" && status != "anulowana") {
+    const std::optional<StatusRezerwacji> status = statusZPola(row.fieldView(10).trimmed());
+    if (!status.has_value()) {
         errorMsg = "Nieprawidłowy status (oczekiwano 'aktywna' lub 'anulowana')";
         return false;
     }
+    rezerwacja.status = *status;
 
     return true;
 }
 
-bool DatabaseManager::validateKarnetCSVRow(const QStringList& row, QString& errorMsg) {
-    if (row.size() < 10) {
+bool DatabaseManager::validateKarnetCSVRow(const CsvRow& row, Karnet& karnet, QString& errorMsg) {
+    // Pola: ID, IdKlienta, ImieKlienta, NazwiskoKlienta, EmailKlienta, Typ, DataRozpoczecia, DataZakonczenia, Cena, CzyAktywny
+    if (row.fieldCount() < 10) {
         errorMsg = "Za mało kolumn";
         return false;
     }
 
     // Walidacja ID klienta
     bool ok;
-    int idKlienta = row[1].toInt(&ok);
-    if (!ok || idKlienta <= 0) {
+    karnet.idKlienta = row.fieldView(1).trimmed().toInt(&ok);
+    if (!ok || karnet.idKlienta <= 0) {
         errorMsg = "Nieprawidłowe ID klienta";
         return false;
     }
 
     // Walidacja typu
-    QString typ = row[5].trimmed().toLower();
+    karnet.typ = row.field(5).trimmed();
+    const QString typ = karnet.typ.toLower();
     if (typ != "normalny" && typ != "studencki") {
         errorMsg = "Nieprawidłowy typ karnetu (oczekiwano 'normalny' lub 'studencki')";
         return false;
     }
 
     // Walidacja daty rozpoczęcia
-    QString dataRozp = row[6].trimmed();
-    QDate dataRozpObj = QDate::fromString(dataRozp, "yyyy-MM-dd");
-    if (!dataRozpObj.isValid()) {
+    karnet.dataRozpoczecia = dataZPola(row.fieldView(6).trimmed());
+    if (!karnet.dataRozpoczecia.isValid()) {
         errorMsg = "Nieprawidłowy format daty rozpoczęcia (oczekiwano yyyy-MM-dd)";
         return false;
     }
 
     // Walidacja daty zakończenia
-    QString dataZak = row[7].trimmed();
-    QDate dataZakObj = QDate::fromString(dataZak, "yyyy-MM-dd");
-    if (!dataZakObj.isValid()) {
+    karnet.dataZakonczenia = dataZPola(row.fieldView(7).trimmed());
+    if (!karnet.dataZakonczenia.isValid()) {
         errorMsg = "Nieprawidłowy format daty zakończenia (oczekiwano yyyy-MM-dd)";
         return false;
     }
 
     // Sprawdź czy data zakończenia jest późniejsza
-    if (dataZakObj <= dataRozpObj) {
+    if (karnet.dataZakonczenia <= karnet.dataRozpoczecia) {
         errorMsg = "Data zakończenia musi być późniejsza niż data rozpoczęcia";
         return false;
     }
 
     // Walidacja ceny
-    double cena = row[8].toDouble(&ok);
-    if (!ok || cena <= 0) {
+    karnet.cena = row.fieldView(8).trimmed().toDouble(&ok);
+    if (!ok || karnet.cena <= 0) {
         errorMsg = "Nieprawidłowa cena";
         return false;
     }
 
     // Walidacja statusu aktywności
-    QString aktywny = row[9].trimmed();
-    if (aktywny != "0" && aktywny != "1") {
+    QByteArrayView aktywny = row.fieldView(9).trimmed();
+    if (aktywny != QByteArrayView("0") && aktywny != QByteArrayView("1")) {
         errorMsg = "Nieprawidłowy status aktywności (oczekiwano '0' lub '1')";
         return false;
     }
+    karnet.czyAktywny = (aktywny == QByteArrayView("1"));
 
     return true;
 }
@@ -2,8 +2,20 @@
 #define DATABASEMANAGER_H
 
 #include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
+#include <QDate>
+#include <QDateTime>
+#include <QTime>
 #include <QVariantList>
+#include <QVariantMap>
 #include <QList>
+#include <QSet>
+#include <memory>
+#include <initializer_list>
+#include <optional>
+
+enum class TabelaDanych;    // DatabaseNotifier.h
+class CsvRow;               // CsvReader.h
 
 struct Klient {
     int id;
@@ -21,34 +33,43 @@ struct Zajecia {
     QString nazwa;
     QString trener;
     int maksUczestnikow;
-    QString data;           // format YYYY-MM-DD
-    QString czas;           // format HH:MM
+    QDate data;             // w bazie: dni od 1970-01-01
+    QTime czas;             // w bazie: minuty od północy
     int czasTrwania;        // w minutach
     QString opis;
+    int aktualneRezerwacje; // aktywne rezerwacje (licznik utrzymywany triggerami)
+};
+
+// Status rezerwacji. Wartości są zapisane w kolumnie rezerwacja.status - CHECK w schemacie,
+// indeksy częściowe i zapytania porównują z liczbą wprost, więc numerów nie wolno zmieniać.
+// Tekst ("aktywna", "anulowana") tylko w UI i CSV - nazwaStatusuRezerwacji/statusRezerwacjiZNazwy.
+enum class StatusRezerwacji {
+    Aktywna = 0,
+    Anulowana = 1
 };
 
 struct Rezerwacja {
     int id;
     int idKlienta;
     int idZajec;
-    QString dataRezerwacji; // format YYYY-MM-DD HH:MM:SS
-    QString status;         // "aktywna", "anulowana", itp.
+    QDateTime dataRezerwacji;   // w bazie: sekundy od epoki Unix (UTC)
+    StatusRezerwacji status;
 
     // Dodatkowe informacje (z joinów)
     QString imieKlienta;
     QString nazwiskoKlienta;
     QString nazwaZajec;
     QString trenerZajec;
-    QString dataZajec;
-    QString czasZajec;
+    QDate dataZajec;
+    QTime czasZajec;
 };
 
 struct Karnet {
     int id;
     int idKlienta;
     QString typ;            // "normalny", "studencki"
-    QString dataRozpoczecia; // format YYYY-MM-DD
-    QString dataZakonczenia; // format YYYY-MM-DD
+    QDate dataRozpoczecia;  // w bazie: dni od 1970-01-01
+    QDate dataZakonczenia;
     double cena;
     bool czyAktywny;        // true/false
 
@@ -58,12 +79,191 @@ struct Karnet {
     QString emailKlienta;
 };
 
+// Słownik napisów jednego wyniku (listy, strony albo modelu tabeli). Pola z joinów
+// (klient, zajęcia) powtarzają się w tysiącach wierszy - słownik trzyma każdą wartość
+// raz, a wiersze dostają kopię QString współdzielącą te same dane (implicit sharing),
+// zamiast osobnego bufora na każdy wiersz. Pola i sposób użycia struktur bez zmian.
+class SlownikNapisow {
+public:
+    QString wspolny(const QString& tekst);
+
+    void wspoldziel(Klient&) {}         // bez pól z joinów
+    void wspoldziel(Zajecia&) {}
+    void wspoldziel(Rezerwacja& rezerwacja);
+    void wspoldziel(Karnet& karnet);
+
+    template<typename T>
+    void wspoldziel(QList<T>& lista) {
+        for (T& element : lista) {
+            wspoldziel(element);
+        }
+    }
+
+    int rozmiar() const;
+    void wyczysc();
+
+private:
+    QSet<QString> napisy;
+};
+
+// Wynik próby zapisania klienta na zajęcia
+enum class WynikRezerwacji {
+    Ok,
+    BrakMiejsc,         // osiągnięto limit uczestników
+    Duplikat,           // klient ma już aktywną rezerwację na te zajęcia
+    NieznaneZajecia,    // zajęcia o podanym ID nie istnieją
+    Blad                // błąd bazy danych
+};
+
+// Obsługa blokad SQLite (SQLITE_BUSY) wspólna dla połączeń wszystkich wątków
+struct PolitykaBlokad {
+    int busyTimeoutMs = 5000;           // ile SQLite sam czeka na zwolnienie blokady
+    int maksPonowien = 5;               // ile razy ponowić polecenie po SQLITE_BUSY
+    int poczatkoweOpoznienieMs = 20;    // opóźnienie pierwszego ponowienia (kolejne x2)
+};
+
+// Zestawy ustawień SQLite (PRAGMA) dobrane do charakteru pracy z bazą
+enum class ProfilBazy {
+    Biurowy,        // "desk" - codzienna praca z UI, WAL + synchronous=NORMAL
+    ImportMasowy,   // "bulk-load" - szybkie ładowanie danych kosztem trwałości
+    Raportowy       // "read-only reporting" - tylko odczyt, duży cache i mmap
+};
+
+// Wynik eksportu strumieniowego (liczba wierszy, rozmiar pliku i przepustowość)
+struct StatystykiEksportu {
+    qint64 wiersze = 0;
+    qint64 bajty = 0;
+    qint64 czasMs = 0;
+
+    double wierszeNaSekunde() const;
+    double megabajtyNaSekunde() const;
+};
+
+// Rodzaj danych importowanych z pliku CSV
+enum class RodzajImportu {
+    Klienci,
+    Zajecia,
+    Rezerwacje,
+    Karnety
+};
+
+// Wiersz CSV po walidacji, przekonwertowany do zapisu. Wypełniona jest tylko struktura
+// danego rodzaju importu - kolumny, których import nie zapisuje (ID, dane z joinów),
+// nie są kopiowane z pliku.
+struct WierszImportu {
+    Klient klient{};
+    Zajecia zajecia{};
+    Rezerwacja rezerwacja{};
+    Karnet karnet{};
+};
+
+struct StatystykiCache {
+    quint64 trafienia;      // ile razy obiekt był już w cache
+    quint64 chybienia;      // ile razy trzeba było go utworzyć/pobrać
+    int rozmiar;            // liczba obiektów aktualnie w cache
+};
+
+struct StatystykiCacheEncji {
+    StatystykiCache klienci;
+    StatystykiCache zajecia;
+    StatystykiCache karnety;
+};
+
+// Okres, w jakim raport przychodów sumuje dni
+enum class OkresRaportu {
+    Dzien,
+    Tydzien,    // od poniedziałku
+    Miesiac
+};
+
+// Karnety rozpoczęte w jednym okresie, osobno dla każdego typu
+struct PrzychodOkresu {
+    QDate poczatek;         // pierwszy dzień okresu, najwcześniej dataOd raportu
+    QDate koniec;           // ostatni dzień okresu, najpóźniej dataDo raportu
+    QString typ;
+    int liczbaKarnetow;
+    double przychod;
+};
+
+// Zajęcia zaczynające się o jednej godzinie jednego dnia tygodnia (komórka mapy obłożenia)
+struct KomorkaOblozenia {
+    int zajecia = 0;
+    int rezerwacje = 0;     // aktywne
+    int miejsca = 0;        // suma maksUczestnikow
+
+    // Średnia ważona miejscami - duże zajęcia liczą się bardziej niż małe
+    double oblozenie() const { return miejsca > 0 ? static_cast<double>(rezerwacje) / miejsca : 0.0; }
+};
+
+// Obłożenie zajęć wg dnia tygodnia (1 = poniedziałek, jak QDate::dayOfWeek) i godziny rozpoczęcia
+struct MapaOblozenia {
+    KomorkaOblozenia komorki[7][24];
+
+    const KomorkaOblozenia& komorka(int dzienTygodnia, int godzina) const { return komorki[dzienTygodnia - 1][godzina]; }
+};
+
+// Strona listy stronicowanej po kluczu sortowania (keyset). Token kontynuacji jest
+// nieprzezroczysty - pusty przy pierwszym zapytaniu, a w wyniku pusty na ostatniej stronie.
+template<typename T>
+struct Strona {
+    QList<T> elementy;
+    QString nastepnyToken;
+
+    bool maWiecej() const { return !nastepnyToken.isEmpty(); }
+};
+
+// Kryteria filtrowania list rezerwacji i karnetów. Nieustawione pole nie zawęża wyniku;
+// DatabaseManager składa ustawione pola w jeden sparametryzowany warunek WHERE.
+struct FiltrListy {
+    std::optional<StatusRezerwacji> status;     // rezerwacje
+    QString typ;                    // karnety: "normalny", "studencki"
+    std::optional<bool> czyAktywny; // karnety
+    QDate dataOd;                   // rezerwacje: data rezerwacji, karnety: data rozpoczęcia (włącznie)
+    QDate dataDo;
+    int idKlienta = -1;
+    int idZajec = -1;               // rezerwacje
+    QString trener;                 // rezerwacje: trener zajęć
+
+    bool czyPusty() const;
+
+    // Ten sam warunek dla pojedynczego wiersza - widoki poprawiane po zapisie bez zapytania listy
+    bool pasuje(const Rezerwacja& rezerwacja) const;
+    bool pasuje(const Karnet& karnet) const;
+};
+
 class DatabaseManager {
 public:
     // === Podstawowe metody połączenia ===
-    static bool connect(const QString& path);
+    static bool connect(const QString& path, ProfilBazy profil = ProfilBazy::Biurowy);
     static void disconnect();
-    static QSqlDatabase& instance();
+    static QSqlDatabase instance();     // połączenie bieżącego wątku (każdy wątek ma własne)
+    static void setBusyPolicy(const PolitykaBlokad& polityka);
+    static PolitykaBlokad busyPolicy();
+
+    // === Profile ustawień bazy (przełączane w trakcie działania) ===
+    static bool setStorageProfile(ProfilBazy profil);
+    static ProfilBazy storageProfile();
+    static QString storageProfileName(ProfilBazy profil);
+
+    // === Schemat bazy (migracje sterowane PRAGMA user_version) ===
+    static bool migrateSchema();
+    static int schemaVersion();
+
+    // === Cache przygotowanych zapytań ===
+    static StatystykiCache statementCacheStats();
+    static void clearStatementCache();
+
+    // === Cache encji czytanych po id (get*ById) ===
+    // Ograniczony (LRU), unieważniany przez update/delete i import danego typu
+    static StatystykiCacheEncji entityCacheStats();
+    static void clearEntityCache();                 // zeruje też statystyki
+    static void setEntityCacheCapacity(int obiekty);    // na każdy typ encji osobno
+
+    // === Cache wyników całych list (getAll*, zajęcia dostępne do rezerwacji) ===
+    // Ważny, dopóki nie zmieni się żadna z czytanych tabel - bez zapisów odświeżenie nie pyta bazy
+    static StatystykiCache resultCacheStats();      // rozmiar = liczba zapamiętanych wyników
+    static void clearResultCache();                 // zeruje też statystyki
+    static void setResultCacheCapacity(int wiersze);    // na każdy typ encji osobno
 
     // === CRUD dla KLIENTÓW ===
     static bool addKlient(const QString& imie,
@@ -84,14 +284,17 @@ public:
     static bool deleteKlient(int id);
     static bool emailExists(const QString& email, int excludeId = -1);
     static QList<Klient> searchKlienciByNazwisko(const QString& nazwisko);
+    // Wyszukiwanie pełnotekstowe (FTS5) po imieniu, nazwisku, e-mailu, telefonie i uwagach:
+    // słowa jako prefiksy, wszystkie muszą wystąpić; najlepsze dopasowania pierwsze
+    static QList<Klient> searchKlienci(const QString& fraza, int limit = 200);
     static int getKlienciCount();
 
     // === CRUD dla ZAJĘĆ ===
     static bool addZajecia(const QString& nazwa,
                            const QString& trener = QString(),
                            int maksUczestnikow = 20,
-                           const QString& data = QString(),
-                           const QString& czas = QString(),
+                           const QDate& data = QDate(),
+                           const QTime& czas = QTime(),
                            int czasTrwania = 60,
                            const QString& opis = QString());
     static QList<Zajecia> getAllZajecia();
@@ -100,38 +303,46 @@ public:
                               const QString& nazwa,
                               const QString& trener = QString(),
                               int maksUczestnikow = 20,
-                              const QString& data = QString(),
-                              const QString& czas = QString(),
+                              const QDate& data = QDate(),
+                              const QTime& czas = QTime(),
                               int czasTrwania = 60,
                               const QString& opis = QString());
     static bool deleteZajecia(int id);
     static QList<Zajecia> searchZajeciaByNazwa(const QString& nazwa);
     static QList<Zajecia> searchZajeciaByTrener(const QString& trener);
-    static QList<Zajecia> getZajeciaByData(const QString& data);
+    static QList<Zajecia> getZajeciaByData(const QDate& data);
+    // Zajęcia rozpoczynające się w przedziale [od, przed) - porównanie liczb w indeksie (data, czas)
+    static QList<Zajecia> getZajeciaWPrzedziale(const QDateTime& od, const QDateTime& przed);
     static int getZajeciaCount();
-    static bool zajeciaExist(const QString& nazwa, const QString& data, const QString& czas, int excludeId = -1);
+    static bool zajeciaExist(const QString& nazwa, const QDate& data, const QTime& czas, int excludeId = -1);
 
     // === CRUD dla REZERWACJI ===
-    static bool addRezerwacja(int idKlienta, int idZajec, const QString& status = "aktywna");
+    static bool addRezerwacja(int idKlienta, int idZajec, StatusRezerwacji status = StatusRezerwacji::Aktywna);
+    static WynikRezerwacji zarezerwuj(int idKlienta, int idZajec, StatusRezerwacji status = StatusRezerwacji::Aktywna);
     static QList<Rezerwacja> getAllRezerwacje();
     static Rezerwacja getRezerwacjaById(int id);
-    static bool updateRezerwacjaStatus(int id, const QString& status);
+    static bool updateRezerwacjaStatus(int id, StatusRezerwacji status);
     static bool deleteRezerwacja(int id);
 
     // === Pomocnicze metody dla rezerwacji ===
+    static QString nazwaStatusuRezerwacji(StatusRezerwacji status);     // "aktywna", "anulowana"
+    static std::optional<StatusRezerwacji> statusRezerwacjiZNazwy(const QString& nazwa);   // bez względu na wielkość liter
     static bool klientMaRezerwacje(int idKlienta, int idZajec);
     static int getIloscAktywnychRezerwacji(int idZajec);
     static bool moznaZarezerwowac(int idZajec);
     static QList<Rezerwacja> getRezerwacjeKlienta(int idKlienta);
     static QList<Rezerwacja> getRezerwacjeZajec(int idZajec);
+    // Rezerwacje złożone w przedziale [od, przed), od najnowszej
+    static QList<Rezerwacja> getRezerwacjeWPrzedziale(const QDateTime& od, const QDateTime& przed);
     static QList<Zajecia> getZajeciaDostepneDoRezerwacji();
     static int getRezerwacjeCount();
+    static int getRezerwacjeCount(const FiltrListy& filtr);
 
     // === CRUD dla KARNETÓW ===
     static bool addKarnet(int idKlienta,
                           const QString& typ,
-                          const QString& dataRozpoczecia,
-                          const QString& dataZakonczenia,
+                          const QDate& dataRozpoczecia,
+                          const QDate& dataZakonczenia,
                           double cena,
                           bool czyAktywny = true);
     static QList<Karnet> getAllKarnety();
@@ -139,8 +350,8 @@ public:
     static bool updateKarnet(int id,
                              int idKlienta,
                              const QString& typ,
-                             const QString& dataRozpoczecia,
-                             const QString& dataZakonczenia,
+                             const QDate& dataRozpoczecia,
+                             const QDate& dataZakonczenia,
                              double cena,
                              bool czyAktywny);
     static bool deleteKarnet(int id);
@@ -151,24 +362,54 @@ public:
     static bool klientMaAktywnyKarnet(int idKlienta);
     static QList<Karnet> getKarnetyByTyp(const QString& typ);
     static QList<Karnet> getKarnetyByStatus(bool czyAktywny);
-    static QList<Karnet> getKarnetyWygasajace(const QString& dataOd, const QString& dataDo);
+    // Aktywne karnety kończące się między dataOd a dataDo (włącznie)
+    static QList<Karnet> getKarnetyWygasajace(const QDate& dataOd, const QDate& dataDo);
     static int getKarnetyCount();
+    static int getKarnetyCount(const FiltrListy& filtr);
     static bool moznaUtworzycKarnet(int idKlienta, const QString& typ);
 
+    // === Listy stronicowane po kluczu (kolejność jak w getAll*/search*) ===
+    // Koszt strony nie zależy od jej położenia na liście - bez OFFSET, zakres w indeksie.
+    // Token z innej listy, wydany przy innym filtrze (frazie) albo uszkodzony daje pustą
+    // stronę i ostrzeżenie w logu.
+    static Strona<Klient> getKlienciStrona(const QString& token = QString(), int limit = 500);
+    static Strona<Klient> searchKlienciByNazwiskoStrona(const QString& nazwisko, const QString& token = QString(), int limit = 500);
+    static Strona<Zajecia> getZajeciaStrona(const QString& token = QString(), int limit = 500);
+    static Strona<Zajecia> searchZajeciaByNazwaStrona(const QString& nazwa, const QString& token = QString(), int limit = 500);
+    static Strona<Zajecia> searchZajeciaByTrenerStrona(const QString& trener, const QString& token = QString(), int limit = 500);
+    static Strona<Rezerwacja> getRezerwacjeStrona(const QString& token = QString(), int limit = 500);
+    static Strona<Rezerwacja> getRezerwacjeStrona(const FiltrListy& filtr, const QString& token = QString(), int limit = 500);
+    static Strona<Karnet> getKarnetyStrona(const QString& token = QString(), int limit = 500);   // w obrębie daty wg id
+    static Strona<Karnet> getKarnetyStrona(const FiltrListy& filtr, const QString& token = QString(), int limit = 500);
+
     // === Metody raportowe ===
     static QList<QPair<QString, int>> getNajpopularniejszeZajecia(int limit = 10);
     static QList<QPair<QString, int>> getNajaktywniejszychKlientow(int limit = 10);
     static QList<QPair<QString, int>> getStatystykiKarnetow();
     static double getCalkowitePrzychodyZKarnetow();
     static int getLiczbaAktywnychKarnetow();
+    // Sprzedaż karnetów wg dnia rozpoczęcia (także karnetów już nieaktywnych) w przedziale
+    // [dataOd, dataDo], zsumowana w okresy. Pierwszy i ostatni okres są przycięte do przedziału.
+    // Wynik posortowany po okresie, potem po typie.
+    static QList<PrzychodOkresu> getPrzychodyKarnetow(const QDate& dataOd, const QDate& dataDo, OkresRaportu okres);
+    // Obłożenie zajęć z przedziału [dataOd, dataDo], opcjonalnie tylko jednych zajęć (nazwa)
+    // albo jednego trenera. Zajęcia bez godziny rozpoczęcia są pomijane.
+    static MapaOblozenia getMapaOblozenia(const QDate& dataOd,
+                                          const QDate& dataDo,
+                                          const QString& nazwa = QString(),
+                                          const QString& trener = QString());
+    // Różne nazwy zajęć i trenerzy (bez pustych) - do list wyboru filtrów, z indeksów (nazwa, data, czas)
+    // i (trener, data, czas) bez czytania wierszy zajęć
+    static QStringList getNazwyZajec();
+    static QStringList getTrenerzyZajec();
 
     // === EKSPORT I IMPORT CSV ===
 
     // Eksport do CSV
-    static bool exportKlienciToCSV(const QString& filePath);
-    static bool exportZajeciaToCSV(const QString& filePath);
-    static bool exportRezerwacjeToCSV(const QString& filePath);
-    static bool exportKarnetyToCSV(const QString& filePath);
+    static bool exportKlienciToCSV(const QString& filePath, StatystykiEksportu* statystyki = nullptr);
+    static bool exportZajeciaToCSV(const QString& filePath, StatystykiEksportu* statystyki = nullptr);
+    static bool exportRezerwacjeToCSV(const QString& filePath, StatystykiEksportu* statystyki = nullptr);
+    static bool exportKarnetyToCSV(const QString& filePath, StatystykiEksportu* statystyki = nullptr);
     static bool exportAllToCSV(const QString& dirPath);  // Eksportuje wszystkie tabele do oddzielnych plików
 
     // Import z CSV
@@ -177,27 +418,155 @@ public:
     static QPair<int, QStringList> importRezerwacjeFromCSV(const QString& filePath);
     static QPair<int, QStringList> importKarnetyFromCSV(const QString& filePath);
 
+    // Liczba wierszy importu zatwierdzanych jedną transakcją (domyślnie 500)
+    static void setImportBatchSize(int rozmiar);
+    static int importBatchSize();
+
+    // Etapy importu wspólne dla import*FromCSV i ImportPipeline: walidacja i konwersja
+    // wiersza wprost z pól czytnika (bez dostępu do bazy, można wołać z dowolnego wątku)
+    // i zapis partiami
+    static bool sprawdzWierszCSV(RodzajImportu rodzaj, const CsvRow& row, WierszImportu& wiersz, QString& errorMsg);
+    static QString nazwaRodzajuImportu(RodzajImportu rodzaj);
+    class ZapisImportu;
+
 private:
     DatabaseManager() = default;
-    static QSqlDatabase db;
+
+    // Połączenie bieżącego wątku - otwierane przy pierwszym użyciu w danym wątku
+    static QSqlDatabase database();
+
+    // Przygotowane zapytania połączenia bieżącego wątku (klucz = treść SQL)
+    static QSqlQuery preparedQuery(const QString& sql);
+
+    // exec() z ponawianiem po SQLITE_BUSY wg polityki blokad
+    static bool execWithRetry(QSqlQuery& query);
+
+    // Transakcja zapisu z blokadą zakładaną od razu (BEGIN IMMEDIATE)
+    static bool beginWriteTransaction();
+    static bool commitTransaction();
+    static void rollbackTransaction();
+
+    // Sprawdzenie limitu i duplikatu oraz INSERT jednym poleceniem (wywoływane w transakcji)
+    static WynikRezerwacji wstawRezerwacje(int idKlienta, int idZajec, StatusRezerwacji status, int* noweId = nullptr);
+
+    // Id zajęć rezerwacji przed jej zmianą (wywoływane w transakcji); -1 gdy brak rezerwacji albo błąd
+    static int zajeciaRezerwacji(int idRezerwacji);
+
+    // Sam INSERT bez sprawdzania duplikatów - sprawdza wywołujący (add* albo import).
+    // Zapisy przez add*/update*/delete* zgłaszają się do DatabaseNotifier, wstaw* nie.
+    static bool wstawKlienta(const QString& imie,
+                             const QString& nazwisko,
+                             const QString& email,
+                             const QString& telefon,
+                             const QString& dataUrodzenia,
+                             const QString& uwagi,
+                             int* noweId = nullptr);
+    static bool wstawZajecia(const QString& nazwa,
+                             const QString& trener,
+                             int maksUczestnikow,
+                             const QDate& data,
+                             const QTime& czas,
+                             int czasTrwania,
+                             const QString& opis,
+                             int* noweId = nullptr);
+    static bool wstawKarnet(int idKlienta,
+                            const QString& typ,
+                            const QDate& dataRozpoczecia,
+                            const QDate& dataZakonczenia,
+                            double cena,
+                            bool czyAktywny,
+                            int* noweId = nullptr);
+
+    // Import partiami (transakcja na partię, SAVEPOINT na wiersz) i zbiory do sprawdzania duplikatów
+    class PartiaImportu;
+    static QPair<int, QStringList> importujCSV(RodzajImportu rodzaj, const QString& filePath);
+    static QSet<QString> wczytajKlucze(const QString& sql);
+    static QSet<int> wczytajIdentyfikatory(const QString& sql);
+
+    // Wspólna część list stronicowanych po kluczu (opis listy w DatabaseManager.cpp)
+    struct ListaStronicowana;
+    template<typename T>
+    static Strona<T> pobierzStrone(const ListaStronicowana& lista,
+                                   const QString& token,
+                                   int limit,
+                                   const QVariantMap& parametry,
+                                   T (*konwersja)(QSqlQuery&),
+                                   const QString& warunekFiltra = QString());
+
+    // Cała lista z jednego zapytania przez cache wyników. tabele = wszystko, co zapytanie
+    // czyta (także liczniki utrzymywane triggerami innej tabeli)
+    template<typename T>
+    static QList<T> pobierzListe(const QString& sql,
+                                 const QVariantMap& parametry,
+                                 std::initializer_list<TabelaDanych> tabele,
+                                 T (*konwersja)(QSqlQuery&),
+                                 const char* opisBledu);
 
     // Pomocnicze metody do konwersji QSqlQuery na struktury
-    static Klient queryToKlient(class QSqlQuery& query);
-    static Zajecia queryToZajecia(class QSqlQuery& query);
-    static Rezerwacja queryToRezerwacja(class QSqlQuery& query);
-    static Karnet queryToKarnet(class QSqlQuery& query);
+    static Klient queryToKlient(QSqlQuery& query);
+    static Zajecia queryToZajecia(QSqlQuery& query);
+    static Rezerwacja queryToRezerwacja(QSqlQuery& query);
+    static Karnet queryToKarnet(QSqlQuery& query);
 
     // Pomocnicze metody dla CSV
+    static bool eksportujZapytanie(const QString& filePath,
+                                   const QStringList& headers,
+                                   const QString& sql,
+                                   StatystykiEksportu* statystyki);
     static QString escapeCSVField(const QString& field);
-    static QStringList parseCSVLine(const QString& line);
+    static void escapeCSVField(const QByteArray& field, QByteArray& bufor);   // dopisuje UTF-8 do bufora
     static QString formatCSVHeader(const QStringList& headers);
-    static QString formatCSVRow(const QStringList& values);
 
     // Walidacja danych CSV
-    static bool validateKlientCSVRow(const QStringList& row, QString& errorMsg);
-    static bool validateZajeciaCSVRow(const QStringList& row, QString& errorMsg);
-    static bool validateRezerwacjaCSVRow(const QStringList& row, QString& errorMsg);
-    static bool validateKarnetCSVRow(const QStringList& row, QString& errorMsg);
+    static bool validateKlientCSVRow(const CsvRow& row, Klient& klient, QString& errorMsg);
+    static bool validateZajeciaCSVRow(const CsvRow& row, Zajecia& zajecia, QString& errorMsg);
+    static bool validateRezerwacjaCSVRow(const CsvRow& row, Rezerwacja& rezerwacja, QString& errorMsg);
+    static bool validateKarnetCSVRow(const CsvRow& row, Karnet& karnet, QString& errorMsg);
+};
+
+// Tymczasowa zmiana profilu połączenia bieżącego wątku (np. na czas importu) - profil
+// globalny i połączenia innych wątków bez zmian; poprzedni wraca w destruktorze
+class ZmianaProfiluBazy {
+public:
+    explicit ZmianaProfiluBazy(ProfilBazy profil);
+    ~ZmianaProfiluBazy();
+
+    ZmianaProfiluBazy(const ZmianaProfiluBazy&) = delete;
+    ZmianaProfiluBazy& operator=(const ZmianaProfiluBazy&) = delete;
+
+private:
+    int generacja = -1;         // połączenie, któremu zmieniono profil
+    int poprzedni = -1;         // jego poprzedni profil lokalny (-1 = globalny)
+};
+
+// Zapis wierszy importu: duplikaty sprawdzane w zbiorach wczytanych raz na import,
+// wiersze zapisywane partiami. Używa połączenia wątku, w którym obiekt utworzono.
+class DatabaseManager::ZapisImportu {
+public:
+    ZapisImportu(RodzajImportu rodzaj, QStringList& errors);
+    ~ZapisImportu();
+
+    ZapisImportu(const ZapisImportu&) = delete;
+    ZapisImportu& operator=(const ZapisImportu&) = delete;
+
+    // Wiersz musi przejść sprawdzWierszCSV; błąd trafia do listy errors
+    bool zapisz(int lineNumber, const WierszImportu& wiersz);
+    bool zakoncz();
+    int zaimportowane() const;
+
+private:
+    bool zapiszKlienta(int lineNumber, const Klient& klient);
+    bool zapiszZajecia(int lineNumber, const Zajecia& nowe);
+    bool zapiszRezerwacje(int lineNumber, const Rezerwacja& rezerwacja);
+    bool zapiszKarnet(int lineNumber, const Karnet& karnet);
+
+    RodzajImportu rodzaj;
+    QStringList& errors;
+    ZmianaProfiluBazy profilImportu;            // niszczony po partii - profil wraca po zatwierdzeniu
+    std::unique_ptr<PartiaImportu> partia;
+    QSet<QString> klucze;                       // emaile / terminy zajęć / aktywne karnety klientów
+    QSet<int> klienci;
+    QSet<int> zajecia;
 };
 
 #endif // DATABASEMANAGER_H
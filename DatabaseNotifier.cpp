@@ -0,0 +1,20 @@
+#include "DatabaseNotifier.h"
+
+DatabaseNotifier::DatabaseNotifier() {
+    // Typy argumentów sygnałów przekazywanych między wątkami
+    qRegisterMetaType<TabelaDanych>("TabelaDanych");
+    qRegisterMetaType<OperacjaZmiany>("OperacjaZmiany");
+}
+
+DatabaseNotifier* DatabaseNotifier::instance() {
+    static DatabaseNotifier powiadomienia;
+    return &powiadomienia;
+}
+
+void DatabaseNotifier::zglosZmiane(TabelaDanych tabela, int id, OperacjaZmiany operacja) {
+    emit zmieniono(tabela, id, operacja);
+}
+
+void DatabaseNotifier::zglosPrzeladowanie(TabelaDanych tabela) {
+    emit przeladowano(tabela);
+}
@@ -0,0 +1,40 @@
+#ifndef DATABASENOTIFIER_H
+#define DATABASENOTIFIER_H
+
+#include <QObject>
+
+// Tabela, której dotyczy powiadomienie o zmianie danych
+enum class TabelaDanych {
+    Klienci,
+    Zajecia,
+    Rezerwacje,
+    Karnety
+};
+
+enum class OperacjaZmiany {
+    Dodanie,
+    Zmiana,
+    Usuniecie
+};
+
+// Powiadomienia o zapisach wykonanych przez DatabaseManager, żeby widoki mogły poprawić
+// pojedynczy wiersz zamiast przeładowywać całą listę. Sygnały idą po zatwierdzeniu zmian
+// z wątku, który zapisywał - z wątków roboczych (import) docierają do GUI przez kolejkę zdarzeń.
+class DatabaseNotifier : public QObject {
+    Q_OBJECT
+
+public:
+    static DatabaseNotifier* instance();
+
+    void zglosZmiane(TabelaDanych tabela, int id, OperacjaZmiany operacja);
+    void zglosPrzeladowanie(TabelaDanych tabela);
+
+signals:
+    void zmieniono(TabelaDanych tabela, int id, OperacjaZmiany operacja);
+    void przeladowano(TabelaDanych tabela);     // zmieniło się wiele wierszy naraz (np. import CSV)
+
+private:
+    DatabaseNotifier();
+};
+
+#endif // DATABASENOTIFIER_H
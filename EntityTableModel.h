@@ -0,0 +1,383 @@
+#ifndef ENTITYTABLEMODEL_H
+#define ENTITYTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QBrush>
+#include <QColor>
+#include <QFuture>
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+#include <algorithm>
+#include <functional>
+#include <tuple>
+#include "DatabaseManager.h"
+
+// Opis kolumn tabeli dla danej struktury - specjalizacje poniżej
+template<typename T>
+struct EntityTraits;
+
+// Model tabeli dla Klient/Zajecia/Rezerwacja/Karnet. Wiersze trzymane są w jednym
+// ciągłym wektorze struktur (zamiast obiektu QTableWidgetItem na każdą komórkę),
+// a dane dociągane są stronami (po kluczu, z tokenem kontynuacji) przez
+// canFetchMore/fetchMore, gdy widok ich potrzebuje. Strona przychodzi asynchronicznie
+// (QFuture, zwykle z QueryExecutor) - wiersze dochodzą, gdy zapytanie się zakończy.
+// Pola z joinów wszystkich stron współdzielą napisy przez jeden SlownikNapisow modelu.
+template<typename T>
+class EntityTableModel : public QAbstractTableModel {
+public:
+    // Źródło strony danych: najwyżej limit wierszy za tokenem (pusty token = początek listy)
+    using Zrodlo = std::function<QFuture<Strona<T>>(const QString& token, int limit)>;
+
+    explicit EntityTableModel(QObject* parent = nullptr)
+        : QAbstractTableModel(parent) {}
+
+    // Nowe źródło danych - model czyści się, a pierwszą stronę pobierze widok
+    void ustawZrodlo(Zrodlo noweZrodlo, int nowyRozmiarStrony = 200) {
+        beginResetModel();
+        zrodlo = std::move(noweZrodlo);
+        rozmiarStrony = qMax(1, nowyRozmiarStrony);
+        token.clear();
+        wiersze.clear();
+        pozycje.clear();
+        slownik.wyczysc();
+        maWiecej = static_cast<bool>(zrodlo);
+        wToku = false;
+        ++generacja;
+        endResetModel();
+    }
+
+    // Gotowa lista (np. wynik wyszukiwania) - bez doczytywania
+    void ustawDane(const QList<T>& dane) {
+        beginResetModel();
+        zrodlo = nullptr;
+        token.clear();
+        slownik.wyczysc();
+        wiersze = QVector<T>(dane.cbegin(), dane.cend());
+        for (T& e : wiersze) {
+            slownik.wspoldziel(e);
+        }
+        przeliczPozycje(0);
+        maWiecej = false;
+        wToku = false;
+        ++generacja;
+        endResetModel();
+    }
+
+    const T* element(int wiersz) const {
+        if (wiersz < 0 || wiersz >= wiersze.size()) {
+            return nullptr;
+        }
+        return &wiersze.at(wiersz);
+    }
+
+    int idWiersza(int wiersz) const {
+        const T* e = element(wiersz);
+        return e ? e->id : -1;
+    }
+
+    const T* elementId(int id) const {
+        return element(pozycje.value(id, -1));
+    }
+
+    // === Zmiany pojedynczych wierszy (po zapisie, bez przeładowania listy) ===
+
+    // Nowy albo zmieniony wiersz trafia na miejsce wynikające z kolejności listy.
+    // Gotowa lista (wynik wyszukiwania) przyjmuje tylko zmiany wierszy, które już zawiera,
+    // i zostawia je na miejscu - model nie zna jej kryteriów ani kolejności (np. trafność).
+    void zapiszWiersz(const T& zmieniony) {
+        T e = zmieniony;
+        slownik.wspoldziel(e);
+
+        const int stary = pozycje.value(e.id, -1);
+        if (stary >= 0) {
+            if (!zrodlo || naSwoimMiejscu(stary, e)) {
+                wiersze[stary] = e;
+                emit dataChanged(index(stary, 0), index(stary, columnCount() - 1));
+                return;
+            }
+            usunWiersz(e.id);
+        } else if (!zrodlo) {
+            return;
+        }
+
+        const int miejsce = static_cast<int>(std::lower_bound(wiersze.cbegin(), wiersze.cend(), e, &EntityTraits<T>::przed)
+                                             - wiersze.cbegin());
+        if (miejsce == wiersze.size() && maWiecej) {
+            // Wiersz leży za ostatnią pobraną stroną - przyjdzie z kolejną
+            return;
+        }
+
+        beginInsertRows(QModelIndex(), miejsce, miejsce);
+        wiersze.insert(miejsce, e);
+        przeliczPozycje(miejsce);
+        endInsertRows();
+    }
+
+    void usunWiersz(int id) {
+        const int wiersz = pozycje.value(id, -1);
+        if (wiersz < 0) {
+            return;
+        }
+
+        beginRemoveRows(QModelIndex(), wiersz, wiersz);
+        wiersze.removeAt(wiersz);
+        pozycje.remove(id);
+        przeliczPozycje(wiersz);
+        endRemoveRows();
+    }
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override {
+        return parent.isValid() ? 0 : static_cast<int>(wiersze.size());
+    }
+
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override {
+        return parent.isValid() ? 0 : static_cast<int>(EntityTraits<T>::naglowki().size());
+    }
+
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override {
+        const T* e = index.isValid() ? element(index.row()) : nullptr;
+        if (!e) {
+            return QVariant();
+        }
+
+        switch (role) {
+        case Qt::DisplayRole:
+            return EntityTraits<T>::wartosc(*e, index.column());
+        case Qt::BackgroundRole:
+            return EntityTraits<T>::tlo(*e, index.column());
+        case Qt::UserRole:
+            return e->id;
+        default:
+            return QVariant();
+        }
+    }
+
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override {
+        if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+            return QAbstractTableModel::headerData(section, orientation, role);
+        }
+        return EntityTraits<T>::naglowki().value(section);
+    }
+
+    bool canFetchMore(const QModelIndex& parent) const override {
+        return !parent.isValid() && maWiecej && !wToku;
+    }
+
+    void fetchMore(const QModelIndex& parent) override {
+        if (parent.isValid() || !maWiecej || wToku) {
+            return;
+        }
+
+        // Strona zamówiona przed resetem modelu jest po jego zakończeniu ignorowana
+        wToku = true;
+        const int zamowienie = generacja;
+        zrodlo(token, rozmiarStrony)
+            .then(this, [this, zamowienie](const Strona<T>& strona) {
+                if (zamowienie == generacja) {
+                    dodajStrone(strona);
+                }
+            })
+            .onCanceled(this, [this, zamowienie]() {
+                if (zamowienie == generacja) {
+                    wToku = false;
+                }
+            });
+    }
+
+private:
+    void dodajStrone(const Strona<T>& strona) {
+        wToku = false;
+        token = strona.nastepnyToken;
+        maWiecej = strona.maWiecej();
+
+        // Wiersz, któremu po pobraniu zmieniono klucz sortowania, może wrócić z kolejną stroną
+        QVector<T> nowe;
+        nowe.reserve(strona.elementy.size());
+        for (const T& e : strona.elementy) {
+            if (!pozycje.contains(e.id)) {
+                nowe.append(e);
+                slownik.wspoldziel(nowe.last());
+            }
+        }
+        if (nowe.isEmpty()) {
+            return;
+        }
+
+        const int pierwszy = static_cast<int>(wiersze.size());
+        beginInsertRows(QModelIndex(), pierwszy, pierwszy + static_cast<int>(nowe.size()) - 1);
+        wiersze.append(nowe);
+        przeliczPozycje(pierwszy);
+        endInsertRows();
+    }
+
+    bool naSwoimMiejscu(int wiersz, const T& e) const {
+        return (wiersz == 0 || EntityTraits<T>::przed(wiersze.at(wiersz - 1), e))
+            && (wiersz + 1 == wiersze.size() || EntityTraits<T>::przed(e, wiersze.at(wiersz + 1)));
+    }
+
+    void przeliczPozycje(int od) {
+        for (int i = od; i < wiersze.size(); ++i) {
+            pozycje.insert(wiersze.at(i).id, i);
+        }
+    }
+
+    QVector<T> wiersze;
+    QHash<int, int> pozycje;        // id -> numer wiersza
+    SlownikNapisow slownik;         // napisy z joinów wspólne dla wszystkich stron
+    Zrodlo zrodlo;
+    QString token;                  // klucz ostatniego pobranego wiersza
+    int rozmiarStrony = 200;
+    bool maWiecej = false;
+    bool wToku = false;             // strona zamówiona, wynik jeszcze nie dotarł
+    int generacja = 0;              // zmieniana przy każdym resecie modelu
+};
+
+// === Kolumny tabel ===
+
+namespace KoloryStatusu {
+// Wspólne pędzle - tło komórki statusu nie tworzy nowego obiektu na każdy wiersz
+inline const QBrush& aktywny() {
+    static const QBrush pedzel(QColor(144, 238, 144));    // Jasny zielony
+    return pedzel;
+}
+inline const QBrush& nieaktywny() {
+    static const QBrush pedzel(QColor(255, 182, 193));    // Jasny czerwony
+    return pedzel;
+}
+}
+
+template<>
+struct EntityTraits<Klient> {
+    static const QStringList& naglowki() {
+        static const QStringList lista = {"ID", "Imię", "Nazwisko", "Email", "Telefon", "Data urodzenia", "Data rejestracji"};
+        return lista;
+    }
+
+    static QVariant wartosc(const Klient& k, int kolumna) {
+        switch (kolumna) {
+        case 0: return k.id;
+        case 1: return k.imie;
+        case 2: return k.nazwisko;
+        case 3: return k.email;
+        case 4: return k.telefon;
+        case 5: return k.dataUrodzenia;
+        case 6: return k.dataRejestracji;
+        }
+        return QVariant();
+    }
+
+    static QVariant tlo(const Klient&, int) {
+        return QVariant();
+    }
+
+    // Kolejność jak w DatabaseManager::getKlienciStrona
+    static bool przed(const Klient& a, const Klient& b) {
+        return std::tie(a.nazwisko, a.imie, a.id) < std::tie(b.nazwisko, b.imie, b.id);
+    }
+};
+
+template<>
+struct EntityTraits<Zajecia> {
+    static const QStringList& naglowki() {
+        static const QStringList lista = {"ID", "Nazwa", "Trener", "Data", "Godzina", "Czas trwania", "Limit", "Opis"};
+        return lista;
+    }
+
+    static QVariant wartosc(const Zajecia& z, int kolumna) {
+        switch (kolumna) {
+        case 0: return z.id;
+        case 1: return z.nazwa;
+        case 2: return z.trener;
+        case 3: return z.data.toString("yyyy-MM-dd");
+        case 4: return z.czas.toString("HH:mm");
+        case 5: return QString("%1 min").arg(z.czasTrwania);
+        case 6: return z.maksUczestnikow;
+        case 7: return z.opis;
+        }
+        return QVariant();
+    }
+
+    static QVariant tlo(const Zajecia&, int) {
+        return QVariant();
+    }
+
+    // Brak daty/godziny (nieprawidłowa QDate/QTime) na początku - jak COALESCE(..., -1) w SQL
+    static bool przed(const Zajecia& a, const Zajecia& b) {
+        return std::tie(a.data, a.czas, a.nazwa, a.id) < std::tie(b.data, b.czas, b.nazwa, b.id);
+    }
+};
+
+template<>
+struct EntityTraits<Rezerwacja> {
+    static const QStringList& naglowki() {
+        static const QStringList lista = {"ID", "Klient", "Zajęcia", "Trener", "Data zajęć", "Godzina", "Data rezerwacji", "Status"};
+        return lista;
+    }
+
+    static QVariant wartosc(const Rezerwacja& r, int kolumna) {
+        switch (kolumna) {
+        case 0: return r.id;
+        case 1: return QString("%1 %2").arg(r.imieKlienta, r.nazwiskoKlienta);
+        case 2: return r.nazwaZajec;
+        case 3: return r.trenerZajec;
+        case 4: return r.dataZajec.toString("yyyy-MM-dd");
+        case 5: return r.czasZajec.toString("HH:mm");
+        case 6: return r.dataRezerwacji.toString("yyyy-MM-dd");   // Bez godziny
+        case 7: return DatabaseManager::nazwaStatusuRezerwacji(r.status);
+        }
+        return QVariant();
+    }
+
+    static QVariant tlo(const Rezerwacja& r, int kolumna) {
+        if (kolumna != 7) {
+            return QVariant();
+        }
+        return r.status == StatusRezerwacji::Aktywna ? KoloryStatusu::aktywny() : KoloryStatusu::nieaktywny();
+    }
+
+    // Najnowsze na górze
+    static bool przed(const Rezerwacja& a, const Rezerwacja& b) {
+        return std::tie(b.dataRezerwacji, b.id) < std::tie(a.dataRezerwacji, a.id);
+    }
+};
+
+template<>
+struct EntityTraits<Karnet> {
+    static const QStringList& naglowki() {
+        static const QStringList lista = {"ID", "Klient", "Email", "Typ", "Data rozpoczęcia", "Data zakończenia", "Cena", "Status"};
+        return lista;
+    }
+
+    static QVariant wartosc(const Karnet& k, int kolumna) {
+        switch (kolumna) {
+        case 0: return k.id;
+        case 1: return QString("%1 %2").arg(k.imieKlienta, k.nazwiskoKlienta);
+        case 2: return k.emailKlienta;
+        case 3: return k.typ;
+        case 4: return k.dataRozpoczecia.toString("yyyy-MM-dd");
+        case 5: return k.dataZakonczenia.toString("yyyy-MM-dd");
+        case 6: return QString("%1 zł").arg(k.cena, 0, 'f', 2);
+        case 7: return QString(k.czyAktywny ? "Aktywny" : "Nieaktywny");
+        }
+        return QVariant();
+    }
+
+    static QVariant tlo(const Karnet& k, int kolumna) {
+        if (kolumna != 7) {
+            return QVariant();
+        }
+        return k.czyAktywny ? KoloryStatusu::aktywny() : KoloryStatusu::nieaktywny();
+    }
+
+    static bool przed(const Karnet& a, const Karnet& b) {
+        return std::tie(b.dataRozpoczecia, b.id) < std::tie(a.dataRozpoczecia, a.id);
+    }
+};
+
+using KlienciModel = EntityTableModel<Klient>;
+using ZajeciaModel = EntityTableModel<Zajecia>;
+using RezerwacjeModel = EntityTableModel<Rezerwacja>;
+using KarnetyModel = EntityTableModel<Karnet>;
+
+#endif // ENTITYTABLEMODEL_H
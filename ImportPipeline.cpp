@@ -0,0 +1,237 @@
+#include "ImportPipeline.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QMap>
+
+namespace {
+
+const int POJEMNOSC_KOLEJKI = 1024;
+const int ODSTEP_RAPORTU_MS = 100;
+
+int liczbaWalidatorow() {
+    // Czytnik i zapis mają własne wątki - walidatorom zostaje reszta rdzeni
+    return qBound(1, QThread::idealThreadCount() - 2, 4);
+}
+
+} // namespace
+
+// === Kolejka między etapami ===
+
+ImportPipeline::KolejkaWierszy::KolejkaWierszy(int pojemnosc, int producenci)
+    : pojemnosc(pojemnosc), producenci(producenci) {}
+
+bool ImportPipeline::KolejkaWierszy::wstaw(Wiersz wiersz) {
+    QMutexLocker locker(&mutex);
+    while (elementy.size() >= pojemnosc && !anulowana) {
+        niepelna.wait(&mutex);
+    }
+    if (anulowana) {
+        return false;
+    }
+
+    elementy.enqueue(std::move(wiersz));
+    niepusta.wakeOne();
+    return true;
+}
+
+bool ImportPipeline::KolejkaWierszy::pobierz(Wiersz& wiersz) {
+    QMutexLocker locker(&mutex);
+    while (elementy.isEmpty() && producenci > 0 && !anulowana) {
+        niepusta.wait(&mutex);
+    }
+    if (anulowana || elementy.isEmpty()) {
+        return false;
+    }
+
+    wiersz = elementy.dequeue();
+    niepelna.wakeOne();
+    return true;
+}
+
+void ImportPipeline::KolejkaWierszy::zakonczProducenta() {
+    QMutexLocker locker(&mutex);
+    if (--producenci == 0) {
+        niepusta.wakeAll();
+    }
+}
+
+void ImportPipeline::KolejkaWierszy::anuluj() {
+    QMutexLocker locker(&mutex);
+    anulowana = true;
+    elementy.clear();
+    niepusta.wakeAll();
+    niepelna.wakeAll();
+}
+
+// === Potok importu ===
+
+ImportPipeline::ImportPipeline(RodzajImportu rodzaj, const QString& filePath, QObject* parent)
+    : QObject(parent),
+      rodzaj(rodzaj),
+      filePath(filePath),
+      doWalidacji(POJEMNOSC_KOLEJKI, 1),
+      doZapisu(POJEMNOSC_KOLEJKI, liczbaWalidatorow()) {}
+
+ImportPipeline::~ImportPipeline() {
+    if (isRunning()) {
+        cancel();
+    }
+    wait();
+    qDeleteAll(watki);
+}
+
+bool ImportPipeline::start() {
+    if (!watki.isEmpty()) {
+        return false;
+    }
+
+    if (!reader.open(filePath)) {
+        blad = "Nie można otworzyć pliku: " + filePath;
+        return false;
+    }
+    rozmiarPliku = reader.size();
+    uzytkownicyCzytnika.storeRelease(1 + liczbaWalidatorow());
+
+    watki << QThread::create([this]() { czytaj(); });
+    for (int i = liczbaWalidatorow(); i > 0; --i) {
+        watki << QThread::create([this]() { waliduj(); });
+    }
+    watki << QThread::create([this]() { zapisuj(); });
+
+    for (QThread* watek : std::as_const(watki)) {
+        watek->start();
+    }
+    return true;
+}
+
+void ImportPipeline::cancel() {
+    anulowano.storeRelease(1);
+    doWalidacji.anuluj();
+    doZapisu.anuluj();
+}
+
+void ImportPipeline::wait() {
+    for (QThread* watek : std::as_const(watki)) {
+        watek->wait();
+    }
+}
+
+bool ImportPipeline::isRunning() const {
+    for (QThread* watek : watki) {
+        if (watek->isRunning()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int ImportPipeline::zaimportowane() const {
+    return liczbaZaimportowanych.loadAcquire();
+}
+
+QString ImportPipeline::errorString() const {
+    return blad;
+}
+
+void ImportPipeline::czytaj() {
+    // Pomiń nagłówek
+    reader.readRow();
+
+    qint64 numer = 0;
+    while (!anulowano.loadAcquire() && reader.readRow()) {
+        Wiersz wiersz;
+        wiersz.numer = numer++;
+        wiersz.linia = reader.lineNumber();
+        wiersz.pola = reader.row();
+        przeczytaneBajty.storeRelaxed(reader.position());
+
+        // Pełna kolejka wstrzymuje czytanie, dopóki walidatory nie nadrobią
+        if (!doWalidacji.wstaw(std::move(wiersz))) {
+            break;
+        }
+    }
+
+    doWalidacji.zakonczProducenta();
+    zwolnijCzytnik();
+}
+
+void ImportPipeline::waliduj() {
+    Wiersz wiersz;
+    while (doWalidacji.pobierz(wiersz)) {
+        QString errorMsg;
+        if (!DatabaseManager::sprawdzWierszCSV(rodzaj, wiersz.pola, wiersz.dane, errorMsg)) {
+            wiersz.blad = QString("Linia %1: %2").arg(wiersz.linia).arg(errorMsg);
+        }
+        wiersz.pola = CsvRow();   // zapis nie sięga już do pliku
+
+        if (!doZapisu.wstaw(std::move(wiersz))) {
+            break;
+        }
+    }
+
+    doZapisu.zakonczProducenta();
+    zwolnijCzytnik();
+}
+
+void ImportPipeline::zwolnijCzytnik() {
+    // Widoki pól wskazują na zmapowany plik - zamykamy go, gdy nikt już ich nie używa
+    if (!uzytkownicyCzytnika.deref()) {
+        reader.close();
+    }
+}
+
+void ImportPipeline::zapisuj() {
+    QStringList errors;
+    int wyslaneBledy = 0;
+
+    {
+        DatabaseManager::ZapisImportu zapis(rodzaj, errors);
+
+        // Walidatory kończą w dowolnej kolejności - wiersze czekają tu na swoją kolej,
+        // żeby o duplikatach w pliku decydowało pierwsze wystąpienie, jak przy imporcie sekwencyjnym
+        QMap<qint64, Wiersz> oczekujace;
+        qint64 nastepny = 0;
+
+        QElapsedTimer timer;
+        timer.start();
+
+        Wiersz wiersz;
+        while (doZapisu.pobierz(wiersz)) {
+            oczekujace.insert(wiersz.numer, std::move(wiersz));
+
+            auto it = oczekujace.begin();
+            while (it != oczekujace.end() && it.key() == nastepny) {
+                if (it->blad.isEmpty()) {
+                    zapis.zapisz(it->linia, it->dane);
+                } else {
+                    errors << it->blad;
+                }
+                it = oczekujace.erase(it);
+                ++nastepny;
+            }
+
+            if (timer.elapsed() >= ODSTEP_RAPORTU_MS) {
+                timer.restart();
+                emit postep(przeczytaneBajty.loadRelaxed(), rozmiarPliku, zapis.zaimportowane());
+                if (errors.size() > wyslaneBledy) {
+                    emit noweBledy(errors.mid(wyslaneBledy));
+                    wyslaneBledy = errors.size();
+                }
+            }
+        }
+
+        // Po anulowaniu zatwierdzamy to, co już zapisano w bieżącej partii
+        zapis.zakoncz();
+        liczbaZaimportowanych.storeRelease(zapis.zaimportowane());
+    }
+
+    const bool przerwany = anulowano.loadAcquire();
+    if (errors.size() > wyslaneBledy) {
+        emit noweBledy(errors.mid(wyslaneBledy));
+    }
+    emit postep(przerwany ? przeczytaneBajty.loadRelaxed() : rozmiarPliku, rozmiarPliku, zaimportowane());
+
+    qDebug() << "Zaimportowano" << zaimportowane() << DatabaseManager::nazwaRodzajuImportu(rodzaj)
+             << (przerwany ? "(import przerwany)" : "") << "- błędów:" << errors.size();
+    emit zakonczono(zaimportowane(), errors, przerwany);
+}
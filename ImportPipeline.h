@@ -0,0 +1,89 @@
+#ifndef IMPORTPIPELINE_H
+#define IMPORTPIPELINE_H
+
+#include <QObject>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QList>
+#include <QStringList>
+#include <QThread>
+#include <QAtomicInt>
+#include "CsvReader.h"
+#include "DatabaseManager.h"
+
+// Import CSV poza wątkiem GUI, w trzech etapach:
+//   czytnik (CsvReader) -> pula wątków walidujących -> jeden wątek zapisujący.
+// Etapy łączą kolejki o ograniczonej pojemności - szybszy etap czeka na wolniejszy,
+// więc w pamięci nigdy nie ląduje cały plik. Zapis działa na własnym połączeniu
+// z bazą (połączenia są per wątek) i partiami, jak DatabaseManager::import*FromCSV.
+class ImportPipeline : public QObject {
+    Q_OBJECT
+
+public:
+    explicit ImportPipeline(RodzajImportu rodzaj, const QString& filePath, QObject* parent = nullptr);
+    ~ImportPipeline() override;
+
+    bool start();                   // false gdy nie da się otworzyć pliku
+    void cancel();                  // zapisane dotąd partie zostają w bazie
+    void wait();
+    bool isRunning() const;
+
+    int zaimportowane() const;
+    QString errorString() const;
+
+signals:
+    // Sygnały wysyłane z wątku zapisującego (do GUI docierają przez kolejkę zdarzeń)
+    void postep(qint64 przeczytaneBajty, qint64 rozmiarPliku, int zaimportowane);
+    void noweBledy(const QStringList& bledy);
+    void zakonczono(int zaimportowane, const QStringList& bledy, bool anulowano);
+
+private:
+    struct Wiersz {
+        qint64 numer = 0;           // kolejność w pliku - zapis odbywa się w tej kolejności
+        int linia = 0;
+        CsvRow pola;                // widoki na plik - ważne, dopóki czytnik jest otwarty
+        WierszImportu dane;         // wypełnia walidacja; tylko to trafia do zapisu
+        QString blad;               // niepusty = wiersz odrzucony przy walidacji
+    };
+
+    // Kolejka blokująca o stałej pojemności; zamyka się, gdy skończą wszyscy producenci
+    class KolejkaWierszy {
+    public:
+        KolejkaWierszy(int pojemnosc, int producenci);
+
+        bool wstaw(Wiersz wiersz);      // false gdy import anulowano
+        bool pobierz(Wiersz& wiersz);   // false gdy kolejka jest pusta i zamknięta
+        void zakonczProducenta();
+        void anuluj();
+
+    private:
+        QMutex mutex;
+        QWaitCondition niepusta;
+        QWaitCondition niepelna;
+        QQueue<Wiersz> elementy;
+        int pojemnosc;
+        int producenci;
+        bool anulowana = false;
+    };
+
+    void czytaj();
+    void waliduj();
+    void zapisuj();
+    void zwolnijCzytnik();          // ostatni wątek korzystający z widoków zamyka plik
+
+    RodzajImportu rodzaj;
+    QString filePath;
+    QString blad;
+    CsvReader reader;
+    qint64 rozmiarPliku = 0;
+    QAtomicInt uzytkownicyCzytnika;             // czytnik + walidatory
+    KolejkaWierszy doWalidacji;
+    KolejkaWierszy doZapisu;
+    QList<QThread*> watki;
+    QAtomicInt anulowano;
+    QAtomicInteger<qint64> przeczytaneBajty;
+    QAtomicInt liczbaZaimportowanych;
+};
+
+#endif // IMPORTPIPELINE_H
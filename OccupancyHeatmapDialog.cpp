@@ -0,0 +1,213 @@
+#include "OccupancyHeatmapDialog.h"
+#include "QueryExecutor.h"
+#include <QDialogButtonBox>
+#include <QGridLayout>
+#include <QHeaderView>
+#include <QLocale>
+#include <QPushButton>
+#include <QVBoxLayout>
+#include <algorithm>
+
+namespace {
+
+const int DNI_TYGODNIA = 7;
+const int GODZINY = 24;
+
+struct FiltryMapy {
+    QStringList nazwy;
+    QStringList trenerzy;
+};
+
+} // namespace
+
+OccupancyHeatmapDialog::OccupancyHeatmapDialog(QueryExecutor* zapytania, QWidget* parent)
+    : QDialog(parent),
+      zapytania(zapytania),
+      dataOd(new QDateEdit(this)),
+      dataDo(new QDateEdit(this)),
+      nazwa(new QComboBox(this)),
+      trener(new QComboBox(this)),
+      tabela(new QTableView(this)),
+      model(new QStandardItemModel(DNI_TYGODNIA, GODZINY, this)),
+      podsumowanie(new QLabel(this)) {
+    setWindowTitle("Mapa obłożenia zajęć");
+    resize(900, 420);
+
+    // Domyślnie ostatnie 3 miesiące
+    const QDate dzisiaj = QDate::currentDate();
+    dataOd->setCalendarPopup(true);
+    dataOd->setDisplayFormat("yyyy-MM-dd");
+    dataOd->setDate(dzisiaj.addMonths(-3));
+    dataDo->setCalendarPopup(true);
+    dataDo->setDisplayFormat("yyyy-MM-dd");
+    dataDo->setDate(dzisiaj);
+
+    // Pusta wartość = bez zawężania
+    nazwa->addItem("Wszystkie zajęcia", QString());
+    trener->addItem("Wszyscy trenerzy", QString());
+
+    QPushButton* pokaz = new QPushButton("Pokaż", this);
+
+    QGridLayout* kryteria = new QGridLayout;
+    kryteria->addWidget(new QLabel("Od:", this), 0, 0);
+    kryteria->addWidget(dataOd, 0, 1);
+    kryteria->addWidget(new QLabel("Do:", this), 0, 2);
+    kryteria->addWidget(dataDo, 0, 3);
+    kryteria->addWidget(new QLabel("Zajęcia:", this), 1, 0);
+    kryteria->addWidget(nazwa, 1, 1);
+    kryteria->addWidget(new QLabel("Trener:", this), 1, 2);
+    kryteria->addWidget(trener, 1, 3);
+    kryteria->setColumnStretch(4, 1);
+    kryteria->addWidget(pokaz, 1, 5);
+
+    QStringList dni;
+    for (int dzien = 1; dzien <= DNI_TYGODNIA; ++dzien) {
+        dni << QLocale().dayName(dzien, QLocale::ShortFormat);
+    }
+    QStringList godziny;
+    for (int godzina = 0; godzina < GODZINY; ++godzina) {
+        godziny << QString("%1:00").arg(godzina, 2, 10, QChar('0'));
+    }
+    model->setVerticalHeaderLabels(dni);
+    model->setHorizontalHeaderLabels(godziny);
+
+    tabela->setModel(model);
+    tabela->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    tabela->setSelectionMode(QAbstractItemView::NoSelection);
+    tabela->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    tabela->verticalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+
+    QDialogButtonBox* przyciski = new QDialogButtonBox(QDialogButtonBox::Close, this);
+
+    QVBoxLayout* uklad = new QVBoxLayout(this);
+    uklad->addLayout(kryteria);
+    uklad->addWidget(tabela);
+    uklad->addWidget(podsumowanie);
+    uklad->addWidget(przyciski);
+
+    connect(pokaz, &QPushButton::clicked, this, &OccupancyHeatmapDialog::odswiez);
+    connect(nazwa, QOverload<int>::of(&QComboBox::activated), this, &OccupancyHeatmapDialog::odswiez);
+    connect(trener, QOverload<int>::of(&QComboBox::activated), this, &OccupancyHeatmapDialog::odswiez);
+    connect(przyciski, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    DatabaseNotifier* powiadomienia = DatabaseNotifier::instance();
+    connect(powiadomienia, &DatabaseNotifier::zmieniono, this, [this](TabelaDanych zmieniona, int, OperacjaZmiany) {
+        daneZmienione(zmieniona);
+    });
+    connect(powiadomienia, &DatabaseNotifier::przeladowano, this, &OccupancyHeatmapDialog::daneZmienione);
+
+    wczytajFiltry();
+    odswiez();
+}
+
+void OccupancyHeatmapDialog::wczytajFiltry() {
+    // Same różne wartości (SELECT DISTINCT po indeksach), nie pełna lista zajęć
+    zapytania->uruchom("mapa-oblozenia-filtry", []() {
+        FiltryMapy filtry;
+        filtry.nazwy = DatabaseManager::getNazwyZajec();
+        filtry.trenerzy = DatabaseManager::getTrenerzyZajec();
+        std::sort(filtry.nazwy.begin(), filtry.nazwy.end(), [](const QString& a, const QString& b) {
+            return QString::localeAwareCompare(a, b) < 0;
+        });
+        std::sort(filtry.trenerzy.begin(), filtry.trenerzy.end(), [](const QString& a, const QString& b) {
+            return QString::localeAwareCompare(a, b) < 0;
+        });
+        return filtry;
+    }, this, [this](const FiltryMapy& filtry) {
+        // Wybór użytkownika zostaje, jeśli wartość nadal istnieje
+        const QString wybranaNazwa = nazwa->currentData().toString();
+        const QString wybranyTrener = trener->currentData().toString();
+
+        while (nazwa->count() > 1) {
+            nazwa->removeItem(1);
+        }
+        for (const QString& n : filtry.nazwy) {
+            nazwa->addItem(n, n);
+        }
+        while (trener->count() > 1) {
+            trener->removeItem(1);
+        }
+        for (const QString& t : filtry.trenerzy) {
+            trener->addItem(t, t);
+        }
+
+        nazwa->setCurrentIndex(qMax(0, nazwa->findData(wybranaNazwa)));
+        trener->setCurrentIndex(qMax(0, trener->findData(wybranyTrener)));
+    });
+}
+
+void OccupancyHeatmapDialog::odswiez() {
+    const QDate od = dataOd->date();
+    const QDate doDnia = dataDo->date();
+    const QString wybranaNazwa = nazwa->currentData().toString();
+    const QString wybranyTrener = trener->currentData().toString();
+
+    if (od > doDnia) {
+        pokazMape(MapaOblozenia());
+        podsumowanie->setText("Data początkowa jest późniejsza niż końcowa.");
+        return;
+    }
+
+    podsumowanie->setText("Wczytywanie...");
+    zapytania->uruchom("mapa-oblozenia", [od, doDnia, wybranaNazwa, wybranyTrener]() {
+        return DatabaseManager::getMapaOblozenia(od, doDnia, wybranaNazwa, wybranyTrener);
+    }, this, [this](const MapaOblozenia& mapa) {
+        pokazMape(mapa);
+    });
+}
+
+void OccupancyHeatmapDialog::pokazMape(const MapaOblozenia& mapa) {
+    int zajecia = 0;
+    int rezerwacje = 0;
+    int miejsca = 0;
+    bool godzinaUzyta[GODZINY] = {};
+
+    for (int dzien = 1; dzien <= DNI_TYGODNIA; ++dzien) {
+        for (int godzina = 0; godzina < GODZINY; ++godzina) {
+            const KomorkaOblozenia& komorka = mapa.komorka(dzien, godzina);
+            QStandardItem* pole = new QStandardItem;
+            pole->setTextAlignment(Qt::AlignCenter);
+
+            if (komorka.zajecia > 0) {
+                pole->setText(QString("%1%").arg(qRound(komorka.oblozenie() * 100)));
+                pole->setBackground(kolorOblozenia(komorka.oblozenie()));
+                pole->setToolTip(QString("Zajęć: %1\nZajęte miejsca: %2 z %3")
+                                     .arg(komorka.zajecia).arg(komorka.rezerwacje).arg(komorka.miejsca));
+                godzinaUzyta[godzina] = true;
+            }
+            model->setItem(dzien - 1, godzina, pole);
+
+            zajecia += komorka.zajecia;
+            rezerwacje += komorka.rezerwacje;
+            miejsca += komorka.miejsca;
+        }
+    }
+
+    // Godziny bez żadnych zajęć tylko zabierają miejsce
+    for (int godzina = 0; godzina < GODZINY; ++godzina) {
+        tabela->setColumnHidden(godzina, zajecia > 0 && !godzinaUzyta[godzina]);
+    }
+
+    if (zajecia == 0) {
+        podsumowanie->setText("Brak zajęć w wybranym przedziale.");
+    } else {
+        podsumowanie->setText(QString("Zajęć: %1, zajęte miejsca: %2 z %3 (%4%)")
+                                  .arg(zajecia).arg(rezerwacje).arg(miejsca)
+                                  .arg(miejsca > 0 ? qRound(100.0 * rezerwacje / miejsca) : 0));
+    }
+}
+
+void OccupancyHeatmapDialog::daneZmienione(TabelaDanych zmieniona) {
+    if (zmieniona == TabelaDanych::Zajecia) {
+        wczytajFiltry();
+    }
+    if (zmieniona == TabelaDanych::Zajecia || zmieniona == TabelaDanych::Rezerwacje) {
+        odswiez();
+    }
+}
+
+QColor OccupancyHeatmapDialog::kolorOblozenia(double oblozenie) {
+    // Od zieleni (puste) przez żółty do czerwieni (pełne)
+    const double o = qBound(0.0, oblozenie, 1.0);
+    return QColor::fromHsv(qRound(120 * (1.0 - o)), 110, 255);
+}
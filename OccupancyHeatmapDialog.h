@@ -0,0 +1,44 @@
+#ifndef OCCUPANCYHEATMAPDIALOG_H
+#define OCCUPANCYHEATMAPDIALOG_H
+
+#include <QDialog>
+#include <QColor>
+#include <QComboBox>
+#include <QDateEdit>
+#include <QLabel>
+#include <QStandardItemModel>
+#include <QTableView>
+#include "DatabaseManager.h"
+#include "DatabaseNotifier.h"
+
+class QueryExecutor;
+
+// Mapa obłożenia zajęć: dni tygodnia w wierszach, godziny rozpoczęcia w kolumnach, kolor
+// komórki wg odsetka zajętych miejsc. Dane z DatabaseManager::getMapaOblozenia pobierane
+// w tle; zawęża się do jednych zajęć albo jednego trenera. Zapisy zajęć i rezerwacji
+// w trakcie oglądania odświeżają mapę.
+class OccupancyHeatmapDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    explicit OccupancyHeatmapDialog(QueryExecutor* zapytania, QWidget* parent = nullptr);
+
+private:
+    void wczytajFiltry();
+    void odswiez();
+    void pokazMape(const MapaOblozenia& mapa);
+    void daneZmienione(TabelaDanych zmieniona);
+
+    static QColor kolorOblozenia(double oblozenie);
+
+    QueryExecutor* zapytania;
+    QDateEdit* dataOd;
+    QDateEdit* dataDo;
+    QComboBox* nazwa;
+    QComboBox* trener;
+    QTableView* tabela;
+    QStandardItemModel* model;
+    QLabel* podsumowanie;
+};
+
+#endif // OCCUPANCYHEATMAPDIALOG_H
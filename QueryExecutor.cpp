@@ -0,0 +1,57 @@
+#include "QueryExecutor.h"
+
+QueryExecutor::QueryExecutor(QObject* parent)
+    : QObject(parent) {
+    // Jeden wątek, który nie wygasa - zadania idą po kolei, a połączenie z bazą
+    // (trzymane przez DatabaseManager per wątek) żyje tak długo jak wykonawca
+    pula.setMaxThreadCount(1);
+    pula.setExpiryTimeout(-1);
+}
+
+QueryExecutor::~QueryExecutor() {
+    {
+        QMutexLocker locker(&mutex);
+        zamykanie = true;
+    }
+    pula.clear();
+    pula.waitForDone();
+}
+
+void QueryExecutor::anuluj(const QString& kanal) {
+    // Kanału bez wpisu nie trzeba anulować - nie ma w nim żadnego zadania
+    QMutexLocker locker(&mutex);
+    auto it = kanaly.find(kanal);
+    if (it != kanaly.end()) {
+        it->generacja = ++ostatniaGeneracja;
+    }
+}
+
+void QueryExecutor::anulujWszystko() {
+    QMutexLocker locker(&mutex);
+    for (auto it = kanaly.begin(); it != kanaly.end(); ++it) {
+        it->generacja = ++ostatniaGeneracja;
+    }
+}
+
+int QueryExecutor::noweZadanie(const QString& kanal) {
+    QMutexLocker locker(&mutex);
+    Kanal& k = kanaly[kanal];
+    ++k.zadania;
+    k.generacja = ++ostatniaGeneracja;
+    return k.generacja;
+}
+
+void QueryExecutor::zakonczZadanie(const QString& kanal) {
+    // Ostatnie zadanie kanału zakończone - wpis znika, żeby kanały z id się nie gromadziły
+    QMutexLocker locker(&mutex);
+    auto it = kanaly.find(kanal);
+    if (it != kanaly.end() && --it->zadania == 0) {
+        kanaly.erase(it);
+    }
+}
+
+bool QueryExecutor::czyAktualne(const QString& kanal, int generacja) const {
+    QMutexLocker locker(&mutex);
+    auto it = kanaly.constFind(kanal);
+    return !zamykanie && it != kanaly.constEnd() && it->generacja == generacja;
+}
@@ -0,0 +1,113 @@
+#ifndef QUERYEXECUTOR_H
+#define QUERYEXECUTOR_H
+
+#include <QObject>
+#include <QFuture>
+#include <QPromise>
+#include <QThreadPool>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <memory>
+#include <type_traits>
+
+// Zapytania do bazy wykonywane poza wątkiem GUI. Zadania trafiają kolejno do jednego
+// wątku roboczego - DatabaseManager otwiera w nim własne połączenie przy pierwszym użyciu.
+//
+// Każde zadanie należy do kanału (np. "klienci"). Nowe zadanie w kanale zastępuje
+// starsze: zadanie, które jeszcze nie ruszyło, w ogóle nie wykonuje zapytania, a wynik
+// nieaktualnego zadania nie jest dostarczany (przyszłość kończy się anulowaniem).
+// Kanał istnieje tylko, dopóki ma zadania - nazwy z id (np. "klient-%1") nie zostają w pamięci.
+class QueryExecutor : public QObject {
+    Q_OBJECT
+
+public:
+    explicit QueryExecutor(QObject* parent = nullptr);
+    ~QueryExecutor() override;
+
+    // Wynik jako QFuture - w GUI odbierany przez then(kontekst, ...)
+    template<typename Funkcja>
+    QFuture<std::invoke_result_t<Funkcja>> uruchom(const QString& kanal, Funkcja zadanie);
+
+    // Jak wyżej, ale odbiorca dostaje wynik w wątku obiektu kontekst i tylko wtedy, gdy
+    // kanał nie dostał w międzyczasie nowszego zadania (sprawdzane już w wątku GUI)
+    template<typename Funkcja, typename Odbiorca>
+    QFuture<void> uruchom(const QString& kanal, Funkcja zadanie, QObject* kontekst, Odbiorca odbiorca);
+
+    void anuluj(const QString& kanal);     // porzuca zadania kanału bez zlecania nowego
+    void anulujWszystko();
+
+private:
+    struct Kanal {
+        int generacja = 0;          // najnowsze zadanie kanału (albo anulowanie)
+        int zadania = 0;            // zlecone, a jeszcze niezakończone (z odbiorcą: niedostarczone)
+    };
+
+    // odbiorcaKonczy: wynik odbiera uruchom() z odbiorcą i to on kończy zadanie po dostarczeniu
+    template<typename Funkcja>
+    QFuture<std::invoke_result_t<Funkcja>> zlec(const QString& kanal, int generacja, Funkcja zadanie, bool odbiorcaKonczy);
+
+    int noweZadanie(const QString& kanal);
+    void zakonczZadanie(const QString& kanal);
+    bool czyAktualne(const QString& kanal, int generacja) const;
+
+    QThreadPool pula;
+    mutable QMutex mutex;
+    QHash<QString, Kanal> kanaly;
+    int ostatniaGeneracja = 0;      // wspólna dla kanałów - kanał utworzony ponownie nie powtarza numerów
+    bool zamykanie = false;
+};
+
+template<typename Funkcja>
+QFuture<std::invoke_result_t<Funkcja>> QueryExecutor::uruchom(const QString& kanal, Funkcja zadanie) {
+    return zlec(kanal, noweZadanie(kanal), std::move(zadanie), false);
+}
+
+template<typename Funkcja>
+QFuture<std::invoke_result_t<Funkcja>> QueryExecutor::zlec(const QString& kanal, int generacja, Funkcja zadanie, bool odbiorcaKonczy) {
+    using Wynik = std::invoke_result_t<Funkcja>;
+    static_assert(!std::is_void_v<Wynik>, "Zadanie QueryExecutor musi zwracać wynik");
+
+    auto obietnica = std::make_shared<QPromise<Wynik>>();
+    QFuture<Wynik> przyszlosc = obietnica->future();
+
+    obietnica->start();
+    pula.start([this, kanal, generacja, obietnica, zadanie, odbiorcaKonczy]() {
+        bool jestWynik = false;
+        if (czyAktualne(kanal, generacja)) {
+            Wynik wynik = zadanie();
+            if (czyAktualne(kanal, generacja)) {
+                obietnica->addResult(std::move(wynik));
+                jestWynik = true;
+            } else {
+                obietnica->future().cancel();
+            }
+        } else {
+            obietnica->future().cancel();
+        }
+        obietnica->finish();
+        // Anulowana przyszłość nie uruchomi odbiorcy - zadanie kończy się tutaj
+        if (!jestWynik || !odbiorcaKonczy) {
+            zakonczZadanie(kanal);
+        }
+    });
+
+    return przyszlosc;
+}
+
+template<typename Funkcja, typename Odbiorca>
+QFuture<void> QueryExecutor::uruchom(const QString& kanal, Funkcja zadanie, QObject* kontekst, Odbiorca odbiorca) {
+    using Wynik = std::invoke_result_t<Funkcja>;
+
+    const int generacja = noweZadanie(kanal);
+    QFuture<Wynik> przyszlosc = zlec(kanal, generacja, std::move(zadanie), true);
+
+    return przyszlosc.then(kontekst, [this, kanal, generacja, odbiorca](const Wynik& wynik) {
+        if (czyAktualne(kanal, generacja)) {
+            odbiorca(wynik);
+        }
+        zakonczZadanie(kanal);
+    });
+}
+
+#endif // QUERYEXECUTOR_H
@@ -0,0 +1,144 @@
+#include "RevenueReportDialog.h"
+#include "QueryExecutor.h"
+#include <QDialogButtonBox>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QPushButton>
+#include <QVBoxLayout>
+
+RevenueReportDialog::RevenueReportDialog(QueryExecutor* zapytania, QWidget* parent)
+    : QDialog(parent),
+      zapytania(zapytania),
+      dataOd(new QDateEdit(this)),
+      dataDo(new QDateEdit(this)),
+      okres(new QComboBox(this)),
+      tabela(new QTableView(this)),
+      model(new QStandardItemModel(this)),
+      podsumowanie(new QLabel(this)) {
+    setWindowTitle("Raport przychodów z karnetów");
+    resize(640, 480);
+
+    // Domyślnie ostatnie 12 miesięcy, po miesiącu w wierszu
+    const QDate dzisiaj = QDate::currentDate();
+    dataOd->setCalendarPopup(true);
+    dataOd->setDisplayFormat("yyyy-MM-dd");
+    dataOd->setDate(QDate(dzisiaj.year(), dzisiaj.month(), 1).addMonths(-11));
+    dataDo->setCalendarPopup(true);
+    dataDo->setDisplayFormat("yyyy-MM-dd");
+    dataDo->setDate(dzisiaj);
+
+    okres->addItem("Dzień", static_cast<int>(OkresRaportu::Dzien));
+    okres->addItem("Tydzień", static_cast<int>(OkresRaportu::Tydzien));
+    okres->addItem("Miesiąc", static_cast<int>(OkresRaportu::Miesiac));
+    okres->setCurrentIndex(2);
+
+    QPushButton* pokaz = new QPushButton("Pokaż", this);
+
+    QHBoxLayout* kryteria = new QHBoxLayout;
+    kryteria->addWidget(new QLabel("Od:", this));
+    kryteria->addWidget(dataOd);
+    kryteria->addWidget(new QLabel("Do:", this));
+    kryteria->addWidget(dataDo);
+    kryteria->addWidget(new QLabel("Okres:", this));
+    kryteria->addWidget(okres);
+    kryteria->addStretch();
+    kryteria->addWidget(pokaz);
+
+    model->setHorizontalHeaderLabels({"Okres", "Typ karnetu", "Liczba karnetów", "Przychód"});
+    tabela->setModel(model);
+    tabela->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    tabela->setSelectionBehavior(QAbstractItemView::SelectRows);
+    tabela->verticalHeader()->setVisible(false);
+    tabela->horizontalHeader()->setStretchLastSection(true);
+    tabela->horizontalHeader()->resizeSection(0, 180);
+
+    QDialogButtonBox* przyciski = new QDialogButtonBox(QDialogButtonBox::Close, this);
+
+    QVBoxLayout* uklad = new QVBoxLayout(this);
+    uklad->addLayout(kryteria);
+    uklad->addWidget(tabela);
+    uklad->addWidget(podsumowanie);
+    uklad->addWidget(przyciski);
+
+    connect(pokaz, &QPushButton::clicked, this, &RevenueReportDialog::odswiez);
+    connect(okres, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &RevenueReportDialog::odswiez);
+    connect(przyciski, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    DatabaseNotifier* powiadomienia = DatabaseNotifier::instance();
+    connect(powiadomienia, &DatabaseNotifier::zmieniono, this, [this](TabelaDanych zmieniona, int, OperacjaZmiany) {
+        daneZmienione(zmieniona);
+    });
+    connect(powiadomienia, &DatabaseNotifier::przeladowano, this, &RevenueReportDialog::daneZmienione);
+
+    odswiez();
+}
+
+void RevenueReportDialog::odswiez() {
+    const QDate od = dataOd->date();
+    const QDate doDnia = dataDo->date();
+    const OkresRaportu wybranyOkres = static_cast<OkresRaportu>(okres->currentData().toInt());
+
+    if (od > doDnia) {
+        model->removeRows(0, model->rowCount());
+        podsumowanie->setText("Data początkowa jest późniejsza niż końcowa.");
+        return;
+    }
+
+    podsumowanie->setText("Wczytywanie...");
+    zapytania->uruchom("raport-przychodow", [od, doDnia, wybranyOkres]() {
+        return DatabaseManager::getPrzychodyKarnetow(od, doDnia, wybranyOkres);
+    }, this, [this, wybranyOkres](const QList<PrzychodOkresu>& przychody) {
+        pokazPrzychody(przychody, wybranyOkres);
+    });
+}
+
+void RevenueReportDialog::pokazPrzychody(const QList<PrzychodOkresu>& przychody, OkresRaportu wybranyOkres) {
+    model->removeRows(0, model->rowCount());
+
+    int liczbaRazem = 0;
+    double przychodRazem = 0.0;
+    for (const PrzychodOkresu& p : przychody) {
+        QStandardItem* liczba = new QStandardItem(QString::number(p.liczbaKarnetow));
+        liczba->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        QStandardItem* kwota = new QStandardItem(QString("%1 zł").arg(p.przychod, 0, 'f', 2));
+        kwota->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+
+        model->appendRow({new QStandardItem(opisOkresu(p, wybranyOkres)),
+                          new QStandardItem(p.typ.isEmpty() ? "(brak typu)" : p.typ),
+                          liczba,
+                          kwota});
+        liczbaRazem += p.liczbaKarnetow;
+        przychodRazem += p.przychod;
+    }
+
+    if (przychody.isEmpty()) {
+        podsumowanie->setText("Brak karnetów rozpoczętych w wybranym przedziale.");
+    } else {
+        podsumowanie->setText(QString("Razem: %1 karnetów, %2 zł")
+                                  .arg(liczbaRazem).arg(przychodRazem, 0, 'f', 2));
+    }
+}
+
+void RevenueReportDialog::daneZmienione(TabelaDanych zmieniona) {
+    if (zmieniona == TabelaDanych::Karnety) {
+        odswiez();
+    }
+}
+
+QString RevenueReportDialog::opisOkresu(const PrzychodOkresu& okres, OkresRaportu rodzaj) {
+    const QString zakres = QString("%1 – %2").arg(okres.poczatek.toString("yyyy-MM-dd"),
+                                                  okres.koniec.toString("yyyy-MM-dd"));
+    switch (rodzaj) {
+    case OkresRaportu::Dzien:
+        return okres.poczatek.toString("yyyy-MM-dd");
+    case OkresRaportu::Tydzien:
+        return zakres;
+    case OkresRaportu::Miesiac:
+        // Miesiąc przycięty do przedziału raportu opisujemy datami, żeby nie udawał pełnego
+        if (okres.poczatek.day() == 1 && okres.koniec.day() == okres.koniec.daysInMonth()) {
+            return okres.poczatek.toString("yyyy-MM");
+        }
+        return zakres;
+    }
+    return QString();
+}
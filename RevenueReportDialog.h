@@ -0,0 +1,40 @@
+#ifndef REVENUEREPORTDIALOG_H
+#define REVENUEREPORTDIALOG_H
+
+#include <QDialog>
+#include <QComboBox>
+#include <QDateEdit>
+#include <QLabel>
+#include <QStandardItemModel>
+#include <QTableView>
+#include "DatabaseManager.h"
+#include "DatabaseNotifier.h"
+
+class QueryExecutor;
+
+// Raport przychodów z karnetów w wybranym przedziale dat - dzień, tydzień albo miesiąc
+// w wierszu, osobno dla każdego typu karnetu. Dane z DatabaseManager::getPrzychodyKarnetow
+// pobierane w tle; zmiany karnetów w trakcie oglądania odświeżają raport.
+class RevenueReportDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    explicit RevenueReportDialog(QueryExecutor* zapytania, QWidget* parent = nullptr);
+
+private:
+    void odswiez();
+    void pokazPrzychody(const QList<PrzychodOkresu>& przychody, OkresRaportu wybranyOkres);
+    void daneZmienione(TabelaDanych zmieniona);
+
+    static QString opisOkresu(const PrzychodOkresu& okres, OkresRaportu rodzaj);
+
+    QueryExecutor* zapytania;
+    QDateEdit* dataOd;
+    QDateEdit* dataDo;
+    QComboBox* okres;
+    QTableView* tabela;
+    QStandardItemModel* model;
+    QLabel* podsumowanie;
+};
+
+#endif // REVENUEREPORTDIALOG_H
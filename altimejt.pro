@@ -9,13 +9,30 @@ CONFIG += c++17
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    ClientCompleter.cpp \
+    ClientDirectory.cpp \
+    CsvReader.cpp \
     DatabaseManager.cpp \
+    DatabaseNotifier.cpp \
+    ImportPipeline.cpp \
     main.cpp \
-    mainwindow.cpp
+    mainwindow.cpp \
+    OccupancyHeatmapDialog.cpp \
+    QueryExecutor.cpp \
+    RevenueReportDialog.cpp
 
 HEADERS += \
+    ClientCompleter.h \
+    ClientDirectory.h \
+    CsvReader.h \
     DatabaseManager.h \
-    mainwindow.h
+    DatabaseNotifier.h \
+    EntityTableModel.h \
+    ImportPipeline.h \
+    mainwindow.h \
+    OccupancyHeatmapDialog.h \
+    QueryExecutor.h \
+    RevenueReportDialog.h
 
 FORMS += \
     mainwindow.ui
@@ -32,14 +32,14 @@ void dodajPrzykladoweZajecia() {
         return;
     }
 
-    DatabaseManager::addZajecia("Aerobik", "Anna Nowakiewicz", 15, "2025-06-04", "09:00", 60, "Zajęcia cardio dla początkujących");
-    DatabaseManager::addZajecia("CrossFit", "Marcin Silny", 12, "2025-06-04", "10:30", 90, "Intensywny trening funkcjonalny");
-    DatabaseManager::addZajecia("Yoga", "Zen Master", 20, "2025-06-04", "18:00", 75, "Relaksacyjne zajęcia jogi");
-    DatabaseManager::addZajecia("Pilates", "Anna Nowakiewicz", 10, "2025-06-05", "08:00", 60, "Wzmacnianie mięśni głębokich");
-    DatabaseManager::addZajecia("Spinning", "Jakub Rowerzysta", 16, "2025-06-05", "19:00", 45, "Zajęcia na rowerach stacjonarnych");
-    DatabaseManager::addZajecia("Zumba", "Maria Taniec", 25, "2025-06-06", "17:30", 60, "Taneczne cardio");
-    DatabaseManager::addZajecia("TRX", "Marcin Silny", 8, "2025-06-06", "20:00", 50, "Trening z użyciem pasów TRX");
-    DatabaseManager::addZajecia("Aqua Aerobik", "Monika Wodna", 12, "2025-06-07", "11:00", 45, "Zajęcia w wodzie");
+    DatabaseManager::addZajecia("Aerobik", "Anna Nowakiewicz", 15, QDate(2025, 6, 4), QTime(9, 0), 60, "Zajęcia cardio dla początkujących");
+    DatabaseManager::addZajecia("CrossFit", "Marcin Silny", 12, QDate(2025, 6, 4), QTime(10, 30), 90, "Intensywny trening funkcjonalny");
+    DatabaseManager::addZajecia("Yoga", "Zen Master", 20, QDate(2025, 6, 4), QTime(18, 0), 75, "Relaksacyjne zajęcia jogi");
+    DatabaseManager::addZajecia("Pilates", "Anna Nowakiewicz", 10, QDate(2025, 6, 5), QTime(8, 0), 60, "Wzmacnianie mięśni głębokich");
+    DatabaseManager::addZajecia("Spinning", "Jakub Rowerzysta", 16, QDate(2025, 6, 5), QTime(19, 0), 45, "Zajęcia na rowerach stacjonarnych");
+    DatabaseManager::addZajecia("Zumba", "Maria Taniec", 25, QDate(2025, 6, 6), QTime(17, 30), 60, "Taneczne cardio");
+    DatabaseManager::addZajecia("TRX", "Marcin Silny", 8, QDate(2025, 6, 6), QTime(20, 0), 50, "Trening z użyciem pasów TRX");
+    DatabaseManager::addZajecia("Aqua Aerobik", "Monika Wodna", 12, QDate(2025, 6, 7), QTime(11, 0), 45, "Zajęcia w wodzie");
 
     qDebug() << "Dodano" << DatabaseManager::getZajeciaCount() << "zajęć do bazy";
 }
@@ -65,51 +65,51 @@ void dodajPrzykladoweRezerwacje() {
     // Dodaj przykładowe rezerwacje
     // Jan Kowalski zapisuje się na Aerobik i CrossFit
     if (klienci.size() > 0 && zajecia.size() > 0) {
-        DatabaseManager::addRezerwacja(klienci[0].id, zajecia[0].id, "aktywna"); // Jan -> Aerobik
+        DatabaseManager::addRezerwacja(klienci[0].id, zajecia[0].id, StatusRezerwacji::Aktywna); // Jan -> Aerobik
         if (zajecia.size() > 1) {
-            DatabaseManager::addRezerwacja(klienci[0].id, zajecia[1].id, "aktywna"); // Jan -> CrossFit
+            DatabaseManager::addRezerwacja(klienci[0].id, zajecia[1].id, StatusRezerwacji::Aktywna); // Jan -> CrossFit
         }
     }
 
     // Anna Nowak zapisuje się na Yoga i Pilates
     if (klienci.size() > 1 && zajecia.size() > 2) {
-        DatabaseManager::addRezerwacja(klienci[1].id, zajecia[2].id, "aktywna"); // Anna -> Yoga
+        DatabaseManager::addRezerwacja(klienci[1].id, zajecia[2].id, StatusRezerwacji::Aktywna); // Anna -> Yoga
         if (zajecia.size() > 3) {
-            DatabaseManager::addRezerwacja(klienci[1].id, zajecia[3].id, "aktywna"); // Anna -> Pilates
+            DatabaseManager::addRezerwacja(klienci[1].id, zajecia[3].id, StatusRezerwacji::Aktywna); // Anna -> Pilates
         }
     }
 
     // Piotr Wiśniewski zapisuje się na Spinning
     if (klienci.size() > 2 && zajecia.size() > 4) {
-        DatabaseManager::addRezerwacja(klienci[2].id, zajecia[4].id, "aktywna"); // Piotr -> Spinning
+        DatabaseManager::addRezerwacja(klienci[2].id, zajecia[4].id, StatusRezerwacji::Aktywna); // Piotr -> Spinning
     }
 
     // Maria Kowalczyk zapisuje się na Zumba
     if (klienci.size() > 3 && zajecia.size() > 5) {
-        DatabaseManager::addRezerwacja(klienci[3].id, zajecia[5].id, "aktywna"); // Maria -> Zumba
+        DatabaseManager::addRezerwacja(klienci[3].id, zajecia[5].id, StatusRezerwacji::Aktywna); // Maria -> Zumba
     }
 
     // Tomasz Zieliński zapisuje się na TRX
     if (klienci.size() > 4 && zajecia.size() > 6) {
-        DatabaseManager::addRezerwacja(klienci[4].id, zajecia[6].id, "aktywna"); // Tomasz -> TRX
+        DatabaseManager::addRezerwacja(klienci[4].id, zajecia[6].id, StatusRezerwacji::Aktywna); // Tomasz -> TRX
     }
 
     // Katarzyna Lewandowska zapisuje się na Yoga (miłośniczka jogi)
     if (klienci.size() > 5 && zajecia.size() > 2) {
-        DatabaseManager::addRezerwacja(klienci[5].id, zajecia[2].id, "aktywna"); // Katarzyna -> Yoga
+        DatabaseManager::addRezerwacja(klienci[5].id, zajecia[2].id, StatusRezerwacji::Aktywna); // Katarzyna -> Yoga
     }
 
     // Dodaj jeszcze kilka rezerwacji dla różnorodności
     if (klienci.size() > 0 && zajecia.size() > 5) {
-        DatabaseManager::addRezerwacja(klienci[0].id, zajecia[5].id, "aktywna"); // Jan -> Zumba
+        DatabaseManager::addRezerwacja(klienci[0].id, zajecia[5].id, StatusRezerwacji::Aktywna); // Jan -> Zumba
     }
     if (klienci.size() > 1 && zajecia.size() > 4) {
-        DatabaseManager::addRezerwacja(klienci[1].id, zajecia[4].id, "aktywna"); // Anna -> Spinning
+        DatabaseManager::addRezerwacja(klienci[1].id, zajecia[4].id, StatusRezerwacji::Aktywna); // Anna -> Spinning
     }
 
     // Dodaj jedną anulowaną rezerwację dla demonstracji
     if (klienci.size() > 2 && zajecia.size() > 0) {
-        DatabaseManager::addRezerwacja(klienci[2].id, zajecia[0].id, "anulowana"); // Piotr -> Aerobik (anulowana)
+        DatabaseManager::addRezerwacja(klienci[2].id, zajecia[0].id, StatusRezerwacji::Anulowana); // Piotr -> Aerobik (anulowana)
     }
 
     qDebug() << "Dodano" << DatabaseManager::getRezerwacjeCount() << "rezerwacji do bazy";
@@ -131,9 +131,9 @@ void testujFunkcjonalnoscRezerwacji() {
                         .arg(r.imieKlienta)
                         .arg(r.nazwiskoKlienta)
                         .arg(r.nazwaZajec)
-                        .arg(r.dataZajec)
-                        .arg(r.czasZajec)
-                        .arg(r.status);
+                        .arg(r.dataZajec.toString("yyyy-MM-dd"))
+                        .arg(r.czasZajec.toString("HH:mm"))
+                        .arg(DatabaseManager::nazwaStatusuRezerwacji(r.status));
     }
 
     // Test sprawdzania dostępności zajęć
@@ -142,10 +142,9 @@ void testujFunkcjonalnoscRezerwacji() {
 
     // Test liczenia aktywnych rezerwacji
     if (!dostepne.isEmpty()) {
-        int aktualne = DatabaseManager::getIloscAktywnychRezerwacji(dostepne.first().id);
         qDebug() << QString("Zajęcia '%1' mają %2 aktywnych rezerwacji")
                         .arg(dostepne.first().nazwa)
-                        .arg(aktualne);
+                        .arg(dostepne.first().aktualneRezerwacje);
     }
 
     // Test raportów
@@ -171,14 +170,13 @@ void testujFunkcjonalnoscZajec() {
 
     for (int i = 0; i < qMin(3, zajecia.size()); i++) {
         const Zajecia& z = zajecia[i];
-        int aktualne = DatabaseManager::getIloscAktywnychRezerwacji(z.id);
         qDebug() << QString("Zajęcia %1: %2 (%3) - %4 %5, zapisy: %6/%7")
                         .arg(z.id)
                         .arg(z.nazwa)
                         .arg(z.trener.isEmpty() ? "brak trenera" : z.trener)
-                        .arg(z.data.isEmpty() ? "brak daty" : z.data)
-                        .arg(z.czas.isEmpty() ? "brak czasu" : z.czas)
-                        .arg(aktualne)
+                        .arg(z.data.isValid() ? z.data.toString("yyyy-MM-dd") : "brak daty")
+                        .arg(z.czas.isValid() ? z.czas.toString("HH:mm") : "brak czasu")
+                        .arg(z.aktualneRezerwacje)
                         .arg(z.maksUczestnikow);
     }
 }
@@ -213,27 +211,40 @@ int main(int argc, char *argv[]) {
     qDebug() << "Katalog aplikacji:" << appDir;
     qDebug() << "Ścieżka do bazy:" << dbPath;
 
-    // 2) Połącz z bazą danych
+    // 2) Połącz z bazą danych (connect() tworzy/aktualizuje też schemat)
     if (!DatabaseManager::connect(dbPath)) {
         qCritical() << "Nie udało się połączyć z bazą danych!";
         return -1;
     }
 
-    // 3) Utwórz tabele
-    MainWindow w;
-    w.createTablesIfNotExist();
-
-    // 4) Dodaj przykładowe dane
+    // 3) Dodaj przykładowe dane
     dodajPrzykladowychKlientow();
     dodajPrzykladoweZajecia();
     dodajPrzykladoweRezerwacje();
 
-    // 5) Przetestuj funkcjonalność
+    // 4) Przetestuj funkcjonalność
     testujFunkcjonalnoscKlientow();
     testujFunkcjonalnoscZajec();
     testujFunkcjonalnoscRezerwacji();
 
-    // 6) Pokaż okno
+    StatystykiCache cacheZapytan = DatabaseManager::statementCacheStats();
+    qDebug() << QString("Cache zapytań: %1 trafień, %2 chybień, %3 przygotowanych zapytań")
+                    .arg(cacheZapytan.trafienia)
+                    .arg(cacheZapytan.chybienia)
+                    .arg(cacheZapytan.rozmiar);
+
+    StatystykiCacheEncji cacheEncji = DatabaseManager::entityCacheStats();
+    qDebug() << QString("Cache encji: klienci %1/%2, zajęcia %3/%4, karnety %5/%6 (trafienia/chybienia)")
+                    .arg(cacheEncji.klienci.trafienia).arg(cacheEncji.klienci.chybienia)
+                    .arg(cacheEncji.zajecia.trafienia).arg(cacheEncji.zajecia.chybienia)
+                    .arg(cacheEncji.karnety.trafienia).arg(cacheEncji.karnety.chybienia);
+
+    StatystykiCache cacheWynikow = DatabaseManager::resultCacheStats();
+    qDebug() << QString("Cache wyników list: %1 trafień, %2 chybień, %3 wyników w pamięci")
+                    .arg(cacheWynikow.trafienia).arg(cacheWynikow.chybienia).arg(cacheWynikow.rozmiar);
+
+    // 5) Pokaż okno
+    MainWindow w;
     w.show();
 
     int ret = a.exec();
@@ -1,21 +1,38 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 #include "DatabaseManager.h"
-#include <QtSql/QSqlQuery>
-#include <QtSql/QSqlError>
 #include <QDebug>
 #include <QHeaderView>
 #include <QMessageBox>
 #include <QDate>
 #include <QTime>
 #include <QApplication>
-#include <QBrush>
-#include <QColor>
 #include <QFileDialog>
 #include <QProgressDialog>
 #include <QStandardPaths>
 #include <QDesktopServices>
 #include <QUrl>
+#include <QDialog>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QProgressBar>
+#include <QListWidget>
+#include <QTextStream>
+#include "ImportPipeline.h"
+#include "OccupancyHeatmapDialog.h"
+#include "RevenueReportDialog.h"
+
+namespace {
+
+// Klucz sortowania pozycji ComboBoxa - pozwala wstawić pojedynczy wiersz na właściwe miejsce
+const int ROLA_KLUCZA = Qt::UserRole + 1;
+
+QString kluczZajec(const Zajecia& z) {
+    // Tekst w tych formatach sortuje się jak ORDER BY data, czas
+    return z.data.toString("yyyy-MM-dd") + QChar(0x1F) + z.czas.toString("HH:mm");
+}
+
+} // namespace
 
 // ==================== KONSTRUKTOR I DESTRUKTOR ====================
 
@@ -23,17 +40,26 @@ MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
     , aktualnieEdytowanyKlientId(-1)
+    , opoznienieWyszukiwaniaKlientow(new QTimer(this))
     , aktualnieEdytowaneZajeciaId(-1)
     , aktualnieWybranaRezerwacjaId(-1)
     , aktualnieEdytowanyKarnetId(-1)  // <- To powinno być w liście inicjalizacyjnej
+    , modelKlientow(new KlienciModel(this))
+    , modelZajec(new ZajeciaModel(this))
+    , modelRezerwacji(new RezerwacjeModel(this))
+    , modelKarnetow(new KarnetyModel(this))
+    , zapytania(new QueryExecutor(this))
+    , katalogKlientow(new ClientDirectory(zapytania, this))
+    , wyborKlientaRezerwacji(nullptr)
+    , wyborKlientaKarnetu(nullptr)
 {
     ui->setupUi(this);
     setupUI();
-    setupConnections();
     setupTableKlienci();
     setupTableZajecia();
     setupTableRezerwacje();
     setupTableKarnety();
+    setupConnections();   // po tabelach - sygnały zaznaczenia wymagają ustawionych modeli
 
     // Załaduj dane do wszystkich tabel
     odswiezListeKlientow();
@@ -47,75 +73,6 @@ MainWindow::~MainWindow()
     delete ui;
 }
 
-// ==================== TWORZENIE TABEL BAZY DANYCH ====================
-
-void MainWindow::createTablesIfNotExist() {
-    QSqlQuery query(DatabaseManager::instance());
-
-    // 1) Tabela klientów
-    if (!query.exec(R"(
-        CREATE TABLE IF NOT EXISTS klient (
-            id              INTEGER PRIMARY KEY AUTOINCREMENT,
-            imie            TEXT    NOT NULL,
-            nazwisko        TEXT    NOT NULL,
-            email           TEXT,
-            telefon         TEXT,
-            dataUrodzenia   TEXT,
-            dataRejestracji TEXT    NOT NULL,
-            uwagi           TEXT
-        )
-    )")) {
-        qWarning() << "Błąd tworzenia tabeli 'klient':" << query.lastError().text();
-    }
-
-    // 2) Tabela zajęć
-    if (!query.exec(R"(
-        CREATE TABLE IF NOT EXISTS zajecia (
-            id                INTEGER PRIMARY KEY AUTOINCREMENT,
-            nazwa             TEXT    NOT NULL,
-            trener            TEXT,
-            maksUczestnikow   INTEGER,
-            data              TEXT,   -- w formacie 'YYYY-MM-DD'
-            czas              TEXT,   -- np. 'HH:MM'
-            czasTrwania       INTEGER, -- w minutach
-            opis              TEXT
-        )
-    )")) {
-        qWarning() << "Błąd tworzenia tabeli 'zajecia':" << query.lastError().text();
-    }
-
-    // 3) Tabela karnetów (powiązana z klientem przez idKlienta)
-    if (!query.exec(R"(
-        CREATE TABLE IF NOT EXISTS karnet (
-            id               INTEGER PRIMARY KEY AUTOINCREMENT,
-            idKlienta        INTEGER    NOT NULL,
-            typ              TEXT,
-            dataRozpoczecia  TEXT,
-            dataZakonczenia  TEXT,
-            cena             REAL,
-            czyAktywny       INTEGER,   -- 0 lub 1
-            FOREIGN KEY(idKlienta) REFERENCES klient(id)
-        )
-    )")) {
-        qWarning() << "Błąd tworzenia tabeli 'karnet':" << query.lastError().text();
-    }
-
-    // 4) Tabela rezerwacji (powiązana z klientem i zajęciami)
-    if (!query.exec(R"(
-        CREATE TABLE IF NOT EXISTS rezerwacja (
-            id               INTEGER PRIMARY KEY AUTOINCREMENT,
-            idKlienta        INTEGER    NOT NULL,
-            idZajec          INTEGER    NOT NULL,
-            dataRezerwacji   TEXT,      -- format 'YYYY-MM-DD HH:MM:SS'
-            status           TEXT,
-            FOREIGN KEY(idKlienta) REFERENCES klient(id),
-            FOREIGN KEY(idZajec)   REFERENCES zajecia(id)
-        )
-    )")) {
-        qWarning() << "Błąd tworzenia tabeli 'rezerwacja':" << query.lastError().text();
-    }
-}
-
 // ==================== SLOTS DLA REZERWACJI ====================
 
 void MainWindow::dodajRezerwacje() {
@@ -126,24 +83,36 @@ void MainWindow::dodajRezerwacje() {
     // Pobierz ID klienta i zajęć z ComboBoxów
     int idKlienta = ui->comboBoxKlientRezerwacji->currentData().toInt();
     int idZajec = ui->comboBoxZajeciaRezerwacji->currentData().toInt();
-    QString status = ui->comboBoxStatusRezerwacji->currentText();
+    StatusRezerwacji status = DatabaseManager::statusRezerwacjiZNazwy(ui->comboBoxStatusRezerwacji->currentText())
+                                  .value_or(StatusRezerwacji::Aktywna);
 
     if (idKlienta <= 0 || idZajec <= 0) {
         pokazKomunikat("Błąd", "Wybierz prawidłowego klienta i zajęcia.", QMessageBox::Warning);
         return;
     }
 
-    bool sukces = DatabaseManager::addRezerwacja(idKlienta, idZajec, status);
+    WynikRezerwacji wynik = DatabaseManager::zarezerwuj(idKlienta, idZajec, status);
 
-    if (sukces) {
+    switch (wynik) {
+    case WynikRezerwacji::Ok:
         pokazKomunikat("Sukces", "Rezerwacja została dodana pomyślnie!", QMessageBox::Information);
         wyczyscFormularzRezerwacji();
-        odswiezListeRezerwacji();
-        // Odśwież też zajęcia, żeby zaktualizować liczby miejsc
-        zaladujZajeciaDoComboBox();
         ui->statusbar->showMessage("Dodano nową rezerwację", 3000);
-    } else {
-        pokazKomunikat("Błąd", "Nie udało się dodać rezerwacji.\nSprawdź czy:\n• Klient nie ma już rezerwacji na te zajęcia\n• Nie przekroczono limitu uczestników", QMessageBox::Warning);
+        break;
+    case WynikRezerwacji::Duplikat:
+        pokazKomunikat("Błąd", "Klient ma już aktywną rezerwację na te zajęcia.", QMessageBox::Warning);
+        break;
+    case WynikRezerwacji::BrakMiejsc:
+        pokazKomunikat("Błąd", "Brak wolnych miejsc - osiągnięto limit uczestników.", QMessageBox::Warning);
+        zaladujZajeciaDoComboBox();
+        break;
+    case WynikRezerwacji::NieznaneZajecia:
+        pokazKomunikat("Błąd", "Wybrane zajęcia nie istnieją (mogły zostać usunięte).", QMessageBox::Warning);
+        zaladujZajeciaDoComboBox();
+        break;
+    case WynikRezerwacji::Blad:
+        pokazKomunikat("Błąd", "Nie udało się dodać rezerwacji z powodu błędu bazy danych.", QMessageBox::Critical);
+        break;
     }
 }
 
@@ -167,12 +136,10 @@ void MainWindow::anulujRezerwacje() {
 
     // Możemy usunąć rezerwację lub zmienić status na "anulowana"
     // Używam zmiany statusu, żeby zachować historię
-    bool sukces = DatabaseManager::updateRezerwacjaStatus(aktualnieWybranaRezerwacjaId, "anulowana");
+    bool sukces = DatabaseManager::updateRezerwacjaStatus(aktualnieWybranaRezerwacjaId, StatusRezerwacji::Anulowana);
 
     if (sukces) {
         pokazKomunikat("Sukces", "Rezerwacja została anulowana!", QMessageBox::Information);
-        odswiezListeRezerwacji();
-        zaladujZajeciaDoComboBox(); // Odśwież dostępne miejsca
         aktualizujPrzyciskAnuluj();
         ui->statusbar->showMessage("Anulowano rezerwację", 3000);
     } else {
@@ -181,7 +148,7 @@ void MainWindow::anulujRezerwacje() {
 }
 
 void MainWindow::wyczyscFormularzRezerwacji() {
-    ui->comboBoxKlientRezerwacji->setCurrentIndex(-1);
+    wyborKlientaRezerwacji->wyczysc();
     ui->comboBoxZajeciaRezerwacji->setCurrentIndex(-1);
     ui->comboBoxStatusRezerwacji->setCurrentIndex(0); // "aktywna"
 
@@ -193,32 +160,42 @@ void MainWindow::wyczyscFormularzRezerwacji() {
 void MainWindow::filtrujRezerwacje() {
     QString statusFilter = ui->comboBoxFilterStatusRezerwacje->currentText();
 
-    QList<Rezerwacja> wszystkieRezerwacje = DatabaseManager::getAllRezerwacje();
-    QList<Rezerwacja> przefiltrowane;
-
-    for (const Rezerwacja& r : wszystkieRezerwacje) {
-        if (statusFilter == "Wszystkie rezerwacje" ||
-            (statusFilter == "Tylko aktywne" && r.status == "aktywna") ||
-            (statusFilter == "Tylko anulowane" && r.status == "anulowana")) {
-            przefiltrowane.append(r);
-        }
+    // Filtr trafia do zapytania - baza zwraca tylko pasujące wiersze, stronami
+    FiltrListy filtr;
+    if (statusFilter == "Tylko aktywne") {
+        filtr.status = StatusRezerwacji::Aktywna;
+    } else if (statusFilter == "Tylko anulowane") {
+        filtr.status = StatusRezerwacji::Anulowana;
     }
 
-    zaladujRezerwacjeDoTabeli(przefiltrowane);
-    ui->statusbar->showMessage(QString("Przefiltrowano do %1 rezerwacji").arg(przefiltrowane.size()), 3000);
+    filtrRezerwacji = filtr;
+    odswiezListeRezerwacji();
+
+    // Zastępuje licznik zlecony przez odświeżenie (ten sam kanał) - jedno COUNT(*) na filtr
+    zapytania->uruchom("rezerwacje-licznik", [filtr]() {
+        return DatabaseManager::getRezerwacjeCount(filtr);
+    }, this, [this](int liczba) {
+        ui->labelLiczbaRezerwacji->setText(QString("Liczba rezerwacji: %1").arg(liczba));
+        ui->statusbar->showMessage(QString("Przefiltrowano do %1 rezerwacji").arg(liczba), 3000);
+    });
 }
 
 void MainWindow::odswiezListeRezerwacji() {
-    QList<Rezerwacja> rezerwacje = DatabaseManager::getAllRezerwacje();
-    zaladujRezerwacjeDoTabeli(rezerwacje);
+    // Widok pobiera kolejne strony sam, gdy użytkownik przewija tabelę. Zapytania idą
+    // przez QueryExecutor - okno nie czeka na bazę, a wynik trafia do modelu po fakcie
+    const FiltrListy filtr = filtrRezerwacji;
+    modelRezerwacji->ustawZrodlo([this, filtr](const QString& token, int limit) {
+        return zapytania->uruchom("rezerwacje-strony", [filtr, token, limit]() {
+            return DatabaseManager::getRezerwacjeStrona(filtr, token, limit);
+        });
+    });
     aktualizujLicznikRezerwacji();
-    zaladujKlientowDoComboBox();
     zaladujZajeciaDoComboBox();
     ui->statusbar->showMessage("Lista rezerwacji odświeżona", 2000);
 }
 
 void MainWindow::rezerwacjaWybrana() {
-    int aktualnyWiersz = ui->tableWidgetRezerwacje->currentRow();
+    int aktualnyWiersz = ui->tableViewRezerwacje->currentIndex().row();
 
     if (aktualnyWiersz < 0) {
         aktualnieWybranaRezerwacjaId = -1;
@@ -226,12 +203,12 @@ void MainWindow::rezerwacjaWybrana() {
         return;
     }
 
-    QTableWidgetItem* idItem = ui->tableWidgetRezerwacje->item(aktualnyWiersz, 0);
-    if (!idItem) {
+    int rezerwacjaId = modelRezerwacji->idWiersza(aktualnyWiersz);
+    if (rezerwacjaId <= 0) {
         return;
     }
 
-    aktualnieWybranaRezerwacjaId = idItem->text().toInt();
+    aktualnieWybranaRezerwacjaId = rezerwacjaId;
     aktualizujPrzyciskAnuluj();
 }
 
@@ -275,6 +252,11 @@ void MainWindow::pokazAktywnychKlientow() {
     pokazKomunikat("Najaktywniejszi klienci", tekst, QMessageBox::Information);
 }
 
+void MainWindow::pokazMapeOblozenia() {
+    OccupancyHeatmapDialog mapa(zapytania, this);
+    mapa.exec();
+}
+
 // ==================== SETUP METODY ====================
 
 void MainWindow::setupUI() {
@@ -286,6 +268,15 @@ void MainWindow::setupUI() {
     // Ustaw domyślny czas
     ui->timeEditZajecia->setTime(QTime(9, 0)); // 09:00
 
+    // Wyszukiwanie klientów w trakcie pisania - zapytanie po 250 ms bez kolejnego znaku
+    opoznienieWyszukiwaniaKlientow->setSingleShot(true);
+    opoznienieWyszukiwaniaKlientow->setInterval(250);
+    ui->lineEditSearchKlienci->setPlaceholderText("Imię, nazwisko, e-mail, telefon lub uwagi...");
+
+    // Klienta wybiera się przez wyszukiwanie we wspólnym katalogu, nie z pełnej listy
+    wyborKlientaRezerwacji = new ClientCompleter(ui->comboBoxKlientRezerwacji, katalogKlientow, this);
+    wyborKlientaKarnetu = new ClientCompleter(ui->comboBoxKlientKarnetu, katalogKlientow, this);
+
     // Ustaw domyślne wartości dla rezerwacji
     ui->comboBoxStatusRezerwacji->setCurrentIndex(0); // "aktywna"
     wyczyscInfoZajec();
@@ -320,11 +311,14 @@ void MainWindow::setupConnections() {
     connect(ui->pushButtonShowAllKlienci, &QPushButton::clicked, this, &MainWindow::pokazWszystkichKlientow);
     connect(ui->pushButtonOdswiezKlienci, &QPushButton::clicked, this, &MainWindow::odswiezListeKlientow);
 
-    // === WYSZUKIWANIE KLIENTÓW ENTER ===
+    // === WYSZUKIWANIE KLIENTÓW ENTER I W TRAKCIE PISANIA ===
     connect(ui->lineEditSearchKlienci, &QLineEdit::returnPressed, this, &MainWindow::wyszukajKlientow);
+    connect(ui->lineEditSearchKlienci, &QLineEdit::textEdited,
+            opoznienieWyszukiwaniaKlientow, QOverload<>::of(&QTimer::start));
+    connect(opoznienieWyszukiwaniaKlientow, &QTimer::timeout, this, &MainWindow::wyszukajKlientow);
 
     // === TABELA KLIENTÓW ===
-    connect(ui->tableWidgetKlienci, &QTableWidget::itemSelectionChanged, this, &MainWindow::klientWybrany);
+    connect(ui->tableViewKlienci->selectionModel(), &QItemSelectionModel::selectionChanged, this, &MainWindow::klientWybrany);
 
     // === PRZYCISKI ZAJĘĆ ===
     connect(ui->pushButtonDodajZajecia, &QPushButton::clicked, this, &MainWindow::dodajZajecia);
@@ -340,7 +334,7 @@ void MainWindow::setupConnections() {
     connect(ui->lineEditSearchZajecia, &QLineEdit::returnPressed, this, &MainWindow::wyszukajZajecia);
 
     // === TABELA ZAJĘĆ ===
-    connect(ui->tableWidgetZajecia, &QTableWidget::itemSelectionChanged, this, &MainWindow::zajeciaWybrane);
+    connect(ui->tableViewZajecia->selectionModel(), &QItemSelectionModel::selectionChanged, this, &MainWindow::zajeciaWybrane);
 
     // === PRZYCISKI REZERWACJI ===
     connect(ui->pushButtonDodajRezerwacje, &QPushButton::clicked, this, &MainWindow::dodajRezerwacje);
@@ -350,12 +344,13 @@ void MainWindow::setupConnections() {
     connect(ui->pushButtonFilterRezerwacje, &QPushButton::clicked, this, &MainWindow::filtrujRezerwacje);
     connect(ui->pushButtonPokazStatystyki, &QPushButton::clicked, this, &MainWindow::pokazStatystyki);
     connect(ui->pushButtonPokazAktywnych, &QPushButton::clicked, this, &MainWindow::pokazAktywnychKlientow);
+    connect(ui->pushButtonMapaOblozenia, &QPushButton::clicked, this, &MainWindow::pokazMapeOblozenia);
 
     // === COMBOBOX REZERWACJI ===
     connect(ui->comboBoxZajeciaRezerwacji, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::zajeciaRezerwacjiWybrane);
 
     // === TABELA REZERWACJI ===
-    connect(ui->tableWidgetRezerwacje, &QTableWidget::itemSelectionChanged, this, &MainWindow::rezerwacjaWybrana);
+    connect(ui->tableViewRezerwacje->selectionModel(), &QItemSelectionModel::selectionChanged, this, &MainWindow::rezerwacjaWybrana);
 
     // === MENU ===
     connect(ui->actionZamknij, &QAction::triggered, this, &MainWindow::zamknijAplikacje);
@@ -370,13 +365,14 @@ void MainWindow::setupConnections() {
     connect(ui->pushButtonFilterKarnety, &QPushButton::clicked, this, &MainWindow::filtrujKarnety);
     connect(ui->pushButtonPokazStatystykiKarnety, &QPushButton::clicked, this, &MainWindow::pokazStatystykiKarnetow);
     connect(ui->pushButtonPokazWygasajace, &QPushButton::clicked, this, &MainWindow::pokazWygasajaceKarnety);
+    connect(ui->pushButtonRaportPrzychodow, &QPushButton::clicked, this, &MainWindow::pokazRaportPrzychodow);
 
     // === COMBOBOX KARNETÓW ===
     connect(ui->comboBoxKlientKarnetu, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::klientKarnetuWybrany);
     connect(ui->comboBoxTypKarnetu, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::obliczCeneKarnetu);
 
     // === TABELA KARNETÓW ===
-    connect(ui->tableWidgetKarnety, &QTableWidget::itemSelectionChanged, this, &MainWindow::karnetWybrany);
+    connect(ui->tableViewKarnety->selectionModel(), &QItemSelectionModel::selectionChanged, this, &MainWindow::karnetWybrany);
 
     // === MENU CSV ===
     connect(ui->actionEksportKlienciCSV, &QAction::triggered, this, &MainWindow::eksportKlienciCSV);
@@ -389,24 +385,26 @@ void MainWindow::setupConnections() {
     connect(ui->actionImportZajeciaCSV, &QAction::triggered, this, &MainWindow::importZajeciaCSV);
     connect(ui->actionImportRezerwacjeCSV, &QAction::triggered, this, &MainWindow::importRezerwacjeCSV);
     connect(ui->actionImportKarnetyCSV, &QAction::triggered, this, &MainWindow::importKarnetyCSV);
+
+    // === POWIADOMIENIA O ZMIANACH W BAZIE ===
+    DatabaseNotifier* powiadomienia = DatabaseNotifier::instance();
+    connect(powiadomienia, &DatabaseNotifier::zmieniono, this, &MainWindow::daneZmienione);
+    connect(powiadomienia, &DatabaseNotifier::przeladowano, this, &MainWindow::danePrzeladowane);
 }
 
 void MainWindow::setupTableKlienci() {
     // Konfiguracja tabeli klientów
-    ui->tableWidgetKlienci->setColumnCount(7);
-
-    QStringList headers = {"ID", "Imię", "Nazwisko", "Email", "Telefon", "Data urodzenia", "Data rejestracji"};
-    ui->tableWidgetKlienci->setHorizontalHeaderLabels(headers);
+    ui->tableViewKlienci->setModel(modelKlientow);
 
     // Ukryj kolumnę ID
-    ui->tableWidgetKlienci->setColumnHidden(0, true);
+    ui->tableViewKlienci->setColumnHidden(0, true);
 
     // Ustaw tryb zaznaczania całych wierszy
-    ui->tableWidgetKlienci->setSelectionBehavior(QAbstractItemView::SelectRows);
-    ui->tableWidgetKlienci->setSelectionMode(QAbstractItemView::SingleSelection);
+    ui->tableViewKlienci->setSelectionBehavior(QAbstractItemView::SelectRows);
+    ui->tableViewKlienci->setSelectionMode(QAbstractItemView::SingleSelection);
 
     // Ustaw szerokości kolumn
-    QHeaderView* header = ui->tableWidgetKlienci->horizontalHeader();
+    QHeaderView* header = ui->tableViewKlienci->horizontalHeader();
     header->setStretchLastSection(true);
     header->resizeSection(1, 120); // Imię
     header->resizeSection(2, 120); // Nazwisko
@@ -417,20 +415,17 @@ void MainWindow::setupTableKlienci() {
 
 void MainWindow::setupTableZajecia() {
     // Konfiguracja tabeli zajęć
-    ui->tableWidgetZajecia->setColumnCount(8);
-
-    QStringList headers = {"ID", "Nazwa", "Trener", "Data", "Godzina", "Czas trwania", "Limit", "Opis"};
-    ui->tableWidgetZajecia->setHorizontalHeaderLabels(headers);
+    ui->tableViewZajecia->setModel(modelZajec);
 
     // Ukryj kolumnę ID
-    ui->tableWidgetZajecia->setColumnHidden(0, true);
+    ui->tableViewZajecia->setColumnHidden(0, true);
 
     // Ustaw tryb zaznaczania całych wierszy
-    ui->tableWidgetZajecia->setSelectionBehavior(QAbstractItemView::SelectRows);
-    ui->tableWidgetZajecia->setSelectionMode(QAbstractItemView::SingleSelection);
+    ui->tableViewZajecia->setSelectionBehavior(QAbstractItemView::SelectRows);
+    ui->tableViewZajecia->setSelectionMode(QAbstractItemView::SingleSelection);
 
     // Ustaw szerokości kolumn
-    QHeaderView* header = ui->tableWidgetZajecia->horizontalHeader();
+    QHeaderView* header = ui->tableViewZajecia->horizontalHeader();
     header->setStretchLastSection(true);
     header->resizeSection(1, 120); // Nazwa
     header->resizeSection(2, 140); // Trener
@@ -442,20 +437,17 @@ void MainWindow::setupTableZajecia() {
 
 void MainWindow::setupTableRezerwacje() {
     // Konfiguracja tabeli rezerwacji
-    ui->tableWidgetRezerwacje->setColumnCount(8);
-
-    QStringList headers = {"ID", "Klient", "Zajęcia", "Trener", "Data zajęć", "Godzina", "Data rezerwacji", "Status"};
-    ui->tableWidgetRezerwacje->setHorizontalHeaderLabels(headers);
+    ui->tableViewRezerwacje->setModel(modelRezerwacji);
 
     // Ukryj kolumnę ID
-    ui->tableWidgetRezerwacje->setColumnHidden(0, true);
+    ui->tableViewRezerwacje->setColumnHidden(0, true);
 
     // Ustaw tryb zaznaczania całych wierszy
-    ui->tableWidgetRezerwacje->setSelectionBehavior(QAbstractItemView::SelectRows);
-    ui->tableWidgetRezerwacje->setSelectionMode(QAbstractItemView::SingleSelection);
+    ui->tableViewRezerwacje->setSelectionBehavior(QAbstractItemView::SelectRows);
+    ui->tableViewRezerwacje->setSelectionMode(QAbstractItemView::SingleSelection);
 
     // Ustaw szerokości kolumn
-    QHeaderView* header = ui->tableWidgetRezerwacje->horizontalHeader();
+    QHeaderView* header = ui->tableViewRezerwacje->horizontalHeader();
     header->setStretchLastSection(true);
     header->resizeSection(1, 150); // Klient
     header->resizeSection(2, 120); // Zajęcia
@@ -486,7 +478,6 @@ void MainWindow::dodajKlienta() {
     if (sukces) {
         pokazKomunikat("Sukces", "Klient został dodany pomyślnie!", QMessageBox::Information);
         wyczyscFormularzKlienta();
-        odswiezListeKlientow();
         ui->statusbar->showMessage("Dodano nowego klienta", 3000);
     } else {
         pokazKomunikat("Błąd", "Nie udało się dodać klienta.\nSprawdź czy email nie jest już używany.", QMessageBox::Warning);
@@ -517,7 +508,6 @@ void MainWindow::edytujKlienta() {
 
     if (sukces) {
         pokazKomunikat("Sukces", "Dane klienta zostały zaktualizowane!", QMessageBox::Information);
-        odswiezListeKlientow();
         ustawTrybDodawaniaKlienta();
         ui->statusbar->showMessage("Zaktualizowano dane klienta", 3000);
     } else {
@@ -534,7 +524,7 @@ void MainWindow::usunKlienta() {
     QMessageBox::StandardButton odpowiedz = QMessageBox::question(
         this,
         "Potwierdzenie",
-        QString("Czy na pewno chcesz usunąć klienta:\n%1 %2?\n\nTa operacja jest nieodwracalna!")
+        QString("Czy na pewno chcesz usunąć klienta:\n%1 %2?\n\nUsunięte zostaną także jego rezerwacje.\nTa operacja jest nieodwracalna!")
             .arg(ui->lineEditImie->text())
             .arg(ui->lineEditNazwisko->text()),
         QMessageBox::Yes | QMessageBox::No,
@@ -550,11 +540,10 @@ void MainWindow::usunKlienta() {
     if (sukces) {
         pokazKomunikat("Sukces", "Klient został usunięty!", QMessageBox::Information);
         wyczyscFormularzKlienta();
-        odswiezListeKlientow();
         ustawTrybDodawaniaKlienta();
         ui->statusbar->showMessage("Usunięto klienta", 3000);
     } else {
-        pokazKomunikat("Błąd", "Nie udało się usunąć klienta.", QMessageBox::Critical);
+        pokazKomunikat("Błąd", "Nie udało się usunąć klienta.\n\nKlienta, który ma karnety, nie można usunąć - karnety należą do historii sprzedaży.", QMessageBox::Critical);
     }
 }
 
@@ -570,17 +559,26 @@ void MainWindow::wyczyscFormularzKlienta() {
 }
 
 void MainWindow::wyszukajKlientow() {
-    QString nazwisko = ui->lineEditSearchKlienci->text().trimmed();
+    opoznienieWyszukiwaniaKlientow->stop();    // Enter albo przycisk - bez czekania
+    QString fraza = ui->lineEditSearchKlienci->text().trimmed();
 
-    if (nazwisko.isEmpty()) {
+    if (fraza.isEmpty()) {
         pokazWszystkichKlientow();
         return;
     }
 
-    QList<Klient> klienci = DatabaseManager::searchKlienciByNazwisko(nazwisko);
-    zaladujKlientowDoTabeli(klienci);
-
-    ui->statusbar->showMessage(QString("Znaleziono %1 klientów").arg(klienci.size()), 3000);
+    // Indeks pełnotekstowy; kolejne znaki wpisane w trakcie zapytania zastępują je (ten sam kanał)
+    const int limit = 200;
+    zapytania->uruchom("klienci", [fraza, limit]() {
+        return DatabaseManager::searchKlienci(fraza, limit);
+    }, this, [this, limit](const QList<Klient>& klienci) {
+        zaladujKlientowDoTabeli(klienci);
+        if (klienci.size() >= limit) {
+            ui->statusbar->showMessage(QString("Pokazano %1 najlepiej pasujących klientów").arg(klienci.size()), 3000);
+        } else {
+            ui->statusbar->showMessage(QString("Znaleziono %1 klientów").arg(klienci.size()), 3000);
+        }
+    });
 }
 
 void MainWindow::pokazWszystkichKlientow() {
@@ -589,26 +587,29 @@ void MainWindow::pokazWszystkichKlientow() {
 }
 
 void MainWindow::odswiezListeKlientow() {
-    QList<Klient> klienci = DatabaseManager::getAllKlienci();
-    zaladujKlientowDoTabeli(klienci);
+    zapytania->anuluj("klienci");
+    modelKlientow->ustawZrodlo([this](const QString& token, int limit) {
+        return zapytania->uruchom("klienci-strony", [token, limit]() {
+            return DatabaseManager::getKlienciStrona(token, limit);
+        });
+    });
     aktualizujLicznikKlientow();
     ui->statusbar->showMessage("Lista klientów odświeżona", 2000);
 }
 
 void MainWindow::klientWybrany() {
-    int aktualnyWiersz = ui->tableWidgetKlienci->currentRow();
+    int aktualnyWiersz = ui->tableViewKlienci->currentIndex().row();
 
     if (aktualnyWiersz < 0) {
         ustawTrybDodawaniaKlienta();
         return;
     }
 
-    QTableWidgetItem* idItem = ui->tableWidgetKlienci->item(aktualnyWiersz, 0);
-    if (!idItem) {
+    int klientId = modelKlientow->idWiersza(aktualnyWiersz);
+    if (klientId <= 0) {
         return;
     }
 
-    int klientId = idItem->text().toInt();
     Klient klient = DatabaseManager::getKlientById(klientId);
 
     if (klient.id > 0) {
@@ -640,7 +641,6 @@ void MainWindow::dodajZajecia() {
     if (sukces) {
         pokazKomunikat("Sukces", "Zajęcia zostały dodane pomyślnie!", QMessageBox::Information);
         wyczyscFormularzZajec();
-        odswiezListeZajec();
         ui->statusbar->showMessage("Dodano nowe zajęcia", 3000);
     } else {
         pokazKomunikat("Błąd", "Nie udało się dodać zajęć.\nSprawdź czy zajęcia o tej nazwie, dacie i czasie już nie istnieją.", QMessageBox::Warning);
@@ -672,7 +672,6 @@ void MainWindow::edytujZajecia() {
 
     if (sukces) {
         pokazKomunikat("Sukces", "Dane zajęć zostały zaktualizowane!", QMessageBox::Information);
-        odswiezListeZajec();
         ustawTrybDodawaniaZajec();
         ui->statusbar->showMessage("Zaktualizowano dane zajęć", 3000);
     } else {
@@ -689,7 +688,7 @@ void MainWindow::usunZajecia() {
     QMessageBox::StandardButton odpowiedz = QMessageBox::question(
         this,
         "Potwierdzenie",
-        QString("Czy na pewno chcesz usunąć zajęcia:\n%1?\n\nTa operacja jest nieodwracalna!")
+        QString("Czy na pewno chcesz usunąć zajęcia:\n%1?\n\nUsunięte zostaną także rezerwacje na te zajęcia.\nTa operacja jest nieodwracalna!")
             .arg(ui->lineEditNazwaZajec->text()),
         QMessageBox::Yes | QMessageBox::No,
         QMessageBox::No
@@ -704,7 +703,6 @@ void MainWindow::usunZajecia() {
     if (sukces) {
         pokazKomunikat("Sukces", "Zajęcia zostały usunięte!", QMessageBox::Information);
         wyczyscFormularzZajec();
-        odswiezListeZajec();
         ustawTrybDodawaniaZajec();
         ui->statusbar->showMessage("Usunięto zajęcia", 3000);
     } else {
@@ -732,22 +730,21 @@ void MainWindow::wyszukajZajecia() {
         return;
     }
 
-    QList<Zajecia> zajecia;
-
     // Sprawdź typ wyszukiwania
     int typWyszukiwania = ui->comboBoxSearchTypeZajecia->currentIndex();
-    if (typWyszukiwania == 0) {
-        // Wyszukiwanie po nazwie
-        zajecia = DatabaseManager::searchZajeciaByNazwa(fraza);
-    } else {
-        // Wyszukiwanie po trenerze
-        zajecia = DatabaseManager::searchZajeciaByTrener(fraza);
-    }
-
-    zaladujZajeciaDoTabeli(zajecia);
-
     QString typTekst = (typWyszukiwania == 0) ? "nazwie" : "trenerze";
-    ui->statusbar->showMessage(QString("Znaleziono %1 zajęć po %2").arg(zajecia.size()).arg(typTekst), 3000);
+
+    zapytania->uruchom("zajecia", [fraza, typWyszukiwania]() {
+        if (typWyszukiwania == 0) {
+            // Wyszukiwanie po nazwie
+            return DatabaseManager::searchZajeciaByNazwa(fraza);
+        }
+        // Wyszukiwanie po trenerze
+        return DatabaseManager::searchZajeciaByTrener(fraza);
+    }, this, [this, typTekst](const QList<Zajecia>& zajecia) {
+        zaladujZajeciaDoTabeli(zajecia);
+        ui->statusbar->showMessage(QString("Znaleziono %1 zajęć po %2").arg(zajecia.size()).arg(typTekst), 3000);
+    });
 }
 
 void MainWindow::pokazWszystkieZajecia() {
@@ -756,34 +753,40 @@ void MainWindow::pokazWszystkieZajecia() {
 }
 
 void MainWindow::filtrujZajeciaPoData() {
-    QString data = ui->dateEditFilterZajecia->date().toString("yyyy-MM-dd");
-    QList<Zajecia> zajecia = DatabaseManager::getZajeciaByData(data);
-    zaladujZajeciaDoTabeli(zajecia);
+    QDate data = ui->dateEditFilterZajecia->date();
 
-    ui->statusbar->showMessage(QString("Znaleziono %1 zajęć w dniu %2").arg(zajecia.size()).arg(data), 3000);
+    zapytania->uruchom("zajecia", [data]() {
+        return DatabaseManager::getZajeciaByData(data);
+    }, this, [this, data](const QList<Zajecia>& zajecia) {
+        zaladujZajeciaDoTabeli(zajecia);
+        ui->statusbar->showMessage(QString("Znaleziono %1 zajęć w dniu %2").arg(zajecia.size()).arg(data.toString("yyyy-MM-dd")), 3000);
+    });
 }
 
 void MainWindow::odswiezListeZajec() {
-    QList<Zajecia> zajecia = DatabaseManager::getAllZajecia();
-    zaladujZajeciaDoTabeli(zajecia);
+    zapytania->anuluj("zajecia");
+    modelZajec->ustawZrodlo([this](const QString& token, int limit) {
+        return zapytania->uruchom("zajecia-strony", [token, limit]() {
+            return DatabaseManager::getZajeciaStrona(token, limit);
+        });
+    });
     aktualizujLicznikZajec();
     ui->statusbar->showMessage("Lista zajęć odświeżona", 2000);
 }
 
 void MainWindow::zajeciaWybrane() {
-    int aktualnyWiersz = ui->tableWidgetZajecia->currentRow();
+    int aktualnyWiersz = ui->tableViewZajecia->currentIndex().row();
 
     if (aktualnyWiersz < 0) {
         ustawTrybDodawaniaZajec();
         return;
     }
 
-    QTableWidgetItem* idItem = ui->tableWidgetZajecia->item(aktualnyWiersz, 0);
-    if (!idItem) {
+    int zajeciaId = modelZajec->idWiersza(aktualnyWiersz);
+    if (zajeciaId <= 0) {
         return;
     }
 
-    int zajeciaId = idItem->text().toInt();
     Zajecia zajecia = DatabaseManager::getZajeciaById(zajeciaId);
 
     if (zajecia.id > 0) {
@@ -818,19 +821,7 @@ void MainWindow::oProgramie() {
 // ==================== METODY POMOCNICZE - KLIENCI ====================
 
 void MainWindow::zaladujKlientowDoTabeli(const QList<Klient>& klienci) {
-    ui->tableWidgetKlienci->setRowCount(klienci.size());
-
-    for (int i = 0; i < klienci.size(); ++i) {
-        const Klient& k = klienci[i];
-
-        ui->tableWidgetKlienci->setItem(i, 0, new QTableWidgetItem(QString::number(k.id)));
-        ui->tableWidgetKlienci->setItem(i, 1, new QTableWidgetItem(k.imie));
-        ui->tableWidgetKlienci->setItem(i, 2, new QTableWidgetItem(k.nazwisko));
-        ui->tableWidgetKlienci->setItem(i, 3, new QTableWidgetItem(k.email));
-        ui->tableWidgetKlienci->setItem(i, 4, new QTableWidgetItem(k.telefon));
-        ui->tableWidgetKlienci->setItem(i, 5, new QTableWidgetItem(k.dataUrodzenia));
-        ui->tableWidgetKlienci->setItem(i, 6, new QTableWidgetItem(k.dataRejestracji));
-    }
+    modelKlientow->ustawDane(klienci);
 }
 
 void MainWindow::zaladujKlientaDoFormularza(const Klient& klient) {
@@ -894,7 +885,7 @@ void MainWindow::ustawTrybDodawaniaKlienta() {
 
     ui->labelFormularzKlientaTitle->setText("Dodaj nowego klienta");
 
-    ui->tableWidgetKlienci->clearSelection();
+    ui->tableViewKlienci->clearSelection();
 }
 
 void MainWindow::ustawTrybEdycjiKlienta() {
@@ -906,27 +897,15 @@ void MainWindow::ustawTrybEdycjiKlienta() {
 }
 
 void MainWindow::aktualizujLicznikKlientow() {
-    int liczba = DatabaseManager::getKlienciCount();
-    ui->labelLiczbaKlientow->setText(QString("Liczba klientów: %1").arg(liczba));
+    zapytania->uruchom("klienci-licznik", &DatabaseManager::getKlienciCount, this, [this](int liczba) {
+        ui->labelLiczbaKlientow->setText(QString("Liczba klientów: %1").arg(liczba));
+    });
 }
 
 // ==================== METODY POMOCNICZE - ZAJĘCIA ====================
 
 void MainWindow::zaladujZajeciaDoTabeli(const QList<Zajecia>& zajecia) {
-    ui->tableWidgetZajecia->setRowCount(zajecia.size());
-
-    for (int i = 0; i < zajecia.size(); ++i) {
-        const Zajecia& z = zajecia[i];
-
-        ui->tableWidgetZajecia->setItem(i, 0, new QTableWidgetItem(QString::number(z.id)));
-        ui->tableWidgetZajecia->setItem(i, 1, new QTableWidgetItem(z.nazwa));
-        ui->tableWidgetZajecia->setItem(i, 2, new QTableWidgetItem(z.trener));
-        ui->tableWidgetZajecia->setItem(i, 3, new QTableWidgetItem(z.data));
-        ui->tableWidgetZajecia->setItem(i, 4, new QTableWidgetItem(z.czas));
-        ui->tableWidgetZajecia->setItem(i, 5, new QTableWidgetItem(QString("%1 min").arg(z.czasTrwania)));
-        ui->tableWidgetZajecia->setItem(i, 6, new QTableWidgetItem(QString::number(z.maksUczestnikow)));
-        ui->tableWidgetZajecia->setItem(i, 7, new QTableWidgetItem(z.opis));
-    }
+    modelZajec->ustawDane(zajecia);
 }
 
 void MainWindow::zaladujZajeciaDoFormularza(const Zajecia& zajecia) {
@@ -936,18 +915,12 @@ void MainWindow::zaladujZajeciaDoFormularza(const Zajecia& zajecia) {
     ui->spinBoxCzasTrwania->setValue(zajecia.czasTrwania);
     ui->textEditOpisZajec->setPlainText(zajecia.opis);
 
-    if (!zajecia.data.isEmpty()) {
-        QDate data = QDate::fromString(zajecia.data, "yyyy-MM-dd");
-        if (data.isValid()) {
-            ui->dateEditZajecia->setDate(data);
-        }
+    if (zajecia.data.isValid()) {
+        ui->dateEditZajecia->setDate(zajecia.data);
     }
 
-    if (!zajecia.czas.isEmpty()) {
-        QTime czas = QTime::fromString(zajecia.czas, "HH:mm");
-        if (czas.isValid()) {
-            ui->timeEditZajecia->setTime(czas);
-        }
+    if (zajecia.czas.isValid()) {
+        ui->timeEditZajecia->setTime(zajecia.czas);
     }
 }
 
@@ -957,8 +930,8 @@ Zajecia MainWindow::pobierzDaneZajecZFormularza() {
     zajecia.nazwa = ui->lineEditNazwaZajec->text().trimmed();
     zajecia.trener = ui->lineEditTrener->text().trimmed();
     zajecia.maksUczestnikow = ui->spinBoxMaksUczestnikow->value();
-    zajecia.data = ui->dateEditZajecia->date().toString("yyyy-MM-dd");
-    zajecia.czas = ui->timeEditZajecia->time().toString("HH:mm");
+    zajecia.data = ui->dateEditZajecia->date();
+    zajecia.czas = ui->timeEditZajecia->time();
     zajecia.czasTrwania = ui->spinBoxCzasTrwania->value();
     zajecia.opis = ui->textEditOpisZajec->toPlainText().trimmed();
 
@@ -989,7 +962,7 @@ void MainWindow::ustawTrybDodawaniaZajec() {
 
     ui->labelFormularzZajeciaTitle->setText("Dodaj nowe zajęcia");
 
-    ui->tableWidgetZajecia->clearSelection();
+    ui->tableViewZajecia->clearSelection();
 }
 
 void MainWindow::ustawTrybEdycjiZajec() {
@@ -1001,80 +974,26 @@ void MainWindow::ustawTrybEdycjiZajec() {
 }
 
 void MainWindow::aktualizujLicznikZajec() {
-    int liczba = DatabaseManager::getZajeciaCount();
-    ui->labelLiczbaZajec->setText(QString("Liczba zajęć: %1").arg(liczba));
+    zapytania->uruchom("zajecia-licznik", &DatabaseManager::getZajeciaCount, this, [this](int liczba) {
+        ui->labelLiczbaZajec->setText(QString("Liczba zajęć: %1").arg(liczba));
+    });
 }
 
 // ==================== METODY POMOCNICZE - REZERWACJE ====================
 
-void MainWindow::zaladujRezerwacjeDoTabeli(const QList<Rezerwacja>& rezerwacje) {
-    ui->tableWidgetRezerwacje->setRowCount(rezerwacje.size());
-
-    for (int i = 0; i < rezerwacje.size(); ++i) {
-        const Rezerwacja& r = rezerwacje[i];
-
-        ui->tableWidgetRezerwacje->setItem(i, 0, new QTableWidgetItem(QString::number(r.id)));
-        ui->tableWidgetRezerwacje->setItem(i, 1, new QTableWidgetItem(QString("%1 %2").arg(r.imieKlienta).arg(r.nazwiskoKlienta)));
-        ui->tableWidgetRezerwacje->setItem(i, 2, new QTableWidgetItem(r.nazwaZajec));
-        ui->tableWidgetRezerwacje->setItem(i, 3, new QTableWidgetItem(r.trenerZajec));
-        ui->tableWidgetRezerwacje->setItem(i, 4, new QTableWidgetItem(r.dataZajec));
-        ui->tableWidgetRezerwacje->setItem(i, 5, new QTableWidgetItem(r.czasZajec));
-
-        // Formatuj datę rezerwacji (pokaż tylko datę, bez godziny)
-        QString dataRezerwacji = r.dataRezerwacji;
-        if (dataRezerwacji.length() > 10) {
-            dataRezerwacji = dataRezerwacji.left(10); // Tylko YYYY-MM-DD
-        }
-        ui->tableWidgetRezerwacje->setItem(i, 6, new QTableWidgetItem(dataRezerwacji));
-
-        // Status z kolorowym tłem
-        QTableWidgetItem* statusItem = new QTableWidgetItem(r.status);
-        if (r.status == "aktywna") {
-            statusItem->setBackground(QBrush(QColor(144, 238, 144))); // Jasny zielony
-        } else if (r.status == "anulowana") {
-            statusItem->setBackground(QBrush(QColor(255, 182, 193))); // Jasny czerwony
-        }
-        ui->tableWidgetRezerwacje->setItem(i, 7, statusItem);
-    }
-}
-
-void MainWindow::zaladujKlientowDoComboBox() {
-    ui->comboBoxKlientRezerwacji->clear();
-
-    QList<Klient> klienci = DatabaseManager::getAllKlienci();
-    for (const Klient& k : klienci) {
-        QString tekst = QString("%1 %2").arg(k.imie).arg(k.nazwisko);
-        if (!k.email.isEmpty()) {
-            tekst += QString(" (%1)").arg(k.email);
-        }
-        ui->comboBoxKlientRezerwacji->addItem(tekst, k.id);
-    }
-
-    ui->comboBoxKlientRezerwacji->setCurrentIndex(-1); // Nic nie wybrane
-}
-
 void MainWindow::zaladujZajeciaDoComboBox() {
-    ui->comboBoxZajeciaRezerwacji->clear();
-
-    QList<Zajecia> dostepneZajecia = DatabaseManager::getZajeciaDostepneDoRezerwacji();
-    for (const Zajecia& z : dostepneZajecia) {
-        int aktualne = DatabaseManager::getIloscAktywnychRezerwacji(z.id);
-
-        QString tekst = QString("%1 - %2 %3 (%4/%5 miejsc)")
-                            .arg(z.nazwa)
-                            .arg(z.data)
-                            .arg(z.czas)
-                            .arg(aktualne)
-                            .arg(z.maksUczestnikow);
-
-        if (!z.trener.isEmpty()) {
-            tekst += QString(" [%1]").arg(z.trener);
+    // Kilka odświeżeń pod rząd (np. po dodaniu rezerwacji) kończy się jednym wypełnieniem listy
+    zapytania->uruchom("zajecia-rezerwacji", &DatabaseManager::getZajeciaDostepneDoRezerwacji, this,
+                       [this](const QList<Zajecia>& dostepneZajecia) {
+        ui->comboBoxZajeciaRezerwacji->clear();
+
+        for (const Zajecia& z : dostepneZajecia) {
+            ui->comboBoxZajeciaRezerwacji->addItem(opisZajecWComboBox(z), z.id);
+            ui->comboBoxZajeciaRezerwacji->setItemData(ui->comboBoxZajeciaRezerwacji->count() - 1, kluczZajec(z), ROLA_KLUCZA);
         }
 
-        ui->comboBoxZajeciaRezerwacji->addItem(tekst, z.id);
-    }
-
-    ui->comboBoxZajeciaRezerwacji->setCurrentIndex(-1); // Nic nie wybrane
+        ui->comboBoxZajeciaRezerwacji->setCurrentIndex(-1); // Nic nie wybrane
+    });
 }
 
 void MainWindow::aktualizujInfoZajec() {
@@ -1091,14 +1010,13 @@ void MainWindow::aktualizujInfoZajec() {
         return;
     }
 
-    int aktualne = DatabaseManager::getIloscAktywnychRezerwacji(zajeciaId);
-    int wolne = zajecia.maksUczestnikow - aktualne;
+    int wolne = zajecia.maksUczestnikow - zajecia.aktualneRezerwacje;
 
     ui->labelInfoNazwaZajec->setText(QString("Nazwa: %1").arg(zajecia.nazwa));
     ui->labelInfoTrener->setText(QString("Trener: %1").arg(zajecia.trener.isEmpty() ? "Brak" : zajecia.trener));
     ui->labelInfoDataCzas->setText(QString("Termin: %1 %2 (%3 min)")
-                                       .arg(zajecia.data)
-                                       .arg(zajecia.czas)
+                                       .arg(zajecia.data.toString("yyyy-MM-dd"))
+                                       .arg(zajecia.czas.toString("HH:mm"))
                                        .arg(zajecia.czasTrwania));
 
     QString tekstMiejsca = QString("Wolne miejsca: %1/%2").arg(wolne).arg(zajecia.maksUczestnikow);
@@ -1142,8 +1060,13 @@ bool MainWindow::walidujFormularzRezerwacji() {
 }
 
 void MainWindow::aktualizujLicznikRezerwacji() {
-    int liczba = DatabaseManager::getRezerwacjeCount();
-    ui->labelLiczbaRezerwacji->setText(QString("Liczba rezerwacji: %1").arg(liczba));
+    // Liczba wierszy bieżącej listy, czyli z uwzględnieniem filtra
+    const FiltrListy filtr = filtrRezerwacji;
+    zapytania->uruchom("rezerwacje-licznik", [filtr]() {
+        return DatabaseManager::getRezerwacjeCount(filtr);
+    }, this, [this](int liczba) {
+        ui->labelLiczbaRezerwacji->setText(QString("Liczba rezerwacji: %1").arg(liczba));
+    });
 }
 
 void MainWindow::aktualizujPrzyciskAnuluj() {
@@ -1152,15 +1075,20 @@ void MainWindow::aktualizujPrzyciskAnuluj() {
 
     if (czyWybrane) {
         // Sprawdź status wybranej rezerwacji
-        Rezerwacja r = DatabaseManager::getRezerwacjaById(aktualnieWybranaRezerwacjaId);
-        if (r.status == "anulowana") {
-            ui->pushButtonAnulujRezerwacje->setText("Już anulowana");
-            ui->pushButtonAnulujRezerwacje->setEnabled(false);
-        } else {
-            ui->pushButtonAnulujRezerwacje->setText("Anuluj rezerwację");
-            ui->pushButtonAnulujRezerwacje->setEnabled(true);
-        }
+        const int id = aktualnieWybranaRezerwacjaId;
+        zapytania->uruchom("przycisk-anuluj", [id]() {
+            return DatabaseManager::getRezerwacjaById(id);
+        }, this, [this](const Rezerwacja& r) {
+            if (r.status == StatusRezerwacji::Anulowana) {
+                ui->pushButtonAnulujRezerwacje->setText("Już anulowana");
+                ui->pushButtonAnulujRezerwacje->setEnabled(false);
+            } else {
+                ui->pushButtonAnulujRezerwacje->setText("Anuluj rezerwację");
+                ui->pushButtonAnulujRezerwacje->setEnabled(true);
+            }
+        });
     } else {
+        zapytania->anuluj("przycisk-anuluj");
         ui->pushButtonAnulujRezerwacje->setText("Anuluj rezerwację");
     }
 }
@@ -1196,7 +1124,6 @@ void MainWindow::dodajKarnet() {
     if (sukces) {
         pokazKomunikat("Sukces", "Karnet został dodany pomyślnie!", QMessageBox::Information);
         wyczyscFormularzKarnetu();
-        odswiezListeKarnetow();
         ui->statusbar->showMessage("Dodano nowy karnet", 3000);
     } else {
         pokazKomunikat("Błąd", "Nie udało się dodać karnetu.\nSprawdź czy klient nie ma już aktywnego karnetu tego typu.", QMessageBox::Warning);
@@ -1227,7 +1154,6 @@ void MainWindow::edytujKarnet() {
 
     if (sukces) {
         pokazKomunikat("Sukces", "Dane karnetu zostały zaktualizowane!", QMessageBox::Information);
-        odswiezListeKarnetow();
         ustawTrybDodawaniaKarnetu();
         ui->statusbar->showMessage("Zaktualizowano dane karnetu", 3000);
     } else {
@@ -1258,7 +1184,6 @@ void MainWindow::usunKarnet() {
     if (sukces) {
         pokazKomunikat("Sukces", "Karnet został usunięty!", QMessageBox::Information);
         wyczyscFormularzKarnetu();
-        odswiezListeKarnetow();
         ustawTrybDodawaniaKarnetu();
         ui->statusbar->showMessage("Usunięto karnet", 3000);
     } else {
@@ -1267,7 +1192,7 @@ void MainWindow::usunKarnet() {
 }
 
 void MainWindow::wyczyscFormularzKarnetu() {
-    ui->comboBoxKlientKarnetu->setCurrentIndex(-1);
+    wyborKlientaKarnetu->wyczysc();
     ui->comboBoxTypKarnetu->setCurrentIndex(0);
     ui->dateEditRozpocKarnetu->setDate(QDate::currentDate());
     ui->dateEditZakonKarnetu->setDate(QDate::currentDate().addMonths(1));
@@ -1282,57 +1207,57 @@ void MainWindow::filtrujKarnety() {
     QString typFilter = ui->comboBoxFilterTypKarnetu->currentText();
     QString statusFilter = ui->comboBoxFilterStatusKarnetu->currentText();
 
-    QList<Karnet> wszystkieKarnety = DatabaseManager::getAllKarnety();
-    QList<Karnet> przefiltrowane;
-
-    for (const Karnet& k : wszystkieKarnety) {
-        bool pasuje = true;
-
-        // Filtr typu
-        if (typFilter == "Tylko normalne" && k.typ != "normalny") {
-            pasuje = false;
-        } else if (typFilter == "Tylko studenckie" && k.typ != "studencki") {
-            pasuje = false;
-        }
+    FiltrListy filtr;
 
-        // Filtr statusu
-        if (statusFilter == "Tylko aktywne" && !k.czyAktywny) {
-            pasuje = false;
-        } else if (statusFilter == "Tylko nieaktywne" && k.czyAktywny) {
-            pasuje = false;
-        }
+    // Filtr typu
+    if (typFilter == "Tylko normalne") {
+        filtr.typ = "normalny";
+    } else if (typFilter == "Tylko studenckie") {
+        filtr.typ = "studencki";
+    }
 
-        if (pasuje) {
-            przefiltrowane.append(k);
-        }
+    // Filtr statusu
+    if (statusFilter == "Tylko aktywne") {
+        filtr.czyAktywny = true;
+    } else if (statusFilter == "Tylko nieaktywne") {
+        filtr.czyAktywny = false;
     }
 
-    zaladujKarnetyDoTabeli(przefiltrowane);
-    ui->statusbar->showMessage(QString("Przefiltrowano do %1 karnetów").arg(przefiltrowane.size()), 3000);
+    filtrKarnetow = filtr;
+    odswiezListeKarnetow();
+
+    zapytania->uruchom("karnety-licznik", [filtr]() {
+        return DatabaseManager::getKarnetyCount(filtr);
+    }, this, [this](int liczba) {
+        ui->labelLiczbaKarnetow->setText(QString("Liczba karnetów: %1").arg(liczba));
+        ui->statusbar->showMessage(QString("Przefiltrowano do %1 karnetów").arg(liczba), 3000);
+    });
 }
 
 void MainWindow::odswiezListeKarnetow() {
-    QList<Karnet> karnety = DatabaseManager::getAllKarnety();
-    zaladujKarnetyDoTabeli(karnety);
+    const FiltrListy filtr = filtrKarnetow;
+    modelKarnetow->ustawZrodlo([this, filtr](const QString& token, int limit) {
+        return zapytania->uruchom("karnety-strony", [filtr, token, limit]() {
+            return DatabaseManager::getKarnetyStrona(filtr, token, limit);
+        });
+    });
     aktualizujLicznikKarnetow();
-    zaladujKlientowDoComboBoxKarnetu();
     ui->statusbar->showMessage("Lista karnetów odświeżona", 2000);
 }
 
 void MainWindow::karnetWybrany() {
-    int aktualnyWiersz = ui->tableWidgetKarnety->currentRow();
+    int aktualnyWiersz = ui->tableViewKarnety->currentIndex().row();
 
     if (aktualnyWiersz < 0) {
         ustawTrybDodawaniaKarnetu();
         return;
     }
 
-    QTableWidgetItem* idItem = ui->tableWidgetKarnety->item(aktualnyWiersz, 0);
-    if (!idItem) {
+    int karnetId = modelKarnetow->idWiersza(aktualnyWiersz);
+    if (karnetId <= 0) {
         return;
     }
 
-    int karnetId = idItem->text().toInt();
     Karnet karnet = DatabaseManager::getKarnetById(karnetId);
 
     if (karnet.id > 0) {
@@ -1369,47 +1294,51 @@ void MainWindow::pokazStatystykiKarnetow() {
 }
 
 void MainWindow::pokazWygasajaceKarnety() {
-    QString dzisiaj = QDate::currentDate().toString("yyyy-MM-dd");
-    QString za30dni = QDate::currentDate().addDays(30).toString("yyyy-MM-dd");
-
-    QList<Karnet> wygasajace = DatabaseManager::getKarnetyWygasajace(dzisiaj, za30dni);
+    QDate dzisiaj = QDate::currentDate();
+    QDate za30dni = dzisiaj.addDays(30);
 
-    QString tekst = "⚠️ Karnety wygasające w ciągu 30 dni:\n\n";
+    zapytania->uruchom("wygasajace-karnety", [dzisiaj, za30dni]() {
+        return DatabaseManager::getKarnetyWygasajace(dzisiaj, za30dni);
+    }, this, [this](const QList<Karnet>& wygasajace) {
+        QString tekst = "⚠️ Karnety wygasające w ciągu 30 dni:\n\n";
 
-    if (wygasajace.isEmpty()) {
-        tekst += "Brak karnetów wygasających w najbliższym czasie.";
-    } else {
-        for (const Karnet& k : wygasajace) {
-            tekst += QString("• %1 %2 (%3)\n  Typ: %4, wygasa: %5\n\n")
-                         .arg(k.imieKlienta)
-                         .arg(k.nazwiskoKlienta)
-                         .arg(k.emailKlienta.isEmpty() ? "brak email" : k.emailKlienta)
-                         .arg(k.typ)
-                         .arg(k.dataZakonczenia);
+        if (wygasajace.isEmpty()) {
+            tekst += "Brak karnetów wygasających w najbliższym czasie.";
+        } else {
+            for (const Karnet& k : wygasajace) {
+                tekst += QString("• %1 %2 (%3)\n  Typ: %4, wygasa: %5\n\n")
+                             .arg(k.imieKlienta)
+                             .arg(k.nazwiskoKlienta)
+                             .arg(k.emailKlienta.isEmpty() ? "brak email" : k.emailKlienta)
+                             .arg(k.typ)
+                             .arg(k.dataZakonczenia.toString("yyyy-MM-dd"));
+            }
         }
-    }
 
-    pokazKomunikat("Wygasające karnety", tekst, QMessageBox::Warning);
+        pokazKomunikat("Wygasające karnety", tekst, QMessageBox::Warning);
+    });
+}
+
+void MainWindow::pokazRaportPrzychodow() {
+    RevenueReportDialog raport(zapytania, this);
+    raport.exec();
 }
 
 // ==================== METODY POMOCNICZE - KARNETY ====================
 
 void MainWindow::setupTableKarnety() {
     // Konfiguracja tabeli karnetów
-    ui->tableWidgetKarnety->setColumnCount(8);
-
-    QStringList headers = {"ID", "Klient", "Email", "Typ", "Data rozpoczęcia", "Data zakończenia", "Cena", "Status"};
-    ui->tableWidgetKarnety->setHorizontalHeaderLabels(headers);
+    ui->tableViewKarnety->setModel(modelKarnetow);
 
     // Ukryj kolumnę ID
-    ui->tableWidgetKarnety->setColumnHidden(0, true);
+    ui->tableViewKarnety->setColumnHidden(0, true);
 
     // Ustaw tryb zaznaczania całych wierszy
-    ui->tableWidgetKarnety->setSelectionBehavior(QAbstractItemView::SelectRows);
-    ui->tableWidgetKarnety->setSelectionMode(QAbstractItemView::SingleSelection);
+    ui->tableViewKarnety->setSelectionBehavior(QAbstractItemView::SelectRows);
+    ui->tableViewKarnety->setSelectionMode(QAbstractItemView::SingleSelection);
 
     // Ustaw szerokości kolumn
-    QHeaderView* header = ui->tableWidgetKarnety->horizontalHeader();
+    QHeaderView* header = ui->tableViewKarnety->horizontalHeader();
     header->setStretchLastSection(true);
     header->resizeSection(1, 150); // Klient
     header->resizeSection(2, 200); // Email
@@ -1419,39 +1348,14 @@ void MainWindow::setupTableKarnety() {
     header->resizeSection(6, 80);  // Cena
 }
 
-void MainWindow::zaladujKarnetyDoTabeli(const QList<Karnet>& karnety) {
-    ui->tableWidgetKarnety->setRowCount(karnety.size());
-
-    for (int i = 0; i < karnety.size(); ++i) {
-        const Karnet& k = karnety[i];
-
-        ui->tableWidgetKarnety->setItem(i, 0, new QTableWidgetItem(QString::number(k.id)));
-        ui->tableWidgetKarnety->setItem(i, 1, new QTableWidgetItem(QString("%1 %2").arg(k.imieKlienta).arg(k.nazwiskoKlienta)));
-        ui->tableWidgetKarnety->setItem(i, 2, new QTableWidgetItem(k.emailKlienta));
-        ui->tableWidgetKarnety->setItem(i, 3, new QTableWidgetItem(k.typ));
-        ui->tableWidgetKarnety->setItem(i, 4, new QTableWidgetItem(k.dataRozpoczecia));
-        ui->tableWidgetKarnety->setItem(i, 5, new QTableWidgetItem(k.dataZakonczenia));
-        ui->tableWidgetKarnety->setItem(i, 6, new QTableWidgetItem(QString("%1 zł").arg(k.cena, 0, 'f', 2)));
-
-        // Status z kolorowym tłem
-        QTableWidgetItem* statusItem = new QTableWidgetItem(k.czyAktywny ? "Aktywny" : "Nieaktywny");
-        if (k.czyAktywny) {
-            statusItem->setBackground(QBrush(QColor(144, 238, 144))); // Jasny zielony
-        } else {
-            statusItem->setBackground(QBrush(QColor(255, 182, 193))); // Jasny czerwony
-        }
-        ui->tableWidgetKarnety->setItem(i, 7, statusItem);
-    }
-}
-
 void MainWindow::zaladujKarnetDoFormularza(const Karnet& karnet) {
-    // Znajdź i ustaw klienta w ComboBox
-    for (int i = 0; i < ui->comboBoxKlientKarnetu->count(); i++) {
-        if (ui->comboBoxKlientKarnetu->itemData(i).toInt() == karnet.idKlienta) {
-            ui->comboBoxKlientKarnetu->setCurrentIndex(i);
-            break;
-        }
-    }
+    // Ustaw klienta w polu wyboru - dane klienta są już w karnecie (z joina)
+    Klient klient = {};
+    klient.id = karnet.idKlienta;
+    klient.imie = karnet.imieKlienta;
+    klient.nazwisko = karnet.nazwiskoKlienta;
+    klient.email = karnet.emailKlienta;
+    wyborKlientaKarnetu->ustawKlienta(klient);
 
     // Ustaw typ karnetu
     int typIndex = ui->comboBoxTypKarnetu->findText(karnet.typ);
@@ -1460,18 +1364,12 @@ void MainWindow::zaladujKarnetDoFormularza(const Karnet& karnet) {
     }
 
     // Ustaw daty
-    if (!karnet.dataRozpoczecia.isEmpty()) {
-        QDate dataRozp = QDate::fromString(karnet.dataRozpoczecia, "yyyy-MM-dd");
-        if (dataRozp.isValid()) {
-            ui->dateEditRozpocKarnetu->setDate(dataRozp);
-        }
+    if (karnet.dataRozpoczecia.isValid()) {
+        ui->dateEditRozpocKarnetu->setDate(karnet.dataRozpoczecia);
     }
 
-    if (!karnet.dataZakonczenia.isEmpty()) {
-        QDate dataZak = QDate::fromString(karnet.dataZakonczenia, "yyyy-MM-dd");
-        if (dataZak.isValid()) {
-            ui->dateEditZakonKarnetu->setDate(dataZak);
-        }
+    if (karnet.dataZakonczenia.isValid()) {
+        ui->dateEditZakonKarnetu->setDate(karnet.dataZakonczenia);
     }
 
     // Ustaw cenę
@@ -1484,28 +1382,13 @@ void MainWindow::zaladujKarnetDoFormularza(const Karnet& karnet) {
     aktualizujInfoKlienta();
 }
 
-void MainWindow::zaladujKlientowDoComboBoxKarnetu() {
-    ui->comboBoxKlientKarnetu->clear();
-
-    QList<Klient> klienci = DatabaseManager::getAllKlienci();
-    for (const Klient& k : klienci) {
-        QString tekst = QString("%1 %2").arg(k.imie).arg(k.nazwisko);
-        if (!k.email.isEmpty()) {
-            tekst += QString(" (%1)").arg(k.email);
-        }
-        ui->comboBoxKlientKarnetu->addItem(tekst, k.id);
-    }
-
-    ui->comboBoxKlientKarnetu->setCurrentIndex(-1); // Nic nie wybrane
-}
-
 Karnet MainWindow::pobierzDaneKarnetuZFormularza() {
     Karnet karnet = {};
 
     karnet.idKlienta = ui->comboBoxKlientKarnetu->currentData().toInt();
     karnet.typ = ui->comboBoxTypKarnetu->currentText();
-    karnet.dataRozpoczecia = ui->dateEditRozpocKarnetu->date().toString("yyyy-MM-dd");
-    karnet.dataZakonczenia = ui->dateEditZakonKarnetu->date().toString("yyyy-MM-dd");
+    karnet.dataRozpoczecia = ui->dateEditRozpocKarnetu->date();
+    karnet.dataZakonczenia = ui->dateEditZakonKarnetu->date();
     karnet.cena = ui->doubleSpinBoxCenaKarnetu->value();
     karnet.czyAktywny = (ui->comboBoxStatusKarnetu->currentIndex() == 0);
 
@@ -1544,7 +1427,7 @@ void MainWindow::ustawTrybDodawaniaKarnetu() {
 
     ui->labelFormularzKarnetuTitle->setText("Dodaj nowy karnet");
 
-    ui->tableWidgetKarnety->clearSelection();
+    ui->tableViewKarnety->clearSelection();
 }
 
 void MainWindow::ustawTrybEdycjiKarnetu() {
@@ -1556,38 +1439,49 @@ void MainWindow::ustawTrybEdycjiKarnetu() {
 }
 
 void MainWindow::aktualizujLicznikKarnetow() {
-    int liczba = DatabaseManager::getKarnetyCount();
-    ui->labelLiczbaKarnetow->setText(QString("Liczba karnetów: %1").arg(liczba));
+    const FiltrListy filtr = filtrKarnetow;
+    zapytania->uruchom("karnety-licznik", [filtr]() {
+        return DatabaseManager::getKarnetyCount(filtr);
+    }, this, [this](int liczba) {
+        ui->labelLiczbaKarnetow->setText(QString("Liczba karnetów: %1").arg(liczba));
+    });
 }
 
 void MainWindow::aktualizujInfoKlienta() {
     int klientId = ui->comboBoxKlientKarnetu->currentData().toInt();
 
     if (klientId <= 0) {
+        zapytania->anuluj("info-klienta");
         wyczyscInfoKlienta();
         return;
     }
 
-    Klient klient = DatabaseManager::getKlientById(klientId);
-    if (klient.id <= 0) {
-        wyczyscInfoKlienta();
-        return;
-    }
-
-    QList<Karnet> aktywneKarnety = DatabaseManager::getAktywneKarnetyKlienta(klientId);
+    // Klient i liczba jego aktywnych karnetów w jednym zadaniu
+    zapytania->uruchom("info-klienta", [klientId]() {
+        Klient klient = DatabaseManager::getKlientById(klientId);
+        const int aktywne = klient.id > 0 ? int(DatabaseManager::getAktywneKarnetyKlienta(klientId).size()) : 0;
+        return qMakePair(klient, aktywne);
+    }, this, [this](const QPair<Klient, int>& wynik) {
+        const Klient& klient = wynik.first;
+        const int aktywneKarnety = wynik.second;
+        if (klient.id <= 0) {
+            wyczyscInfoKlienta();
+            return;
+        }
 
-    ui->labelInfoImieNazwisko->setText(QString("Klient: %1 %2").arg(klient.imie).arg(klient.nazwisko));
-    ui->labelInfoEmailKlient->setText(QString("Email: %1").arg(klient.email.isEmpty() ? "Brak" : klient.email));
-    ui->labelInfoAktywneKarnety->setText(QString("Aktywne karnety: %1").arg(aktywneKarnety.size()));
+        ui->labelInfoImieNazwisko->setText(QString("Klient: %1 %2").arg(klient.imie).arg(klient.nazwisko));
+        ui->labelInfoEmailKlient->setText(QString("Email: %1").arg(klient.email.isEmpty() ? "Brak" : klient.email));
+        ui->labelInfoAktywneKarnety->setText(QString("Aktywne karnety: %1").arg(aktywneKarnety));
 
-    // Zmień kolor w zależności od liczby karnetów
-    if (aktywneKarnety.size() > 1) {
-        ui->labelInfoAktywneKarnety->setStyleSheet("color: orange; font-weight: bold;");
-    } else if (aktywneKarnety.size() == 1) {
-        ui->labelInfoAktywneKarnety->setStyleSheet("color: green; font-weight: bold;");
-    } else {
-        ui->labelInfoAktywneKarnety->setStyleSheet("color: gray; font-weight: bold;");
-    }
+        // Zmień kolor w zależności od liczby karnetów
+        if (aktywneKarnety > 1) {
+            ui->labelInfoAktywneKarnety->setStyleSheet("color: orange; font-weight: bold;");
+        } else if (aktywneKarnety == 1) {
+            ui->labelInfoAktywneKarnety->setStyleSheet("color: green; font-weight: bold;");
+        } else {
+            ui->labelInfoAktywneKarnety->setStyleSheet("color: gray; font-weight: bold;");
+        }
+    });
 }
 
 void MainWindow::wyczyscInfoKlienta() {
@@ -1607,6 +1501,230 @@ void MainWindow::obliczCeneKarnetu() {
     }
 }
 
+// ==================== POWIADOMIENIA O ZMIANACH W BAZIE ====================
+
+void MainWindow::daneZmienione(TabelaDanych tabela, int id, OperacjaZmiany operacja) {
+    // Jeden zapis = jeden wiersz do poprawienia w widokach, bez ponownego czytania list
+    switch (tabela) {
+    case TabelaDanych::Klienci:
+        odswiezKlienta(id, operacja);
+        break;
+    case TabelaDanych::Zajecia:
+        odswiezZajecia(id, operacja);
+        break;
+    case TabelaDanych::Rezerwacje:
+        odswiezRezerwacje(id, operacja);
+        break;
+    case TabelaDanych::Karnety:
+        odswiezKarnet(id, operacja);
+        break;
+    }
+}
+
+void MainWindow::danePrzeladowane(TabelaDanych tabela) {
+    switch (tabela) {
+    case TabelaDanych::Klienci:
+        odswiezListeKlientow();     // katalog klientów przeładowuje się sam
+        break;
+    case TabelaDanych::Zajecia:
+        odswiezListeZajec();
+        zaladujZajeciaDoComboBox();
+        break;
+    case TabelaDanych::Rezerwacje:
+        odswiezListeRezerwacji();
+        break;
+    case TabelaDanych::Karnety:
+        odswiezListeKarnetow();
+        break;
+    }
+}
+
+// ==================== METODY POMOCNICZE - ODŚWIEŻANIE PO ZAPISIE ====================
+
+void MainWindow::odswiezKlienta(int id, OperacjaZmiany operacja) {
+    if (operacja == OperacjaZmiany::Usuniecie) {
+        modelKlientow->usunWiersz(id);
+    } else {
+        zapytania->uruchom(QString("klient-%1").arg(id), [id]() {
+            return DatabaseManager::getKlientById(id);
+        }, this, [this](const Klient& klient) {
+            if (klient.id > 0) {
+                modelKlientow->zapiszWiersz(klient);
+            }
+        });
+    }
+
+    if (operacja != OperacjaZmiany::Zmiana) {
+        aktualizujLicznikKlientow();
+    }
+    if (operacja == OperacjaZmiany::Zmiana) {
+        // Rezerwacje i karnety pokazują imię i nazwisko klienta - takie zapisy są rzadkie,
+        // więc te listy po prostu wczytujemy od nowa. Przy usunięciu klienta DatabaseManager
+        // usuwa jego rezerwacje i sam zgłasza przeładowanie ich listy (klienta z karnetami
+        // nie da się usunąć).
+        odswiezListeRezerwacji();
+        odswiezListeKarnetow();
+    }
+}
+
+void MainWindow::odswiezZajecia(int id, OperacjaZmiany operacja) {
+    if (operacja == OperacjaZmiany::Usuniecie) {
+        modelZajec->usunWiersz(id);
+        usunPozycjeComboBox(ui->comboBoxZajeciaRezerwacji, id);
+    } else {
+        odswiezObsadeZajec(id);
+    }
+
+    if (operacja != OperacjaZmiany::Zmiana) {
+        aktualizujLicznikZajec();
+    }
+    if (operacja == OperacjaZmiany::Zmiana) {
+        // Nazwa zajęć w tabeli rezerwacji - jak u klientów; rezerwacje usuniętych zajęć
+        // przychodzą jako przeładowanie listy rezerwacji
+        odswiezListeRezerwacji();
+    }
+}
+
+void MainWindow::odswiezRezerwacje(int id, OperacjaZmiany operacja) {
+    if (operacja == OperacjaZmiany::Usuniecie) {
+        // Zajęcia usuniętej rezerwacji znamy tylko z wiersza, który model już pobrał
+        const Rezerwacja* usunieta = modelRezerwacji->elementId(id);
+        const int idZajec = usunieta ? usunieta->idZajec : -1;
+        modelRezerwacji->usunWiersz(id);
+
+        if (idZajec > 0) {
+            odswiezObsadeZajec(idZajec);
+        } else {
+            zaladujZajeciaDoComboBox();
+        }
+    } else {
+        // Zmiana statusu przesuwa licznik miejsc na zajęciach
+        zapytania->uruchom(QString("rezerwacja-%1").arg(id), [id]() {
+            return DatabaseManager::getRezerwacjaById(id);
+        }, this, [this](const Rezerwacja& rezerwacja) {
+            if (rezerwacja.id > 0) {
+                // Np. anulowana rezerwacja znika z listy "Tylko aktywne"
+                if (filtrRezerwacji.pasuje(rezerwacja)) {
+                    modelRezerwacji->zapiszWiersz(rezerwacja);
+                } else {
+                    modelRezerwacji->usunWiersz(rezerwacja.id);
+                }
+                odswiezObsadeZajec(rezerwacja.idZajec);
+            }
+        });
+    }
+
+    if (operacja != OperacjaZmiany::Zmiana || !filtrRezerwacji.czyPusty()) {
+        aktualizujLicznikRezerwacji();
+    }
+}
+
+void MainWindow::odswiezKarnet(int id, OperacjaZmiany operacja) {
+    if (operacja == OperacjaZmiany::Usuniecie) {
+        modelKarnetow->usunWiersz(id);
+    } else {
+        zapytania->uruchom(QString("karnet-%1").arg(id), [id]() {
+            return DatabaseManager::getKarnetById(id);
+        }, this, [this](const Karnet& karnet) {
+            if (karnet.id > 0) {
+                if (filtrKarnetow.pasuje(karnet)) {
+                    modelKarnetow->zapiszWiersz(karnet);
+                } else {
+                    modelKarnetow->usunWiersz(karnet.id);
+                }
+            }
+        });
+    }
+
+    if (operacja != OperacjaZmiany::Zmiana || !filtrKarnetow.czyPusty()) {
+        aktualizujLicznikKarnetow();
+    }
+    aktualizujInfoKlienta();    // liczba aktywnych karnetów wybranego klienta
+}
+
+void MainWindow::odswiezObsadeZajec(int idZajec) {
+    zapytania->uruchom(QString("zajecia-%1").arg(idZajec), [idZajec]() {
+        return DatabaseManager::getZajeciaById(idZajec);
+    }, this, [this, idZajec](const Zajecia& zajecia) {
+        if (zajecia.id <= 0) {
+            usunPozycjeComboBox(ui->comboBoxZajeciaRezerwacji, idZajec);
+            return;
+        }
+
+        modelZajec->zapiszWiersz(zajecia);
+        aktualizujZajeciaWComboBox(zajecia);
+        if (ui->comboBoxZajeciaRezerwacji->currentData().toInt() == zajecia.id) {
+            aktualizujInfoZajec();
+        }
+    });
+}
+
+void MainWindow::aktualizujZajeciaWComboBox(const Zajecia& zajecia) {
+    // Te same warunki co DatabaseManager::getZajeciaDostepneDoRezerwacji
+    const bool dostepne = zajecia.data >= QDate::currentDate()
+                          && zajecia.aktualneRezerwacje < zajecia.maksUczestnikow;
+
+    if (dostepne) {
+        zapiszPozycjeComboBox(ui->comboBoxZajeciaRezerwacji, zajecia.id, opisZajecWComboBox(zajecia), kluczZajec(zajecia));
+    } else {
+        usunPozycjeComboBox(ui->comboBoxZajeciaRezerwacji, zajecia.id);
+    }
+}
+
+void MainWindow::zapiszPozycjeComboBox(QComboBox* combo, int id, const QString& tekst, const QString& klucz) {
+    const int biezacyId = combo->currentIndex() >= 0 ? combo->currentData().toInt() : -1;
+    int indeks = combo->findData(id);
+
+    if (indeks >= 0 && combo->itemData(indeks, ROLA_KLUCZA).toString() == klucz) {
+        combo->setItemText(indeks, tekst);
+        return;
+    }
+    if (indeks >= 0) {
+        combo->removeItem(indeks);
+    }
+
+    // Lista jest posortowana po kluczu - szukamy pierwszej pozycji o większym
+    indeks = 0;
+    while (indeks < combo->count() && combo->itemData(indeks, ROLA_KLUCZA).toString() <= klucz) {
+        ++indeks;
+    }
+    combo->insertItem(indeks, tekst, id);
+    combo->setItemData(indeks, klucz, ROLA_KLUCZA);
+
+    // Wstawienie do pustej listy albo usunięcie wybranej pozycji zmienia wybór - przywróć go
+    const int nowyIndeks = biezacyId > 0 ? combo->findData(biezacyId) : -1;
+    if (combo->currentIndex() != nowyIndeks) {
+        combo->setCurrentIndex(nowyIndeks);
+    }
+}
+
+void MainWindow::usunPozycjeComboBox(QComboBox* combo, int id) {
+    const int indeks = combo->findData(id);
+    if (indeks < 0) {
+        return;
+    }
+
+    const bool wybrana = (indeks == combo->currentIndex());
+    combo->removeItem(indeks);
+    if (wybrana) {
+        combo->setCurrentIndex(-1);    // nie podsuwaj w zamian sąsiedniej pozycji
+    }
+}
+
+QString MainWindow::opisZajecWComboBox(const Zajecia& zajecia) const {
+    QString tekst = QString("%1 - %2 %3 (%4/%5 miejsc)")
+                        .arg(zajecia.nazwa)
+                        .arg(zajecia.data.toString("yyyy-MM-dd"))
+                        .arg(zajecia.czas.toString("HH:mm"))
+                        .arg(zajecia.aktualneRezerwacje)
+                        .arg(zajecia.maksUczestnikow);
+
+    if (!zajecia.trener.isEmpty()) {
+        tekst += QString(" [%1]").arg(zajecia.trener);
+    }
+    return tekst;
+}
+
 // ==================== SLOTS DLA EKSPORTU CSV ====================
 
 void MainWindow::eksportKlienciCSV() {
@@ -1615,11 +1733,13 @@ void MainWindow::eksportKlienciCSV() {
         return;
     }
 
-    if (DatabaseManager::exportKlienciToCSV(fileName)) {
+    StatystykiEksportu statystyki;
+    if (DatabaseManager::exportKlienciToCSV(fileName, &statystyki)) {
         pokazKomunikat("Sukces",
-                       QString("Pomyślnie wyeksportowano %1 klientów do pliku:\n%2")
-                           .arg(DatabaseManager::getKlienciCount())
-                           .arg(fileName),
+                       QString("Pomyślnie wyeksportowano %1 klientów do pliku:\n%2\n\n%3")
+                           .arg(statystyki.wiersze)
+                           .arg(fileName)
+                           .arg(opisPrzepustowosci(statystyki)),
                        QMessageBox::Information);
 
         // Zapytaj czy otworzyć folder
@@ -1648,11 +1768,13 @@ void MainWindow::eksportZajeciaCSV() {
         return;
     }
 
-    if (DatabaseManager::exportZajeciaToCSV(fileName)) {
+    StatystykiEksportu statystyki;
+    if (DatabaseManager::exportZajeciaToCSV(fileName, &statystyki)) {
         pokazKomunikat("Sukces",
-                       QString("Pomyślnie wyeksportowano %1 zajęć do pliku:\n%2")
-                           .arg(DatabaseManager::getZajeciaCount())
-                           .arg(fileName),
+                       QString("Pomyślnie wyeksportowano %1 zajęć do pliku:\n%2\n\n%3")
+                           .arg(statystyki.wiersze)
+                           .arg(fileName)
+                           .arg(opisPrzepustowosci(statystyki)),
                        QMessageBox::Information);
     } else {
         pokazKomunikat("Błąd",
@@ -1667,11 +1789,13 @@ void MainWindow::eksportRezerwacjeCSV() {
         return;
     }
 
-    if (DatabaseManager::exportRezerwacjeToCSV(fileName)) {
+    StatystykiEksportu statystyki;
+    if (DatabaseManager::exportRezerwacjeToCSV(fileName, &statystyki)) {
         pokazKomunikat("Sukces",
-                       QString("Pomyślnie wyeksportowano %1 rezerwacji do pliku:\n%2")
-                           .arg(DatabaseManager::getRezerwacjeCount())
-                           .arg(fileName),
+                       QString("Pomyślnie wyeksportowano %1 rezerwacji do pliku:\n%2\n\n%3")
+                           .arg(statystyki.wiersze)
+                           .arg(fileName)
+                           .arg(opisPrzepustowosci(statystyki)),
                        QMessageBox::Information);
     } else {
         pokazKomunikat("Błąd",
@@ -1686,11 +1810,13 @@ void MainWindow::eksportKarnetyCSV() {
         return;
     }
 
-    if (DatabaseManager::exportKarnetyToCSV(fileName)) {
+    StatystykiEksportu statystyki;
+    if (DatabaseManager::exportKarnetyToCSV(fileName, &statystyki)) {
         pokazKomunikat("Sukces",
-                       QString("Pomyślnie wyeksportowano %1 karnetów do pliku:\n%2")
-                           .arg(DatabaseManager::getKarnetyCount())
-                           .arg(fileName),
+                       QString("Pomyślnie wyeksportowano %1 karnetów do pliku:\n%2\n\n%3")
+                           .arg(statystyki.wiersze)
+                           .arg(fileName)
+                           .arg(opisPrzepustowosci(statystyki)),
                        QMessageBox::Information);
     } else {
         pokazKomunikat("Błąd",
@@ -1823,21 +1949,8 @@ void MainWindow::importKlienciCSV() {
         return;
     }
 
-    QProgressDialog progress("Importowanie klientów...", "Anuluj", 0, 0, this);
-    progress.setWindowModality(Qt::WindowModal);
-    progress.show();
-    QApplication::processEvents();
-
-    QPair<int, QStringList> result = DatabaseManager::importKlienciFromCSV(fileName);
-    progress.close();
-
-    pokazRaportImportu("Import klientów", result.first, result.second);
-
-    if (result.first > 0) {
-        odswiezListeKlientow();
-        zaladujKlientowDoComboBox();
-        zaladujKlientowDoComboBoxKarnetu();
-    }
+    // Widoki przeładuje DatabaseNotifier::przeladowano po zatwierdzeniu importu
+    uruchomImportCSV(RodzajImportu::Klienci, fileName, "Import klientów");
 }
 
 void MainWindow::importZajeciaCSV() {
@@ -1860,20 +1973,8 @@ void MainWindow::importZajeciaCSV() {
         return;
     }
 
-    QProgressDialog progress("Importowanie zajęć...", "Anuluj", 0, 0, this);
-    progress.setWindowModality(Qt::WindowModal);
-    progress.show();
-    QApplication::processEvents();
-
-    QPair<int, QStringList> result = DatabaseManager::importZajeciaFromCSV(fileName);
-    progress.close();
-
-    pokazRaportImportu("Import zajęć", result.first, result.second);
-
-    if (result.first > 0) {
-        odswiezListeZajec();
-        zaladujZajeciaDoComboBox();
-    }
+    // Widoki przeładuje DatabaseNotifier::przeladowano po zatwierdzeniu importu
+    uruchomImportCSV(RodzajImportu::Zajecia, fileName, "Import zajęć");
 }
 
 void MainWindow::importRezerwacjeCSV() {
@@ -1896,19 +1997,8 @@ void MainWindow::importRezerwacjeCSV() {
         return;
     }
 
-    QProgressDialog progress("Importowanie rezerwacji...", "Anuluj", 0, 0, this);
-    progress.setWindowModality(Qt::WindowModal);
-    progress.show();
-    QApplication::processEvents();
-
-    QPair<int, QStringList> result = DatabaseManager::importRezerwacjeFromCSV(fileName);
-    progress.close();
-
-    pokazRaportImportu("Import rezerwacji", result.first, result.second);
-
-    if (result.first > 0) {
-        odswiezListeRezerwacji();
-    }
+    // Widoki przeładuje DatabaseNotifier::przeladowano po zatwierdzeniu importu
+    uruchomImportCSV(RodzajImportu::Rezerwacje, fileName, "Import rezerwacji");
 }
 
 void MainWindow::importKarnetyCSV() {
@@ -1932,19 +2022,8 @@ void MainWindow::importKarnetyCSV() {
         return;
     }
 
-    QProgressDialog progress("Importowanie karnetów...", "Anuluj", 0, 0, this);
-    progress.setWindowModality(Qt::WindowModal);
-    progress.show();
-    QApplication::processEvents();
-
-    QPair<int, QStringList> result = DatabaseManager::importKarnetyFromCSV(fileName);
-    progress.close();
-
-    pokazRaportImportu("Import karnetów", result.first, result.second);
-
-    if (result.first > 0) {
-        odswiezListeKarnetow();
-    }
+    // Widoki przeładuje DatabaseNotifier::przeladowano po zatwierdzeniu importu
+    uruchomImportCSV(RodzajImportu::Karnety, fileName, "Import karnetów");
 }
 
 // ==================== METODY POMOCNICZE CSV ====================
@@ -1961,6 +2040,13 @@ QString MainWindow::getCSVSaveFileName(const QString& defaultName, const QString
         );
 }
 
+QString MainWindow::opisPrzepustowosci(const StatystykiEksportu& statystyki) const {
+    return QString("Czas: %1 ms (%2 wierszy/s, %3 MB/s)")
+        .arg(statystyki.czasMs)
+        .arg(statystyki.wierszeNaSekunde(), 0, 'f', 0)
+        .arg(statystyki.megabajtyNaSekunde(), 0, 'f', 2);
+}
+
 QString MainWindow::getCSVOpenFileName(const QString& title) {
     QString documentsPath = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation);
 
@@ -1983,70 +2069,126 @@ QString MainWindow::getDirectoryPath(const QString& title) {
         );
 }
 
-void MainWindow::pokazRaportImportu(const QString& tytul, int zaimportowane, const QStringList& bledy) {
-    QString message;
-
-    if (zaimportowane > 0) {
-        message += QString("✅ Pomyślnie zaimportowano: %1 rekordów\n\n").arg(zaimportowane);
-    } else {
-        message += "❌ Nie zaimportowano żadnych rekordów\n\n";
-    }
+int MainWindow::uruchomImportCSV(RodzajImportu rodzaj, const QString& fileName, const QString& tytul) {
+    ImportPipeline pipeline(rodzaj, fileName);
+    int zaimportowane = 0;
+    QStringList bledy;
+    bool zakonczony = false;
+
+    // Import działa w tle - okno pokazuje postęp i błędy na bieżąco
+    QDialog dialog(this);
+    dialog.setWindowTitle(tytul);
+    dialog.resize(600, 420);
+
+    QLabel* etykieta = new QLabel("Importowanie " + DatabaseManager::nazwaRodzajuImportu(rodzaj) + "...", &dialog);
+    QProgressBar* pasek = new QProgressBar(&dialog);
+    pasek->setRange(0, 1000);
+    QLabel* etykietaBledow = new QLabel("Błędy: 0", &dialog);
+    QListWidget* listaBledow = new QListWidget(&dialog);
+    QPushButton* przyciskZapisz = new QPushButton("Zapisz raport błędów", &dialog);
+    przyciskZapisz->setEnabled(false);
+    QPushButton* przyciskAnuluj = new QPushButton("Anuluj", &dialog);
+
+    QHBoxLayout* przyciski = new QHBoxLayout;
+    przyciski->addWidget(przyciskZapisz);
+    przyciski->addStretch();
+    przyciski->addWidget(przyciskAnuluj);
+
+    QVBoxLayout* uklad = new QVBoxLayout(&dialog);
+    uklad->addWidget(etykieta);
+    uklad->addWidget(pasek);
+    uklad->addWidget(etykietaBledow);
+    uklad->addWidget(listaBledow);
+    uklad->addLayout(przyciski);
+
+    connect(&pipeline, &ImportPipeline::postep, &dialog,
+            [pasek, etykieta](qint64 przeczytane, qint64 rozmiar, int liczba) {
+                pasek->setValue(rozmiar > 0 ? static_cast<int>(przeczytane * 1000 / rozmiar) : 0);
+                etykieta->setText(QString("Zaimportowano: %1 rekordów").arg(liczba));
+            });
+
+    connect(&pipeline, &ImportPipeline::noweBledy, &dialog,
+            [listaBledow, etykietaBledow](const QStringList& nowe) {
+                listaBledow->addItems(nowe);
+                listaBledow->scrollToBottom();
+                etykietaBledow->setText(QString("⚠️ Błędy: %1").arg(listaBledow->count()));
+            });
+
+    connect(&pipeline, &ImportPipeline::zakonczono, &dialog,
+            [&](int liczba, const QStringList& wszystkieBledy, bool anulowano) {
+                zaimportowane = liczba;
+                bledy = wszystkieBledy;
+                zakonczony = true;
+
+                if (anulowano) {
+                    etykieta->setText(QString("⚠️ Import przerwany - zaimportowano: %1 rekordów").arg(liczba));
+                } else if (liczba > 0) {
+                    etykieta->setText(QString("✅ Pomyślnie zaimportowano: %1 rekordów").arg(liczba));
+                } else {
+                    etykieta->setText("❌ Nie zaimportowano żadnych rekordów");
+                }
 
-    if (!bledy.isEmpty()) {
-        message += QString("⚠️ Błędy (%1):\n").arg(bledy.size());
+                pasek->setValue(pasek->maximum());
+                przyciskZapisz->setEnabled(!wszystkieBledy.isEmpty());
+                przyciskAnuluj->setText("Zamknij");
+                przyciskAnuluj->setEnabled(true);
+            });
 
-        // Pokaż maksymalnie 10 pierwszych błędów
-        int maxErrors = qMin(10, bledy.size());
-        for (int i = 0; i < maxErrors; i++) {
-            message += "• " + bledy[i] + "\n";
+    connect(przyciskAnuluj, &QPushButton::clicked, &dialog, [&]() {
+        if (zakonczony) {
+            dialog.accept();
+            return;
         }
+        przyciskAnuluj->setEnabled(false);
+        etykieta->setText("Przerywanie importu...");
+        pipeline.cancel();
+    });
 
-        if (bledy.size() > maxErrors) {
-            message += QString("... i %1 kolejnych błędów\n").arg(bledy.size() - maxErrors);
-        }
+    connect(przyciskZapisz, &QPushButton::clicked, &dialog, [&]() {
+        zapiszRaportBledow(tytul, zaimportowane, bledy);
+    });
+
+    // Start dopiero po podłączeniu sygnałów - krótki plik może skończyć się od razu
+    if (!pipeline.start()) {
+        pokazKomunikat("Błąd", pipeline.errorString(), QMessageBox::Critical);
+        return 0;
     }
 
-    QMessageBox msgBox(this);
-    msgBox.setWindowTitle(tytul);
-    msgBox.setText(message);
+    dialog.exec();
 
-    if (zaimportowane > 0 && bledy.isEmpty()) {
-        msgBox.setIcon(QMessageBox::Information);
-    } else if (zaimportowane > 0) {
-        msgBox.setIcon(QMessageBox::Warning);
-    } else {
-        msgBox.setIcon(QMessageBox::Critical);
+    // Okno zamknięte (Esc/krzyżyk) w trakcie importu - przerywamy i czekamy na zapis
+    if (!zakonczony) {
+        pipeline.cancel();
+        pipeline.wait();
+        zaimportowane = pipeline.zaimportowane();
     }
 
-    // Dodaj przycisk do zapisania raportu błędów
-    if (!bledy.isEmpty()) {
-        QPushButton* saveButton = msgBox.addButton("Zapisz raport błędów", QMessageBox::ActionRole);
-        msgBox.addButton(QMessageBox::Ok);
-
-        msgBox.exec();
-
-        if (msgBox.clickedButton() == saveButton) {
-            QString fileName = getCSVSaveFileName("raport_bledow.txt", "Zapisz raport błędów");
-            if (!fileName.isEmpty()) {
-                QFile file(fileName);
-                if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-                    QTextStream stream(&file);
-                    stream.setCodec("UTF-8");
-                    stream << tytul << " - Raport błędów\n";
-                    stream << QString("Data: %1\n\n").arg(QDateTime::currentDateTime().toString());
-                    stream << QString("Zaimportowano: %1 rekordów\n").arg(zaimportowane);
-                    stream << QString("Błędy: %1\n\n").arg(bledy.size());
-
-                    for (const QString& blad : bledy) {
-                        stream << blad << "\n";
-                    }
-
-                    file.close();
-                    pokazKomunikat("Zapisano", "Raport błędów został zapisany do pliku:\n" + fileName);
-                }
-            }
-        }
-    } else {
-        msgBox.exec();
+    return zaimportowane;
+}
+
+void MainWindow::zapiszRaportBledow(const QString& tytul, int zaimportowane, const QStringList& bledy) {
+    QString fileName = getCSVSaveFileName("raport_bledow.txt", "Zapisz raport błędów");
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        pokazKomunikat("Błąd", "Nie można zapisać raportu błędów do pliku:\n" + fileName, QMessageBox::Critical);
+        return;
     }
+
+    QTextStream stream(&file);
+    stream.setEncoding(QStringConverter::Utf8);
+    stream << tytul << " - Raport błędów\n";
+    stream << QString("Data: %1\n\n").arg(QDateTime::currentDateTime().toString());
+    stream << QString("Zaimportowano: %1 rekordów\n").arg(zaimportowane);
+    stream << QString("Błędy: %1\n\n").arg(bledy.size());
+
+    for (const QString& blad : bledy) {
+        stream << blad << "\n";
+    }
+
+    file.close();
+    pokazKomunikat("Zapisano", "Raport błędów został zapisany do pliku:\n" + fileName);
 }
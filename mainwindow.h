@@ -2,8 +2,7 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
-#include <QTableWidget>
-#include <QTableWidgetItem>
+#include <QTableView>
 #include <QLineEdit>
 #include <QTextEdit>
 #include <QDateEdit>
@@ -17,7 +16,13 @@
 #include <QTabWidget>
 #include <QFileDialog>
 #include <QProgressDialog>
+#include <QTimer>
 #include "DatabaseManager.h"
+#include "DatabaseNotifier.h"
+#include "ClientCompleter.h"
+#include "ClientDirectory.h"
+#include "EntityTableModel.h"
+#include "QueryExecutor.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -32,7 +37,6 @@ class MainWindow : public QMainWindow
 public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
-    void createTablesIfNotExist();
 
 private slots:
     // === Slots dla zarządzania KLIENTAMI ===
@@ -66,6 +70,7 @@ private slots:
     void zajeciaRezerwacjiWybrane();  // gdy wybierzemy zajęcia w comboBox
     void pokazStatystyki();
     void pokazAktywnychKlientow();
+    void pokazMapeOblozenia();
 
     // === Slots dla zarządzania KARNETAMI ===
     void odswiezListeKarnetow();
@@ -78,6 +83,7 @@ private slots:
     void klientKarnetuWybrany();  // gdy wybierzemy klienta w comboBox
     void pokazStatystykiKarnetow();
     void pokazWygasajaceKarnety();
+    void pokazRaportPrzychodow();
 
     // === Slots dla IMPORTU/EKSPORTU CSV ===
     void eksportKlienciCSV();
@@ -91,6 +97,10 @@ private slots:
     void importRezerwacjeCSV();
     void importKarnetyCSV();
 
+    // === Slots dla powiadomień o zmianach w bazie ===
+    void daneZmienione(TabelaDanych tabela, int id, OperacjaZmiany operacja);
+    void danePrzeladowane(TabelaDanych tabela);
+
     // === Slots dla menu ===
     void zamknijAplikacje();
     void oProgramie();
@@ -100,15 +110,32 @@ private:
 
     // === Zmienne pomocnicze dla KLIENTÓW ===
     int aktualnieEdytowanyKlientId;  // -1 gdy dodajemy nowego, >0 gdy edytujemy
+    QTimer* opoznienieWyszukiwaniaKlientow;  // wyszukiwanie w trakcie pisania rusza po przerwie
 
     // === Zmienne pomocnicze dla ZAJĘĆ ===
     int aktualnieEdytowaneZajeciaId; // -1 gdy dodajemy nowe, >0 gdy edytujemy
 
     // === Zmienne pomocnicze dla REZERWACJI ===
     int aktualnieWybranaRezerwacjaId; // -1 gdy nic nie wybrane, >0 gdy wybrane
+    FiltrListy filtrRezerwacji;       // filtr listy rezerwacji (ustawiany przez "Filtruj")
 
     // === Zmienne pomocnicze dla KARNETÓW ===
     int aktualnieEdytowanyKarnetId; // -1 gdy dodajemy nowy, >0 gdy edytujemy
+    FiltrListy filtrKarnetow;       // filtr listy karnetów (ustawiany przez "Filtruj")
+
+    // === Modele tabel (dane doczytywane stronami) ===
+    KlienciModel* modelKlientow;
+    ZajeciaModel* modelZajec;
+    RezerwacjeModel* modelRezerwacji;
+    KarnetyModel* modelKarnetow;
+
+    // Zapytania wykonywane w tle - wyniki wracają do slotów w wątku GUI
+    QueryExecutor* zapytania;
+
+    // Wspólny katalog klientów i wyszukiwanie w nim dla pól wyboru klienta
+    ClientDirectory* katalogKlientow;
+    ClientCompleter* wyborKlientaRezerwacji;
+    ClientCompleter* wyborKlientaKarnetu;
 
     // === Metody pomocnicze - OGÓLNE ===
     void setupUI();                    // Konfiguracja UI po uruchomieniu
@@ -136,8 +163,6 @@ private:
 
     // === Metody pomocnicze - REZERWACJE ===
     void setupTableRezerwacje();                                           // Konfiguracja tabeli rezerwacji
-    void zaladujRezerwacjeDoTabeli(const QList<Rezerwacja>& rezerwacje);   // Załaduj rezerwacje do tabeli
-    void zaladujKlientowDoComboBox();                                      // Załaduj klientów do ComboBox
     void zaladujZajeciaDoComboBox();                                       // Załaduj dostępne zajęcia do ComboBox
     void aktualizujInfoZajec();                                            // Aktualizuj informacje o wybranych zajęciach
     bool walidujFormularzRezerwacji();                                     // Sprawdź czy formularz rezerwacji jest poprawny
@@ -147,9 +172,7 @@ private:
 
     // === Metody pomocnicze - KARNETY ===
     void setupTableKarnety();                                           // Konfiguracja tabeli karnetów
-    void zaladujKarnetyDoTabeli(const QList<Karnet>& karnety);          // Załaduj karnety do tabeli
     void zaladujKarnetDoFormularza(const Karnet& karnet);               // Załaduj dane karnetu do formularza
-    void zaladujKlientowDoComboBoxKarnetu();                            // Załaduj klientów do ComboBox karnetów
     Karnet pobierzDaneKarnetuZFormularza();                             // Pobierz dane z formularza karnetu
     bool walidujFormularzKarnetu();                                     // Sprawdź czy formularz karnetu jest poprawny
     void ustawTrybDodawaniaKarnetu();                                   // Ustaw UI w tryb dodawania nowego karnetu
@@ -159,11 +182,24 @@ private:
     void wyczyscInfoKlienta();                                          // Wyczyść informacje o kliencie
     void obliczCeneKarnetu();                                           // Oblicz cenę karnetu na podstawie typu
 
+    // === Metody pomocnicze - ODŚWIEŻANIE PO ZAPISIE (pojedyncze wiersze) ===
+    void odswiezKlienta(int id, OperacjaZmiany operacja);
+    void odswiezZajecia(int id, OperacjaZmiany operacja);
+    void odswiezRezerwacje(int id, OperacjaZmiany operacja);
+    void odswiezKarnet(int id, OperacjaZmiany operacja);
+    void odswiezObsadeZajec(int idZajec);                               // Liczba miejsc w tabeli, ComboBox i panelu info
+    void aktualizujZajeciaWComboBox(const Zajecia& zajecia);            // Dodaj/popraw/usuń pozycję wg dostępności
+    void zapiszPozycjeComboBox(QComboBox* combo, int id, const QString& tekst, const QString& klucz);
+    void usunPozycjeComboBox(QComboBox* combo, int id);
+    QString opisZajecWComboBox(const Zajecia& zajecia) const;
+
     // === Metody pomocnicze - CSV ===
     QString getCSVSaveFileName(const QString& defaultName, const QString& title = "Eksportuj do CSV");
     QString getCSVOpenFileName(const QString& title = "Importuj z CSV");
     QString getDirectoryPath(const QString& title = "Wybierz katalog do eksportu");
-    void pokazRaportImportu(const QString& tytul, int zaimportowane, const QStringList& bledy);
+    int uruchomImportCSV(RodzajImportu rodzaj, const QString& fileName, const QString& tytul);  // Zwraca liczbę zaimportowanych
+    void zapiszRaportBledow(const QString& tytul, int zaimportowane, const QStringList& bledy);
+    QString opisPrzepustowosci(const StatystykiEksportu& statystyki) const;
 
     // === Metody ogólne ===
     void pokazKomunikat(const QString& tytul, const QString& tresc, QMessageBox::Icon typ = QMessageBox::Information);